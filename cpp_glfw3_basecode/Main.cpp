@@ -9,6 +9,7 @@ The integrated libraries GLFW3, GLM, STB, and ImGui have their own separate lice
 #include <iostream>
 #include <ctime>    // Required to get the time to seed the RNG
 #include <cstdlib>  // Required for `srand` and `exit` calls
+#include <chrono>   // Required to time how long startup takes
 
 // IMPORTANT: Always pull in GLAD _before_ GLFW or we get a 'gl.h already imported' error.
 // ALSO     : You have to add glad.h and glad.c to your project or it won't build.
@@ -55,9 +56,14 @@ int main()
 
     if (showDemoScenes)
     {
+        auto setupStartTime = std::chrono::steady_clock::now();
         openGLDemoScene = new OpenGLDemoScene();
         openGLDemoScene->setup();
         imguiDemoScene = new ImGuiDemoScene();
+
+        // Note: This covers compiling the shaders and loading the textures, but not the model (which carries on loading in the background)
+        std::chrono::duration<double, std::milli> setupDuration = std::chrono::steady_clock::now() - setupStartTime;
+        cout << "Demo scenes set up in " << setupDuration.count() << "ms." << endl;
     }
 
     // ----- Main game-loop -----
@@ -104,16 +110,21 @@ int main()
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
-    // Destroy the window and shutdown GLFW
-    glfwDestroyWindow( Window::getGlfwWindow() );
-    glfwTerminate();
-
-    // Free our pointers and exit
+    // Free our demo scenes while the OpenGL context still exists, as they delete the GL objects they own
     if (showDemoScenes)
     {
         delete openGLDemoScene;
         delete imguiDemoScene;
     }
+
+    // Likewise, delete the per-frame uniform buffer
+    FrameUniforms::release();
+
+    // Destroy the window and shutdown GLFW
+    glfwDestroyWindow( Window::getGlfwWindow() );
+    glfwTerminate();
+
+    // Free our pointers and exit
     delete window;
     return 0;
 }
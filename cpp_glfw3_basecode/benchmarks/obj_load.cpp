@@ -0,0 +1,218 @@
+/***
+.OBJ load time benchmark.
+
+Times how long it takes to read models/cow.obj and a large synthetic .obj file (a height field of v, vn and f v//vn lines, written out before
+timing starts) two ways:
+    - With streams, reading each line with getline and splitting it into a vector of strings with an istringstream before converting the
+      tokens with atof/atoi - which is how Model::readModelFile read models before it memory-mapped them.
+    - With Model itself, which memory-maps the file and tokenises each line in place (in parallel chunks, one per core).
+
+The mesh cache is turned off so Model always parses the file, and so are the optimisations that only apply when drawing as elements - we load as
+arrays, and check that the expanded position and normal arrays Model gives us match the ones built from the streamed data exactly.
+
+It isn't part of the app - build it on its own from the cpp_glfw3_basecode folder (so it can find models/cow.obj) with something like:
+
+    g++ -std=gnu++20 -O2 -pthread -I../libs -I../libs/GLAD/include -I../libs/linux -Iinclude benchmarks/obj_load.cpp src/Model.cpp \
+        src/MeshOptimiser.cpp src/MappedFile.cpp src/Frustum.cpp -o obj_load
+
+Then run it from the same folder: ./obj_load [synthetic grid size, default 1200 - which writes a file of about 220MB]
+***/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <filesystem>
+#include <thread>
+
+#include "glm/glm.hpp"
+
+#include "Model.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+using glm::vec3;
+
+// What we read from a model file with streams - the face corners are one-based, just as they are in the file
+struct StreamedModel
+{
+	vector<vec3>   vertices;
+	vector<vec3>   normals;
+	vector<GLuint> faceVertices;
+	vector<GLuint> faceNormals;
+};
+
+// Function to write a height field of gridSize x gridSize vertices (each with a normal) as an .obj file
+static void writeSyntheticObj(const string &filename, int gridSize)
+{
+	FILE* file = fopen(filename.c_str(), "w");
+	if (file == nullptr)
+	{
+		cout << "Could not write the synthetic model file: " << filename << endl;
+		exit(1);
+	}
+
+	for (int z = 0; z < gridSize; ++z)
+	{
+		for (int x = 0; x < gridSize; ++x)
+		{
+			float height = sinf(x * 0.05f) * cosf(z * 0.07f) * 10.0f;
+			fprintf(file, "v %.6f %.6f %.6f\n", x * 0.5f, height, z * 0.5f);
+		}
+	}
+
+	for (int z = 0; z < gridSize; ++z)
+	{
+		for (int x = 0; x < gridSize; ++x)
+		{
+			vec3 normal = glm::normalize( vec3(-cosf(x * 0.05f) * cosf(z * 0.07f), 1.0f, sinf(x * 0.05f) * sinf(z * 0.07f)) );
+			fprintf(file, "vn %.6f %.6f %.6f\n", normal.x, normal.y, normal.z);
+		}
+	}
+
+	// Two triangles per grid square. Note: .obj indices start at 1.
+	for (int z = 0; z < gridSize - 1; ++z)
+	{
+		for (int x = 0; x < gridSize - 1; ++x)
+		{
+			int topLeft     = z * gridSize + x + 1;
+			int topRight    = topLeft + 1;
+			int bottomLeft  = topLeft + gridSize;
+			int bottomRight = bottomLeft + 1;
+			fprintf(file, "f %d//%d %d//%d %d//%d\n", topLeft, topLeft, bottomLeft, bottomLeft, topRight, topRight);
+			fprintf(file, "f %d//%d %d//%d %d//%d\n", topRight, topRight, bottomLeft, bottomLeft, bottomRight, bottomRight);
+		}
+	}
+
+	fclose(file);
+}
+
+// Function to read the v, vn and f v//vn lines of a model file with streams, one allocated vector of strings per line
+static bool readWithStreams(const string &filename, StreamedModel &model)
+{
+	std::ifstream file( filename.c_str() );
+	if ( !file.good() )
+	{
+		return false;
+	}
+
+	string line;
+	while ( getline(file, line) )
+	{
+		if (line.length() <= 1)
+		{
+			continue;
+		}
+
+		std::istringstream lineStream(line);
+		vector<string> tokens;
+		copy( std::istream_iterator<string>(lineStream), std::istream_iterator<string>(), back_inserter(tokens) );
+		if (tokens.size() != 4)
+		{
+			continue;
+		}
+
+		if (tokens[0] == "v")
+		{
+			model.vertices.push_back( vec3( atof( tokens[1].c_str() ), atof( tokens[2].c_str() ), atof( tokens[3].c_str() ) ) );
+		}
+		else if (tokens[0] == "vn")
+		{
+			model.normals.push_back( vec3( atof( tokens[1].c_str() ), atof( tokens[2].c_str() ), atof( tokens[3].c_str() ) ) );
+		}
+		else if (tokens[0] == "f")
+		{
+			for (int corner = 1; corner <= 3; ++corner)
+			{
+				size_t slashes = tokens[corner].find("//");
+				model.faceVertices.push_back( atoi( tokens[corner].substr(0, slashes).c_str() ) );
+				model.faceNormals.push_back( slashes == string::npos ? 0 : atoi( tokens[corner].substr(slashes + 2).c_str() ) );
+			}
+		}
+	}
+	return true;
+}
+
+// Function to check that a model loaded as arrays has the positions and normals of every face corner of the streamed model, in the same order
+static bool matchesStreamedModel(const Model &model, const StreamedModel &streamedModel)
+{
+	size_t cornerCount = streamedModel.faceVertices.size();
+	if (model.getNumVertices() != cornerCount || model.getNumNormals() != cornerCount)
+	{
+		return false;
+	}
+
+	vector<GLfloat> positions, normals;
+	positions.reserve(cornerCount * 3);
+	normals.reserve(cornerCount * 3);
+	for (size_t corner = 0; corner < cornerCount; ++corner)
+	{
+		const vec3 &position = streamedModel.vertices[ streamedModel.faceVertices[corner] - 1 ];
+		const vec3 &normal   = streamedModel.normals[ streamedModel.faceNormals[corner] - 1 ];
+		positions.insert( positions.end(), { position.x, position.y, position.z } );
+		normals.insert( normals.end(), { normal.x, normal.y, normal.z } );
+	}
+
+	return memcmp(model.getVertexData(), positions.data(), positions.size() * sizeof(GLfloat)) == 0 &&
+	       memcmp(model.getNormalData(), normals.data(), normals.size() * sizeof(GLfloat)) == 0;
+}
+
+// Function to time loading a model file both ways, and print the results
+static void benchmarkFile(const string &filename)
+{
+	cout << "\n===== " << filename << " (" << std::filesystem::file_size(filename) / 1024 << "KB) =====" << endl;
+
+	StreamedModel streamedModel;
+	auto streamStartTime = std::chrono::steady_clock::now();
+	if ( !readWithStreams(filename, streamedModel) )
+	{
+		cout << "Could not read " << filename << " - skipping it." << endl;
+		return;
+	}
+	std::chrono::duration<double, std::milli> streamDuration = std::chrono::steady_clock::now() - streamStartTime;
+
+	auto modelStartTime = std::chrono::steady_clock::now();
+	Model model(filename, Model::DRAWING_AS_ARRAYS);
+	std::chrono::duration<double, std::milli> modelDuration = std::chrono::steady_clock::now() - modelStartTime;
+
+	cout << "\nRead with streams: " << streamDuration.count() << "ms (" << streamedModel.vertices.size() << " vertices, "
+	     << streamedModel.faceVertices.size() / 3 << " faces)" << endl;
+	cout << "Read with Model:   " << model.getParseTimeMs() << "ms on " << std::max(1u, std::thread::hardware_concurrency()) << " core(s) - "
+	     << streamDuration.count() / model.getParseTimeMs() << "x faster (" << modelDuration.count() << "ms including setting up the data arrays)" << endl;
+	cout << "Data arrays match: " << (matchesStreamedModel(model, streamedModel) ? "yes" : "NO") << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	int gridSize = (argc > 1) ? atoi(argv[1]) : 1200;
+	if (gridSize < 2)
+	{
+		cout << "Usage: obj_load [synthetic grid size, at least 2]" << endl;
+		return 1;
+	}
+
+	Model::useMeshCache        = false;
+	Model::optimiseVertexOrder = false;
+	Model::generateLods        = false;
+	Model::buildMeshlets       = false;
+
+	benchmarkFile("models/cow.obj");
+
+	string syntheticFilename = ( std::filesystem::temp_directory_path() / "obj_load_benchmark.obj" ).string();
+	cout << "\nWriting a " << gridSize << " x " << gridSize << " synthetic model to " << syntheticFilename << "..." << endl;
+	writeSyntheticObj(syntheticFilename, gridSize);
+	benchmarkFile(syntheticFilename);
+	std::filesystem::remove(syntheticFilename);
+
+	return 0;
+}
@@ -0,0 +1,193 @@
+/***
+Smooth normal generation benchmark.
+
+Builds height field meshes of about one and four million triangles and times generating a smooth normal for every triangle corner three ways:
+    - Serially, summing each triangle's unnormalised normal into its three vertices - so each triangle is weighted by its area alone, and
+      there's one normal per vertex rather than per corner. This is the simplest way of doing it, for a baseline.
+    - Serially, weighting each triangle by its area times its angle at each corner with the exact acos - the same weighting as below.
+    - With MeshOptimiser::generateSmoothNormals, which works out the triangle normals four at a time with SSE (and an approximate acos) and
+      splits both of its passes across every core. It's timed with no crease angle, and with a 30 degree one.
+
+We check how far generateSmoothNormals (with no crease angle) is from the serial area and angle weighted version at every corner - the acos
+approximation means they aren't bit-identical, but they should be well within a tenth of a degree.
+
+It isn't part of the app - build it on its own from the cpp_glfw3_basecode folder with something like:
+
+    g++ -std=gnu++20 -O2 -pthread -I../libs -I../libs/GLAD/include -I../libs/linux -Iinclude benchmarks/smooth_normals.cpp src/MeshOptimiser.cpp \
+        -o smooth_normals
+
+Then run it: ./smooth_normals [grid size ...] - the default grid sizes are 708 and 1415 (1 and 4 million triangles)
+***/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+#include "glm/glm.hpp"
+
+#include "MeshOptimiser.h"
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+using glm::vec3;
+
+// How many times we time each way of generating the normals - we report the fastest
+static const int PASS_COUNT = 3;
+
+// Function to build a gridSize x gridSize height field with two triangles per grid square. The bumps are sharp enough for a crease angle to matter.
+static void buildHeightField(int gridSize, vector<GLuint> &indices, vector<vec3> &positions)
+{
+	positions.clear();
+	indices.clear();
+
+	for (int z = 0; z < gridSize; ++z)
+	{
+		for (int x = 0; x < gridSize; ++x)
+		{
+			float height = sinf(x * 0.3f) * cosf(z * 0.2f) * 2.0f + ( (x / 16 + z / 16) % 2 ) * 3.0f;
+			positions.push_back( vec3(x * 0.5f, height, z * 0.5f) );
+		}
+	}
+
+	for (int z = 0; z < gridSize - 1; ++z)
+	{
+		for (int x = 0; x < gridSize - 1; ++x)
+		{
+			GLuint topLeft     = z * gridSize + x;
+			GLuint topRight    = topLeft + 1;
+			GLuint bottomLeft  = topLeft + gridSize;
+			GLuint bottomRight = bottomLeft + 1;
+			indices.insert( indices.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight } );
+		}
+	}
+}
+
+// Function to give each vertex the normalised sum of the unnormalised normals of its triangles (i.e. weighted by area), then copy them to the corners
+static void generateAreaWeightedNormals(const vector<GLuint> &indices, const vector<vec3> &positions, vector<vec3> &cornerNormals)
+{
+	vector<vec3> vertexNormals(positions.size(), vec3(0.0f));
+	for (size_t corner = 0; corner < indices.size(); corner += 3)
+	{
+		const vec3 &v0 = positions[ indices[corner] ], &v1 = positions[ indices[corner + 1] ], &v2 = positions[ indices[corner + 2] ];
+		vec3 normal = glm::cross(v1 - v0, v2 - v0);
+		vertexNormals[ indices[corner] ]     += normal;
+		vertexNormals[ indices[corner + 1] ] += normal;
+		vertexNormals[ indices[corner + 2] ] += normal;
+	}
+	for (vec3 &normal : vertexNormals)
+	{
+		float length = glm::length(normal);
+		normal = (length > 0.0f) ? normal / length : vec3(0.0f, 1.0f, 0.0f);
+	}
+
+	cornerNormals.resize( indices.size() );
+	for (size_t corner = 0; corner < indices.size(); ++corner)
+	{
+		cornerNormals[corner] = vertexNormals[ indices[corner] ];
+	}
+}
+
+// Function to do the same, but weight each triangle by its area times its angle at each corner (with the exact acos)
+static void generateAreaAndAngleWeightedNormals(const vector<GLuint> &indices, const vector<vec3> &positions, vector<vec3> &cornerNormals)
+{
+	vector<vec3> vertexNormals(positions.size(), vec3(0.0f));
+	for (size_t corner = 0; corner < indices.size(); corner += 3)
+	{
+		for (int loop = 0; loop < 3; ++loop)
+		{
+			const vec3 &position = positions[ indices[corner + loop] ];
+			vec3 toNext     = positions[ indices[corner + (loop + 1) % 3] ] - position;
+			vec3 toPrevious = positions[ indices[corner + (loop + 2) % 3] ] - position;
+			float lengths   = glm::length(toNext) * glm::length(toPrevious);
+			float angle     = (lengths > 0.0f) ? acosf( glm::clamp(glm::dot(toNext, toPrevious) / lengths, -1.0f, 1.0f) ) : 0.0f;
+			vertexNormals[ indices[corner + loop] ] += glm::cross(toNext, toPrevious) * angle;
+		}
+	}
+	for (vec3 &normal : vertexNormals)
+	{
+		float length = glm::length(normal);
+		normal = (length > 0.0f) ? normal / length : vec3(0.0f, 1.0f, 0.0f);
+	}
+
+	cornerNormals.resize( indices.size() );
+	for (size_t corner = 0; corner < indices.size(); ++corner)
+	{
+		cornerNormals[corner] = vertexNormals[ indices[corner] ];
+	}
+}
+
+// Helper function to time PASS_COUNT calls of a function and return the fastest, in milliseconds
+template <typename Function>
+static double timeFastest(Function function)
+{
+	double fastestMs = 0.0;
+	for (int pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		function();
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		fastestMs = (pass == 0) ? duration.count() : std::min(fastestMs, duration.count());
+	}
+	return fastestMs;
+}
+
+// Function to time generating the normals of one mesh every way, and print the results
+static void benchmarkGrid(int gridSize)
+{
+	vector<GLuint> indices;
+	vector<vec3>   positions;
+	buildHeightField(gridSize, indices, positions);
+	cout << "\n===== " << gridSize << " x " << gridSize << " grid: " << indices.size() / 3 << " triangles, " << positions.size() << " vertices =====" << endl;
+
+	vector<vec3> areaNormals, referenceNormals, smoothNormals, creasedNormals;
+	double areaMs      = timeFastest([&] { generateAreaWeightedNormals(indices, positions, areaNormals); });
+	double referenceMs = timeFastest([&] { generateAreaAndAngleWeightedNormals(indices, positions, referenceNormals); });
+	double smoothMs    = timeFastest([&] { MeshOptimiser::generateSmoothNormals(indices, positions, smoothNormals); });
+	double creasedMs   = timeFastest([&] { MeshOptimiser::generateSmoothNormals(indices, positions, creasedNormals, 30.0f); });
+
+	// The largest angle between the normals we gave any corner, in degrees
+	float maxAngleDegs = 0.0f;
+	for (size_t corner = 0; corner < indices.size(); ++corner)
+	{
+		float cosAngle = glm::clamp( glm::dot(referenceNormals[corner], smoothNormals[corner]), -1.0f, 1.0f );
+		maxAngleDegs = std::max( maxAngleDegs, glm::degrees( acosf(cosAngle) ) );
+	}
+
+	cout << "Serial, area weighted:                    " << areaMs << "ms" << endl;
+	cout << "Serial, area and angle weighted:          " << referenceMs << "ms" << endl;
+	cout << "generateSmoothNormals, no crease angle:   " << smoothMs << "ms on " << std::max(1u, std::thread::hardware_concurrency()) << " core(s) - "
+	     << referenceMs / smoothMs << "x the serial version with the same weighting" << endl;
+	cout << "generateSmoothNormals, 30 degree crease:  " << creasedMs << "ms" << endl;
+	cout << "Largest difference from the serial area and angle weighted normals: " << maxAngleDegs << " degrees" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	vector<int> gridSizes;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		gridSizes.push_back( atoi(argv[arg]) );
+	}
+	if ( gridSizes.empty() )
+	{
+		gridSizes = { 708, 1415 };
+	}
+
+	for (int gridSize : gridSizes)
+	{
+		if (gridSize < 2)
+		{
+			cout << "Grid sizes must be at least 2 - skipping " << gridSize << endl;
+			continue;
+		}
+		benchmarkGrid(gridSize);
+	}
+
+	return 0;
+}
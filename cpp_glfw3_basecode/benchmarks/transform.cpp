@@ -0,0 +1,161 @@
+/***
+Vertex transform benchmark.
+
+Times transforming a few million random vertices with Model::transformVertices (four vertices at a time with SSE, split across every core)
+against the scalar loops it replaced:
+    - The loop Model::scale(float) used to run, multiplying every position component by the scale (positions only, no normals). We compare it
+      with transformVertices given the same uniform scale as a matrix, again with positions only.
+    - A scalar glm loop multiplying each position by a full mat4 and each normal by the normal matrix (then renormalising it). We compare it with
+      transformVertices given the same matrix, transforming positions and normals.
+
+Each pair is checked against each other, and the largest difference between them printed. The vertices are copied back from the originals
+before every pass, outside the timer.
+
+It isn't part of the app - build it on its own from the cpp_glfw3_basecode folder with something like:
+
+    g++ -std=gnu++20 -O2 -pthread -I../libs -I../libs/GLAD/include -I../libs/linux -Iinclude benchmarks/transform.cpp src/Model.cpp \
+        src/MeshOptimiser.cpp src/MappedFile.cpp src/Frustum.cpp -o transform
+
+Then run it: ./transform [vertex count, default 4000000]
+***/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <thread>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Model.h"
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+using glm::vec3;
+using glm::vec4;
+using glm::mat3;
+using glm::mat4;
+
+// How many times we time each way of transforming the vertices - we report the fastest
+static const int PASS_COUNT = 3;
+
+// Helper function to time PASS_COUNT calls of a function, calling reset before each one (outside the timer), and return the fastest in milliseconds
+template <typename Reset, typename Function>
+static double timeFastest(Reset reset, Function function)
+{
+	double fastestMs = 0.0;
+	for (int pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		reset();
+		auto startTime = std::chrono::steady_clock::now();
+		function();
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		fastestMs = (pass == 0) ? duration.count() : std::min(fastestMs, duration.count());
+	}
+	return fastestMs;
+}
+
+// Helper function to get the largest difference between any two matching floats of two arrays
+static float getLargestDifference(const vector<GLfloat> &first, const vector<GLfloat> &second)
+{
+	float largestDifference = 0.0f;
+	for (size_t loop = 0; loop < first.size(); ++loop)
+	{
+		largestDifference = std::max( largestDifference, std::fabs(first[loop] - second[loop]) );
+	}
+	return largestDifference;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t numVertices = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 4000000;
+	if (numVertices == 0)
+	{
+		cout << "Usage: transform [vertex count, at least 1]" << endl;
+		return 1;
+	}
+
+	// Random positions in a 100 unit cube, and random unit normals
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	vector<GLfloat> originalPositions(numVertices * 3), originalNormals(numVertices * 3);
+	for (size_t vertex = 0; vertex < numVertices; ++vertex)
+	{
+		vec3 position(distribution(generator), distribution(generator), distribution(generator));
+		vec3 normal = glm::normalize( vec3(distribution(generator), distribution(generator), distribution(generator)) + vec3(0.0f, 0.0f, 0.001f) );
+		for (int component = 0; component < 3; ++component)
+		{
+			originalPositions[vertex * 3 + component] = position[component] * 50.0f;
+			originalNormals[vertex * 3 + component]   = normal[component];
+		}
+	}
+
+	cout << "Transforming " << numVertices << " vertices on " << std::max(1u, std::thread::hardware_concurrency()) << " core(s)" << endl;
+
+	// ----- A uniform scale of the positions -----
+	const float scale = 4.0f;
+	vector<GLfloat> scalarPositions, modelPositions;
+
+	double scalarScaleMs = timeFastest([&] { scalarPositions = originalPositions; }, [&]
+	{
+		// The loop Model::scale(float) used to run
+		GLfloat* vertexData = scalarPositions.data();
+		for (GLuint loop = 0; loop < numVertices * 3; /* We change the loop inside itself! */)
+		{
+			vertexData[loop++] *= scale;
+			vertexData[loop++] *= scale;
+			vertexData[loop++] *= scale;
+		}
+	});
+
+	const mat4 scaleMatrix = glm::scale( mat4(1.0f), vec3(scale) );
+	double modelScaleMs = timeFastest([&] { modelPositions = originalPositions; }, [&]
+	{
+		Model::transformVertices(scaleMatrix, modelPositions.data(), nullptr, numVertices);
+	});
+
+	cout << "\nUniform scale, positions only:" << endl;
+	cout << "    Old scalar scale loop:  " << scalarScaleMs << "ms" << endl;
+	cout << "    transformVertices:      " << modelScaleMs << "ms (largest difference " << getLargestDifference(scalarPositions, modelPositions) << ")" << endl;
+
+	// ----- A full affine matrix with a non-uniform scale, positions and normals -----
+	mat4 matrix = glm::translate( mat4(1.0f), vec3(10.0f, -5.0f, 2.5f) );
+	matrix = glm::rotate( matrix, 0.7f, glm::normalize( vec3(1.0f, 2.0f, 3.0f) ) );
+	matrix = glm::scale( matrix, vec3(2.0f, 0.5f, 3.0f) );
+	const mat3 normalMatrix = glm::transpose( glm::inverse( mat3(matrix) ) );
+	vector<GLfloat> scalarNormals, modelNormals;
+
+	double scalarMatrixMs = timeFastest([&] { scalarPositions = originalPositions; scalarNormals = originalNormals; }, [&]
+	{
+		for (size_t vertex = 0; vertex < numVertices; ++vertex)
+		{
+			GLfloat* position = &scalarPositions[vertex * 3];
+			GLfloat* normal   = &scalarNormals[vertex * 3];
+			vec3 transformedPosition = vec3( matrix * vec4(position[0], position[1], position[2], 1.0f) );
+			vec3 transformedNormal   = glm::normalize( normalMatrix * vec3(normal[0], normal[1], normal[2]) );
+			for (int component = 0; component < 3; ++component)
+			{
+				position[component] = transformedPosition[component];
+				normal[component]   = transformedNormal[component];
+			}
+		}
+	});
+
+	double modelMatrixMs = timeFastest([&] { modelPositions = originalPositions; modelNormals = originalNormals; }, [&]
+	{
+		Model::transformVertices(matrix, modelPositions.data(), modelNormals.data(), numVertices);
+	});
+
+	cout << "\nAffine matrix, positions and normals:" << endl;
+	cout << "    Scalar glm mat4 loop:   " << scalarMatrixMs << "ms" << endl;
+	cout << "    transformVertices:      " << modelMatrixMs << "ms (largest difference " << getLargestDifference(scalarPositions, modelPositions)
+	     << " in the positions, " << getLargestDifference(scalarNormals, modelNormals) << " in the normals)" << endl;
+
+	return 0;
+}
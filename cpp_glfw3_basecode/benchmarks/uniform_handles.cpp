@@ -0,0 +1,188 @@
+/***
+Uniform handle microbenchmark.
+
+Times 100,000 draws of the model shader program (shaders/phong.vert and phong.frag), each of which first sets the nine per-draw uniforms the demo
+scene sets for the model. This is done two ways:
+    - By name, looking each uniform's location up in a map on every draw - which is what ShaderProgram::uniform() did before uniforms had handles.
+    - Through typed Uniform<T> handles got once from ShaderProgram::getUniform<T>() - which is what the demo scene does now.
+
+It isn't part of the app - build it on its own from the cpp_glfw3_basecode folder (so it can find the shaders) with something like:
+
+    g++ -std=gnu++20 -O2 -pthread -I../libs -I../libs/GLAD/include -I../libs/linux -Iinclude benchmarks/uniform_handles.cpp src/FrameUniforms.cpp \
+        ../libs/GLAD/src/glad.c -L../libs/linux/GLFW/lib -l:libglfw.so.3.3 -lGL -lX11 -ldl -o uniform_handles
+
+Then run it from the same folder: ./uniform_handles
+***/
+
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <string>
+
+// IMPORTANT: Always pull in GLAD _before_ GLFW or we get a 'gl.h already imported' error.
+#ifndef __glad_h_
+	#include "glad/glad.h"
+#endif
+
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp" // Needed for the value_ptr() method
+
+#include "ShaderProgram.hpp"
+#include "FrameUniforms.h"
+
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+
+using glm::vec3;
+using glm::mat3;
+using glm::mat4;
+
+// How many draws we time each way, and how many times we time them
+static const int DRAW_COUNT = 100000;
+static const int PASS_COUNT = 3;
+
+// The per-draw uniforms the demo scene sets on the model shader program
+static const char* UNIFORM_NAMES[] = { "modelMatrix", "normalMatrix", "positionDecodeScale", "positionDecodeOffset", "octahedralNormals",
+                                       "ambientMaterialColour", "diffuseMaterialColour", "specularMaterialColour", "specularPower" };
+
+// Helper function to time DRAW_COUNT calls of setUniformsAndDraw(drawNumber), waiting for the GPU to finish before we stop the clock
+template <typename Function>
+static double timeDraws(Function setUniformsAndDraw)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	for (int drawNumber = 0; drawNumber < DRAW_COUNT; ++drawNumber)
+	{
+		setUniformsAndDraw(drawNumber);
+	}
+	glFinish();
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+	return duration.count();
+}
+
+// Function to time the draws both ways, and print the results
+static void runBenchmark()
+{
+	ShaderProgram::useProgramBinaryCache = false;
+
+	ShaderProgram *modelShaderProgram = new ShaderProgram("Model Shader Program");
+	modelShaderProgram->addShader(GL_VERTEX_SHADER,   ShaderProgram::loadShaderFromFile("shaders/phong.vert"));
+	modelShaderProgram->addShader(GL_FRAGMENT_SHADER, ShaderProgram::loadShaderFromFile("shaders/phong.frag"));
+	modelShaderProgram->initialise();
+
+	// The map of names to locations that draws looked their uniforms up in before handles
+	map<string, GLint> uniformLocations;
+	for (const char* uniformName : UNIFORM_NAMES)
+	{
+		uniformLocations[uniformName] = modelShaderProgram->bindUniform(uniformName);
+	}
+
+	// The handles that draws use now
+	Uniform<mat4>  modelMatrixUniform            = modelShaderProgram->getUniform<mat4>("modelMatrix");
+	Uniform<mat3>  normalMatrixUniform           = modelShaderProgram->getUniform<mat3>("normalMatrix");
+	Uniform<vec3>  positionDecodeScaleUniform    = modelShaderProgram->getUniform<vec3>("positionDecodeScale");
+	Uniform<vec3>  positionDecodeOffsetUniform   = modelShaderProgram->getUniform<vec3>("positionDecodeOffset");
+	Uniform<bool>  octahedralNormalsUniform      = modelShaderProgram->getUniform<bool>("octahedralNormals");
+	Uniform<vec3>  ambientMaterialColourUniform  = modelShaderProgram->getUniform<vec3>("ambientMaterialColour");
+	Uniform<vec3>  diffuseMaterialColourUniform  = modelShaderProgram->getUniform<vec3>("diffuseMaterialColour");
+	Uniform<vec3>  specularMaterialColourUniform = modelShaderProgram->getUniform<vec3>("specularMaterialColour");
+	Uniform<float> specularPowerUniform          = modelShaderProgram->getUniform<float>("specularPower");
+
+	// Each draw is a single triangle from an empty vertex array object (so every vertex gets the attribute's default value) - we're timing
+	// the uniform updates and the draw calls, not what gets drawn
+	GLuint vaoId;
+	glGenVertexArrays(1, &vaoId);
+	glBindVertexArray(vaoId);
+	FrameUniforms::update( FrameUniforms::Data() );
+	modelShaderProgram->use();
+
+	mat4 modelMatrix(1.0f);
+	mat3 normalMatrix(1.0f);
+	vec3 colour(1.0f);
+
+	for (int pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		double byNameMs = timeDraws([&](int drawNumber)
+		{
+			modelMatrix[3][0] = static_cast<float>(drawNumber);
+			glUniformMatrix4fv(uniformLocations.find("modelMatrix")->second,            1, GL_FALSE, glm::value_ptr(modelMatrix));
+			glUniformMatrix3fv(uniformLocations.find("normalMatrix")->second,           1, GL_FALSE, glm::value_ptr(normalMatrix));
+			glUniform3fv(      uniformLocations.find("positionDecodeScale")->second,    1, glm::value_ptr(colour));
+			glUniform3fv(      uniformLocations.find("positionDecodeOffset")->second,   1, glm::value_ptr(colour));
+			glUniform1i(       uniformLocations.find("octahedralNormals")->second,      GL_FALSE);
+			glUniform3fv(      uniformLocations.find("ambientMaterialColour")->second,  1, glm::value_ptr(colour));
+			glUniform3fv(      uniformLocations.find("diffuseMaterialColour")->second,  1, glm::value_ptr(colour));
+			glUniform3fv(      uniformLocations.find("specularMaterialColour")->second, 1, glm::value_ptr(colour));
+			glUniform1f(       uniformLocations.find("specularPower")->second,          64.0f);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		});
+
+		double byHandleMs = timeDraws([&](int drawNumber)
+		{
+			modelMatrix[3][0] = static_cast<float>(drawNumber);
+			modelMatrixUniform.set(modelMatrix);
+			normalMatrixUniform.set(normalMatrix);
+			positionDecodeScaleUniform.set(colour);
+			positionDecodeOffsetUniform.set(colour);
+			octahedralNormalsUniform.set(false);
+			ambientMaterialColourUniform.set(colour);
+			diffuseMaterialColourUniform.set(colour);
+			specularMaterialColourUniform.set(colour);
+			specularPowerUniform.set(64.0f);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		});
+
+		cout << "Pass " << pass + 1 << ": " << DRAW_COUNT << " draws with uniforms set by name took " << byNameMs << "ms, through handles "
+		     << byHandleMs << "ms (" << (byNameMs - byHandleMs) * 1000000.0 / DRAW_COUNT << "ns per draw saved)." << endl;
+	}
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
+	{
+		cout << "[ERROR] OpenGL error " << error << " while benchmarking - the timings above may not be meaningful." << endl;
+	}
+
+	glDeleteVertexArrays(1, &vaoId);
+	FrameUniforms::release();
+	delete modelShaderProgram;
+}
+
+int main()
+{
+	if ( !glfwInit() )
+	{
+		cout << "glfwInit failed!" << endl;
+		return 1;
+	}
+
+	// We never show the window - we only need it for its OpenGL context
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Uniform handle benchmark", nullptr, nullptr);
+	if (window == nullptr)
+	{
+		cout << "Could not create an OpenGL 4.6 context!" << endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if ( !gladLoadGL() )
+	{
+		cout << "GLAD failed to load OpenGL extensions!" << endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	runBenchmark();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,270 @@
+/***
+Vertex layout benchmark.
+
+Writes out a high-poly height field (about two million triangles by default, with no normals so Model generates smooth ones), loads it as a
+Model drawn as elements, uploads it with a GpuMesh in every vertex data layout, then times drawing it from each layout with GPU timer queries:
+    - Separate position and normal buffers (24 bytes per vertex across two buffers).
+    - A single interleaved buffer (see Model::getInterleavedData).
+    - A single quantised buffer of 12 bytes per vertex (see Model::getQuantisedData).
+
+The mesh is drawn with the model shader program (shaders/phong.vert and phong.frag) into a 1920x1080 off-screen framebuffer, with the camera
+looking down across the whole of it - so it's the same work the demo scene does for its model, just with far more vertices than the cow.
+
+It isn't part of the app - build it on its own from the cpp_glfw3_basecode folder (so it can find the shaders) with something like:
+
+    g++ -std=gnu++20 -O2 -pthread -I../libs -I../libs/GLAD/include -I../libs/linux -Iinclude benchmarks/vertex_layouts.cpp src/FrameUniforms.cpp \
+        src/Model.cpp src/MeshOptimiser.cpp src/MappedFile.cpp src/Frustum.cpp src/GpuMesh.cpp src/ModelLoader.cpp ../libs/GLAD/src/glad.c \
+        -L../libs/linux/GLFW/lib -l:libglfw.so.3.3 -lGL -lX11 -ldl -o vertex_layouts
+
+Then run it from the same folder: ./vertex_layouts [grid size, default 1000]
+***/
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <filesystem>
+
+// IMPORTANT: Always pull in GLAD _before_ GLFW or we get a 'gl.h already imported' error.
+#ifndef __glad_h_
+	#include "glad/glad.h"
+#endif
+
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "ShaderProgram.hpp"
+#include "FrameUniforms.h"
+#include "Model.h"
+#include "GpuMesh.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+using glm::vec3;
+using glm::mat3;
+using glm::mat4;
+
+// The size of the framebuffer we draw into, how many times we draw the mesh per timer query, and how many queries we time each layout with
+static const int FRAMEBUFFER_WIDTH  = 1920;
+static const int FRAMEBUFFER_HEIGHT = 1080;
+static const int DRAWS_PER_PASS     = 10;
+static const int PASS_COUNT         = 5;
+
+// The grid size we use if we're not given one
+static int gridSize = 1000;
+
+// Function to write a gridSize x gridSize height field of positions and triangles (no normals) as an .obj file
+static bool writeHeightFieldObj(const string &filename)
+{
+	FILE* file = fopen(filename.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	for (int z = 0; z < gridSize; ++z)
+	{
+		for (int x = 0; x < gridSize; ++x)
+		{
+			fprintf(file, "v %.6f %.6f %.6f\n", x * 0.5f, sinf(x * 0.05f) * cosf(z * 0.07f) * 10.0f, z * 0.5f);
+		}
+	}
+
+	// Two triangles per grid square, wound anticlockwise seen from above. Note: .obj indices start at 1.
+	for (int z = 0; z < gridSize - 1; ++z)
+	{
+		for (int x = 0; x < gridSize - 1; ++x)
+		{
+			int topLeft     = z * gridSize + x + 1;
+			int topRight    = topLeft + 1;
+			int bottomLeft  = topLeft + gridSize;
+			int bottomRight = bottomLeft + 1;
+			fprintf(file, "f %d %d %d\n", topLeft, bottomLeft, topRight);
+			fprintf(file, "f %d %d %d\n", topRight, bottomLeft, bottomRight);
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+// Function to load the height field, draw it from every layout, and print the results
+static void runBenchmark()
+{
+	// ----- Load the mesh -----
+	// Note: We keep the vertex cache optimisation the demo's models get, but skip the levels of detail and meshlets as we only draw the full mesh
+	Model::useMeshCache  = false;
+	Model::generateLods  = false;
+	Model::buildMeshlets = false;
+
+	string objFilename = ( std::filesystem::temp_directory_path() / "vertex_layouts_benchmark.obj" ).string();
+	if ( !writeHeightFieldObj(objFilename) )
+	{
+		cout << "Could not write the height field to " << objFilename << endl;
+		return;
+	}
+	Model model(objFilename, Model::DRAWING_AS_ELEMENTS);
+	std::filesystem::remove(objFilename);
+	if ( !model.hasVertices() )
+	{
+		return;
+	}
+
+	// ----- Set up the shader, the mesh and somewhere to draw it -----
+	ShaderProgram::useProgramBinaryCache = false;
+	ShaderProgram *modelShaderProgram = new ShaderProgram("Model Shader Program");
+	modelShaderProgram->addShader(GL_VERTEX_SHADER,   ShaderProgram::loadShaderFromFile("shaders/phong.vert"));
+	modelShaderProgram->addShader(GL_FRAGMENT_SHADER, ShaderProgram::loadShaderFromFile("shaders/phong.frag"));
+	modelShaderProgram->initialise();
+
+	Attribute      positionAttribute           = modelShaderProgram->getAttribute("vertexPosition");
+	Attribute      normalAttribute             = modelShaderProgram->getAttribute("vertexNormal");
+	Uniform<mat4>  modelMatrixUniform          = modelShaderProgram->getUniform<mat4>("modelMatrix");
+	Uniform<mat3>  normalMatrixUniform         = modelShaderProgram->getUniform<mat3>("normalMatrix");
+	Uniform<vec3>  positionDecodeScaleUniform  = modelShaderProgram->getUniform<vec3>("positionDecodeScale");
+	Uniform<vec3>  positionDecodeOffsetUniform = modelShaderProgram->getUniform<vec3>("positionDecodeOffset");
+	Uniform<bool>  octahedralNormalsUniform    = modelShaderProgram->getUniform<bool>("octahedralNormals");
+
+	GpuMesh *mesh = new GpuMesh(model, ModelLoader::UPLOAD_ALL_DATA, positionAttribute.location, normalAttribute.location);
+
+	GLuint framebufferId, renderbufferIds[2];
+	glCreateFramebuffers(1, &framebufferId);
+	glCreateRenderbuffers(2, renderbufferIds);
+	glNamedRenderbufferStorage(renderbufferIds[0], GL_RGBA8,             FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+	glNamedRenderbufferStorage(renderbufferIds[1], GL_DEPTH_COMPONENT24, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+	glNamedFramebufferRenderbuffer(framebufferId, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbufferIds[0]);
+	glNamedFramebufferRenderbuffer(framebufferId, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, renderbufferIds[1]);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+	glViewport(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+
+	// Look down across the whole mesh from above one edge of it
+	vec3  centre = model.getBoundingSphereCentre();
+	float radius = model.getBoundingSphereRadius();
+	FrameUniforms::Data frameData;
+	frameData.cameraPosition       = centre + vec3(0.0f, radius * 0.8f, radius * 1.2f);
+	frameData.viewMatrix           = glm::lookAt(frameData.cameraPosition, centre, vec3(0.0f, 1.0f, 0.0f));
+	frameData.projectionMatrix     = glm::perspective(glm::radians(60.0f), float(FRAMEBUFFER_WIDTH) / float(FRAMEBUFFER_HEIGHT), radius * 0.01f, radius * 4.0f);
+	frameData.viewProjectionMatrix = frameData.projectionMatrix * frameData.viewMatrix;
+	frameData.time                 = 0.0f;
+	FrameUniforms::update(frameData);
+
+	modelShaderProgram->use();
+	modelMatrixUniform.set( mat4(1.0f) );
+	normalMatrixUniform.set( mat3(1.0f) );
+
+	GLuint queryId;
+	glCreateQueries(GL_TIME_ELAPSED, 1, &queryId);
+
+	// ----- Draw the mesh from each layout -----
+	cout << "\nDrawing " << model.getFaceElementCount() / 3 << " triangles (" << model.getNumVertices() << " vertices) " << DRAWS_PER_PASS
+	     << " times per pass, fastest of " << PASS_COUNT << " passes:" << endl;
+
+	const char*  layoutNames[]     = { "Separate:   ", "Interleaved:", "Quantised:  " };
+	const size_t layoutSizeBytes[] = { size_t(model.getVertexDataSizeBytes()) + model.getNormalDataSizeBytes(), model.getInterleavedDataSizeBytes(),
+	                                   model.getQuantisedDataSizeBytes() };
+	for (int layout = 0; layout < GpuMesh::VERTEX_LAYOUT_COUNT; ++layout)
+	{
+		GpuMesh::VertexLayout vertexLayout = static_cast<GpuMesh::VertexLayout>(layout);
+		if ( !mesh->hasLayout(vertexLayout) )
+		{
+			continue;
+		}
+
+		bool quantised = (vertexLayout == GpuMesh::QUANTISED_VERTEX_DATA);
+		positionDecodeScaleUniform.set( quantised ? model.getQuantisedPositionScale()  : vec3(1.0f) );
+		positionDecodeOffsetUniform.set( quantised ? model.getQuantisedPositionOffset() : vec3(0.0f) );
+		octahedralNormalsUniform.set(quantised);
+
+		// Draw once first so nothing we time includes setting anything up
+		mesh->draw(vertexLayout);
+		glFinish();
+
+		double fastestMs = 0.0;
+		for (int pass = 0; pass < PASS_COUNT; ++pass)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glBeginQuery(GL_TIME_ELAPSED, queryId);
+			for (int draw = 0; draw < DRAWS_PER_PASS; ++draw)
+			{
+				mesh->draw(vertexLayout);
+			}
+			glEndQuery(GL_TIME_ELAPSED);
+
+			GLuint64 elapsedNanoseconds;
+			glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsedNanoseconds);
+			double passMs = static_cast<double>(elapsedNanoseconds) / 1000000.0 / DRAWS_PER_PASS;
+			fastestMs = (pass == 0) ? passMs : std::min(fastestMs, passMs);
+		}
+
+		cout << "    " << layoutNames[layout] << " " << fastestMs << "ms per draw, " << layoutSizeBytes[layout] / model.getNumVertices() << " bytes per vertex ("
+		     << layoutSizeBytes[layout] / 1024 << "KB)" << endl;
+	}
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
+	{
+		cout << "[ERROR] OpenGL error " << error << " while benchmarking - the timings above may not be meaningful." << endl;
+	}
+
+	glDeleteQueries(1, &queryId);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &framebufferId);
+	glDeleteRenderbuffers(2, renderbufferIds);
+	delete mesh;
+	FrameUniforms::release();
+	delete modelShaderProgram;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		gridSize = atoi(argv[1]);
+		if (gridSize < 2)
+		{
+			cout << "Usage: vertex_layouts [grid size, at least 2]" << endl;
+			return 1;
+		}
+	}
+
+	if ( !glfwInit() )
+	{
+		cout << "glfwInit failed!" << endl;
+		return 1;
+	}
+
+	// We never show the window - we only need it for its OpenGL context, as we draw into a framebuffer of our own
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Vertex layout benchmark", nullptr, nullptr);
+	if (window == nullptr)
+	{
+		cout << "Could not create an OpenGL 4.6 context!" << endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if ( !gladLoadGL() )
+	{
+		cout << "GLAD failed to load OpenGL extensions!" << endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	runBenchmark();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
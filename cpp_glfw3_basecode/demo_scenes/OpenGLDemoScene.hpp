@@ -1,6 +1,8 @@
 #ifndef OPENGL_DEMO_SCENE_HPP
 #define OPENGL_DEMO_SCENE_HPP
 
+#include <chrono> // Needed to time how long mouse picking takes
+
 #include "glad/glad.h"
 
 #include "glm/gtc/type_ptr.hpp"    // Needed for the value_ptr() method
@@ -12,6 +14,11 @@
 #include "ShaderProgram.hpp"
 #include "Grid.h"
 #include "Model.h"
+#include "ModelLoader.h"
+#include "ModelCache.h"
+#include "GpuMesh.h"
+#include "Frustum.h"
+#include "TriangleBVH.h"
 #include "Window.h"
 
 class OpenGLDemoScene
@@ -19,15 +26,69 @@ class OpenGLDemoScene
 private:
     // Properties used to draw a 3D model
     ShaderProgram *modelShaderProgram;
-    GLuint modelVaoId, modelVertexBufferId, modelNormalBufferId;
+    GpuMesh *modelMesh = nullptr; // Note: This owns the model's buffers once they're uploaded, with a VAO for each vertex data layout
+
+    // Handles to the model shader's attributes and uniforms, looked up once when the shader program is set up
+    Attribute      modelPositionAttribute, modelNormalAttribute;
+    Uniform<mat4>  modelMatrixUniform;
+    Uniform<mat3>  normalMatrixUniform;
+    Uniform<vec3>  positionDecodeScaleUniform, positionDecodeOffsetUniform;
+    Uniform<bool>  octahedralNormalsUniform;
+    Uniform<vec3>  ambientMaterialColourUniform, diffuseMaterialColourUniform, specularMaterialColourUniform;
+    Uniform<float> specularPowerUniform;
+
+    // The vertex data layout we draw the model with - separate, interleaved or quantised (12 bytes per vertex)
+    int modelVertexLayout = GpuMesh::INTERLEAVED_VERTEX_DATA;
+
+    // Level of detail selection - either picked automatically from how big the model's simplification error looks on screen, or chosen by hand
+    bool  automaticModelLod   = true;
+    float modelLodErrorPixels = 1.0f;
+    int   modelLod            = 0;
+
+    // Meshlet culling - when we draw the full detail model we can skip the meshlets that are off-screen or facing away from the camera
+    bool                     cullModelMeshlets = true;
+    Model::MeshletCullResult modelMeshletCullResult;
+    vector<GLsizei>          modelMeshletDrawCounts;
+    vector<const GLvoid*>    modelMeshletDrawOffsets;
+
+    // The view frustum in world space, which we test each object's bounding volume against before drawing it
+    Frustum sceneFrustum;
+
+    // Mouse picking - a BVH over the model's triangles lets us find the triangle under the mouse cursor every frame
+    TriangleBVH         modelBVH;
+    TriangleBVH::RayHit modelPickHit;
+    bool                modelPicked     = false;
+    float               modelPickTimeMs = 0.0f;
+
+    // GPU timer queries so we can see how long the model takes to draw (e.g. to compare separate vs. interleaved vertex data).
+    // Note: We alternate between two queries so we're never waiting on the GPU for this frame's result.
+    GLuint modelDrawTimeQueryIds[2] = { 0, 0 };
+    int    modelDrawTimeQueryIndex  = 0;
+    float  modelDrawTimeMs          = 0.0f;
     mat4 modelMVP;
     mat4 modelMMatrix = mat4(1.0f);
     mat3 normalMatrix;
-    Model *model;
+    Model *model = nullptr; // Note: This stays null until the model has loaded in the background - the load handle owns it
     vec3 modelRotationSpeed;
 
+    // Background model loading - the model is parsed on a worker thread and its data uploaded to the GPU a chunk at a time each frame
+    ModelLoader        modelLoader;
+    ModelLoader::Handle modelLoadHandle;
+    int                modelUploadBudgetKB = static_cast<int>(ModelLoader::DEFAULT_UPLOAD_BUDGET_BYTES / 1024);
+
+    // A ring of cows shared through a model cache - the model is loaded and uploaded once, and each instance just has its own model matrix and level of detail
+    // Note: The shared GpuMesh only owns its vertex array objects - the cache owns the buffers, so we destroy the mesh before we clear the cache.
+    static constexpr int         MAX_SHARED_MODELS        = 32;
+    static constexpr float       SHARED_MODEL_RING_RADIUS = 150.0f;
+    ModelCache                   modelCache;
+    vector<ModelCache::Instance> sharedModelInstances;
+    GpuMesh                     *sharedModelMesh  = nullptr;
+    int                          sharedModelCount = 8;
+
     // Elements required to load and draw a textured quad
     ShaderProgram* texQuadShaderProgram;
+    Uniform<mat4> texQuadModelMatrixUniform;
+    Uniform<int>  texQuadTextureMapUniform;
     GLuint texQuadVaoId, texQuadVertexBufferId, textureID1, textureID2;
     GLint texture1SamplerID, texture2SamplerID;	// Note: If you want to use separate sampling units for each texture
     float quadSize = 50.0f;
@@ -39,8 +100,8 @@ private:
 
     // ----- Methods -----
 
-    // Setup the shader program to draw a 3D model
-    void setupModelShaderProgram(Model* model)
+    // Create the shader program to draw a 3D model and start it compiling - setupModelShaderProgram() finishes it off
+    void createModelShaderProgram()
     {
         // Setup the shader to draw our model
         modelShaderProgram = new ShaderProgram("Model Shader Program");
@@ -49,51 +110,55 @@ private:
         //modelShaderProgram->addShader(GL_TESS_CONTROL_SHADER, ShaderProgram::loadShaderFromFile("shaders/tessellation_control_shader.glsl"));
         //modelShaderProgram->addShader(GL_TESS_EVALUATION_SHADER, ShaderProgram::loadShaderFromFile("shaders/tessellation_evaluation_shader.glsl"));
 
-        modelShaderProgram->initialise();
-
-        // Add shader attributes
-        modelShaderProgram->bindAttribute("vertexPosition");
-        modelShaderProgram->bindAttribute("vertexNormal");
+        modelShaderProgram->beginInitialise();
+    }
 
-        // Add shader uniforms
-        modelShaderProgram->bindUniform("modelMatrix");
-        modelShaderProgram->bindUniform("viewMatrix");
-        modelShaderProgram->bindUniform("projectionMatrix");
-        modelShaderProgram->bindUniform("normalMatrix");
+    // Setup the shader program to draw a 3D model, once it's been initialised
+    void setupModelShaderProgram()
+    {
+        // Get handles to the shader attributes and uniforms
+        // Note: The shader program found all of these when it was initialised - getting a handle checks that each exists with the type we expect.
+        modelPositionAttribute = modelShaderProgram->getAttribute("vertexPosition");
+        modelNormalAttribute   = modelShaderProgram->getAttribute("vertexNormal");
+
+        modelMatrixUniform            = modelShaderProgram->getUniform<mat4>("modelMatrix");
+        normalMatrixUniform           = modelShaderProgram->getUniform<mat3>("normalMatrix");
+        positionDecodeScaleUniform    = modelShaderProgram->getUniform<vec3>("positionDecodeScale");
+        positionDecodeOffsetUniform   = modelShaderProgram->getUniform<vec3>("positionDecodeOffset");
+        octahedralNormalsUniform      = modelShaderProgram->getUniform<bool>("octahedralNormals");
+        ambientMaterialColourUniform  = modelShaderProgram->getUniform<vec3>("ambientMaterialColour");
+        diffuseMaterialColourUniform  = modelShaderProgram->getUniform<vec3>("diffuseMaterialColour");
+        specularMaterialColourUniform = modelShaderProgram->getUniform<vec3>("specularMaterialColour");
+        specularPowerUniform          = modelShaderProgram->getUniform<float>("specularPower");
 
         //modelShaderProgram->bindUniform("time"); // Number of seconds since starting (can be used for randomness within shaders but not currently used)
 
-        // Working in 3D so we have x/y/z components for the vertex position (we also use the same value for the number of normal components to use)
-        constexpr int VERTEX_COMPONENTS = 3;
+        // Note: glCreateQueries (unlike glGenQueries) makes the query objects straight away, so we can ask whether last frame's query has a result
+        //       on the very first frame, before it's ever been issued - it just says it has, with a time of 0.
+        glCreateQueries(GL_TIME_ELAPSED, 2, modelDrawTimeQueryIds);
+    }
 
-        // Get an Id for the Vertex Array Object (VAO) and bind to it
-        glGenVertexArrays(1, &modelVaoId);
-        glBindVertexArray(modelVaoId);
-
-	        // Generate a vertex position buffer, fill it, specify attributes and unbind
-	        glGenBuffers(1, &modelVertexBufferId);
-	        glBindBuffer(GL_ARRAY_BUFFER, modelVertexBufferId);
-	        glBufferData(GL_ARRAY_BUFFER, model->getVertexDataSizeBytes(), model->getVertexData(), GL_STATIC_DRAW);
-	        // Args: attribute location, num components, component data type, normalised?, stride, offset
-	        glVertexAttribPointer(modelShaderProgram->attribute("vertexPosition"), VERTEX_COMPONENTS, GL_FLOAT, false, 0, 0);
-	        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	        // Generate a normal buffer, fill it, specify attributes and unbind
-	        glGenBuffers(1, &modelNormalBufferId);
-	        glBindBuffer(GL_ARRAY_BUFFER, modelNormalBufferId);
-	        glBufferData(GL_ARRAY_BUFFER, model->getNormalDataSizeBytes(), model->getNormalData(), GL_STATIC_DRAW);			
-    		glVertexAttribPointer(modelShaderProgram->attribute("vertexNormal"), VERTEX_COMPONENTS, GL_FLOAT, false, 0, 0);
-
-	        // Enable the vertex attributes
-	        glEnableVertexAttribArray(modelShaderProgram->attribute("vertexPosition"));
-	        glEnableVertexAttribArray(modelShaderProgram->attribute("vertexNormal"));
-
-        // Unbind our Vertex Array object - all the buffer and attribute settings above will be associated with our VAO!
-        glBindVertexArray(0);
+    // Method to upload this frame's share of the model data, and hand the buffers to a GpuMesh (which sets up a VAO for each layout) once it's all on the GPU
+    void updateModelLoading()
+    {
+        modelLoader.update(static_cast<size_t>(modelUploadBudgetKB) * 1024);
+
+        if (model == nullptr && modelLoadHandle->isReady())
+        {
+            model     = modelLoadHandle->getModel();
+            modelMesh = new GpuMesh(*model, modelLoadHandle->getBuffers(), modelPositionAttribute.location, modelNormalAttribute.location);
+        }
     }
 
-    // Parameter-less version for our demo scene
-    void setupModelShaderProgram() { setupModelShaderProgram(model); }
+    // Method to give the model shader the colours of a material
+    // Note: The diffuse texture and opacity aren't used yet - phong.frag has no texture coordinates to sample with and we don't sort for blending.
+    void setModelMaterial(const Model::Material &material)
+    {
+        ambientMaterialColourUniform.set(material.ambientColour);
+        diffuseMaterialColourUniform.set(material.diffuseColour);
+        specularMaterialColourUniform.set(material.specularColour);
+        specularPowerUniform.set(material.specularPower);
+    }
 
     void drawModel(Model* model)
     {
@@ -102,8 +167,26 @@ private:
         // Specify the shader program we're using
         modelShaderProgram->use();
 
-        // Bind to our vertex array object
-        glBindVertexArray(modelVaoId);
+        // Bind to whichever vertex array object holds the vertex data layout we're using
+        modelMesh->bind( static_cast<GpuMesh::VertexLayout>(modelVertexLayout) );
+
+        // Tell the shader how to decode quantised vertex data (or to leave float vertex data as it is)
+        bool quantised = (modelVertexLayout == GpuMesh::QUANTISED_VERTEX_DATA);
+        positionDecodeScaleUniform.set( quantised ? model->getQuantisedPositionScale()  : vec3(1.0f) );
+        positionDecodeOffsetUniform.set( quantised ? model->getQuantisedPositionOffset() : vec3(0.0f) );
+        octahedralNormalsUniform.set(quantised);
+
+        // Pick up the draw time from the query we issued last frame (if it's ready) and start timing this frame's draw
+        GLuint previousQueryId = modelDrawTimeQueryIds[1 - modelDrawTimeQueryIndex];
+        GLint previousQueryAvailable = 0;
+        glGetQueryObjectiv(previousQueryId, GL_QUERY_RESULT_AVAILABLE, &previousQueryAvailable);
+        if (previousQueryAvailable)
+        {
+            GLuint64 elapsedNanoseconds;
+            glGetQueryObjectui64v(previousQueryId, GL_QUERY_RESULT, &elapsedNanoseconds);
+            modelDrawTimeMs = static_cast<float>(elapsedNanoseconds) / 1000000.0f;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, modelDrawTimeQueryIds[modelDrawTimeQueryIndex]);
 
         // Rotate the model matrix
         auto currentTime = static_cast<float>(glfwGetTime());
@@ -111,51 +194,189 @@ private:
         modelMMatrix = glm::rotate(modelMMatrix, currentTime * modelRotationSpeed.y, Utils::Y_AXIS);
         modelMMatrix = glm::rotate(modelMMatrix, currentTime * modelRotationSpeed.x, Utils::X_AXIS);
 
-        // Provide the model. view, and projection matrices
-        glUniformMatrix4fv(modelShaderProgram->uniform("modelMatrix"), 1, GL_FALSE, glm::value_ptr(modelMMatrix));
-        glUniformMatrix4fv(modelShaderProgram->uniform("viewMatrix"), 1, GL_FALSE, glm::value_ptr(Window::getViewMatrix()));
-        glUniformMatrix4fv(modelShaderProgram->uniform("projectionMatrix"), 1, GL_FALSE, glm::value_ptr(Window::getProjectionMatrix()));
+        // Provide the model matrix. Note: The view and projection matrices come from the FrameUniforms buffer, which Window::moveCamera writes each frame.
+        modelMatrixUniform.set(modelMMatrix);
 
         //glUniform1f(modelShaderProgram->uniform("time"), (GLfloat)glfwGetTime()); // Provide the current time to the shader (not currently used)
 
         // Calculate the normal matrix as the inverse transpose of a 3x3 of the Model matrix and provide it
         normalMatrix = glm::transpose(glm::inverse(mat3(modelMMatrix)));
-        glUniformMatrix3fv(modelShaderProgram->uniform("normalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        normalMatrixUniform.set(normalMatrix);
+
+        // Skip the model entirely if its bounding sphere is outside the view frustum
+        vec4 modelBoundingSphere = model->getTransformedBoundingSphere(modelMMatrix);
+        if ( sceneFrustum.isSphereVisible(vec3(modelBoundingSphere), modelBoundingSphere.w) )
+        {
+            // Draw the model as triangles
+            if (model->getDrawingMethod() == Model::DRAWING_AS_ELEMENTS)
+            {
+                // Pick a level of detail based on how far the model is from the camera
+                // Note: The x4 scale we gave the cow when it loaded is baked into its vertex data (and so into its level of detail errors), so only the
+                //       model matrix can make a model unit differ from a world unit - and we allow for it the same way as the bounding sphere does.
+                if (automaticModelLod)
+                {
+                    modelLod = selectAutomaticLod(*model, modelMMatrix);
+                }
+
+                // Draw each submesh with its material - the submeshes are sorted by material, so this is one material change per material
+                // Note: The meshlets only cover the full detail model, and the simpler levels of detail have few enough triangles not to need culling anyway
+                modelMeshletCullResult = Model::MeshletCullResult();
+                for (GLuint submeshNumber = 0; submeshNumber < model->getSubmeshCount(); ++submeshNumber)
+                {
+                    Model::Submesh submesh = model->getSubmesh(modelLod, submeshNumber);
+                    if (submesh.indexCount == 0)
+                    {
+                        continue;
+                    }
+                    setModelMaterial( model->getMaterial(submesh.materialIndex) );
+
+                    if (cullModelMeshlets && modelLod == 0 && submesh.meshletCount > 0)
+                    {
+                        Model::MeshletCullResult submeshCullResult = model->cullMeshlets(submeshNumber, modelMMatrix, Window::getViewMatrix(), Window::getProjectionMatrix(), modelMeshletDrawCounts, modelMeshletDrawOffsets);
+                        modelMesh->drawRanges(modelMeshletDrawCounts, modelMeshletDrawOffsets);
+                        modelMeshletCullResult.visible        += submeshCullResult.visible;
+                        modelMeshletCullResult.frustumCulled  += submeshCullResult.frustumCulled;
+                        modelMeshletCullResult.backFaceCulled += submeshCullResult.backFaceCulled;
+                    }
+                    else
+                    {
+                        modelMesh->drawSubmesh(modelLod, submeshNumber);
+                    }
+                }
+            }
+            else
+            {
+                // When drawing as arrays each submesh is a range of the vertices
+                for (GLuint submeshNumber = 0; submeshNumber < model->getSubmeshCount(); ++submeshNumber)
+                {
+                    setModelMaterial( model->getMaterial( model->getSubmesh(0, submeshNumber).materialIndex ) );
+                    modelMesh->drawSubmesh(0, submeshNumber);
+                }
+            }
+        }
+        else
+        {
+            modelMeshletCullResult = Model::MeshletCullResult();
+        }
 
-        // Draw the model as triangles
-        glDrawArrays(GL_TRIANGLES, 0, model->getNumVertices());
+        glEndQuery(GL_TIME_ELAPSED);
+        modelDrawTimeQueryIndex = 1 - modelDrawTimeQueryIndex;
 
         // Unbind from our vertex array object and disable our shader program
         glBindVertexArray(0);
         modelShaderProgram->disable();
     }
 
-    // Parameter-less version for our demo scene
-    void drawModel() { drawModel(model); }
+    // Method to pick a model's level of detail from how big its simplification error looks on screen
+    // Note: The model matrix may scale the model, so we go by its largest axis scale - the same as the transformed bounding sphere does.
+    GLuint selectAutomaticLod(const Model &lodModel, const mat4 &modelMatrix)
+    {
+        float distanceToModel = glm::length( vec3(Window::getViewMatrix() * modelMatrix * vec4(0.0f, 0.0f, 0.0f, 1.0f)) );
+        float modelScale      = std::max( glm::length( vec3(modelMatrix[0]) ), std::max( glm::length( vec3(modelMatrix[1]) ), glm::length( vec3(modelMatrix[2]) ) ) );
+        return lodModel.selectLod(Window::getProjectedSizePixels(modelScale, distanceToModel), modelLodErrorPixels);
+    }
 
-    // Method to load the C++/OpenGL textures and set up a shader program to draw them as a textured quad
-    void setupTexturedQuad()
+    // Method to get our shared cows from the model cache and stand them in a ring around the origin
+    // Note: Every instance asks the cache for the model, but only the first request loads it - the rest are hits which share its data and buffers.
+    void setupSharedModels()
+    {
+        for (int instanceNumber = 0; instanceNumber < MAX_SHARED_MODELS; ++instanceNumber)
+        {
+            ModelCache::Instance instance;
+            instance.mesh = modelCache.acquire("models/cow.obj", Model::DRAWING_AS_ELEMENTS);
+            if (instance.mesh == nullptr)
+            {
+                sharedModelInstances.clear();
+                return;
+            }
+
+            // The cow is 4 times the size of the one in the middle, as it can't be scaled in place - and stands on the lower grid, facing along the ring
+            float angle = glm::two_pi<float>() * static_cast<float>(instanceNumber) / static_cast<float>(MAX_SHARED_MODELS);
+            instance.modelMatrix = glm::translate(mat4(1.0f), vec3(cos(angle) * SHARED_MODEL_RING_RADIUS, -35.0f, sin(angle) * SHARED_MODEL_RING_RADIUS));
+            instance.modelMatrix = glm::rotate(instance.modelMatrix, -angle, Utils::Y_AXIS);
+            instance.modelMatrix = glm::scale(instance.modelMatrix, vec3(4.0f));
+            sharedModelInstances.push_back(instance);
+        }
+
+        sharedModelMesh = new GpuMesh( sharedModelInstances[0].mesh->createGpuMesh(modelPositionAttribute.location, modelNormalAttribute.location) );
+        modelCache.printStatistics();
+    }
+
+    // Method to draw the ring of shared cows - one vertex array object for all of them, with each instance culled and given a level of detail on its own
+    void drawSharedModels()
+    {
+        if (sharedModelMesh == nullptr)
+        {
+            return;
+        }
+
+        const Model &sharedModel = sharedModelInstances[0].mesh->getModel();
+
+        modelShaderProgram->use();
+        sharedModelMesh->bind( static_cast<GpuMesh::VertexLayout>(modelVertexLayout) );
+
+        bool quantised = (modelVertexLayout == GpuMesh::QUANTISED_VERTEX_DATA);
+        positionDecodeScaleUniform.set( quantised ? sharedModel.getQuantisedPositionScale()  : vec3(1.0f) );
+        positionDecodeOffsetUniform.set( quantised ? sharedModel.getQuantisedPositionOffset() : vec3(0.0f) );
+        octahedralNormalsUniform.set(quantised);
+
+        for (int instanceNumber = 0; instanceNumber < sharedModelCount; ++instanceNumber)
+        {
+            ModelCache::Instance &instance = sharedModelInstances[instanceNumber];
+
+            vec4 boundingSphere = sharedModel.getTransformedBoundingSphere(instance.modelMatrix);
+            if ( !sceneFrustum.isSphereVisible(vec3(boundingSphere), boundingSphere.w) )
+            {
+                continue;
+            }
+
+            instance.lod = automaticModelLod ? selectAutomaticLod(sharedModel, instance.modelMatrix) : std::min<GLuint>(modelLod, sharedModel.getLodCount() - 1);
+
+            modelMatrixUniform.set(instance.modelMatrix);
+            normalMatrixUniform.set( glm::transpose( glm::inverse( mat3(instance.modelMatrix) ) ) );
+            for (GLuint submeshNumber = 0; submeshNumber < sharedModel.getSubmeshCount(); ++submeshNumber)
+            {
+                setModelMaterial( sharedModel.getMaterial( sharedModel.getSubmesh(instance.lod, submeshNumber).materialIndex ) );
+                sharedModelMesh->drawSubmesh(instance.lod, submeshNumber);
+            }
+        }
+
+        glBindVertexArray(0);
+        modelShaderProgram->disable();
+    }
+
+    // Parameter-less version for our demo scene - we only draw the model once it's finished loading
+    void drawModel()
+    {
+        if (model != nullptr)
+        {
+            drawModel(model);
+        }
+    }
+
+    // Method to load the C++/OpenGL textures
+    void loadTextures()
     {
-        // Load textures!
         textureID1 = Utils::loadTexture("textures/opengl_logo.png");
         textureID2 = Utils::loadTexture("textures/cpp_logo.png");
+    }
 
-        // ------------- Textured Quad shader ------------------------
-
-        // Setup the shader to draw our model
+    // Method to create the shader program to draw the textured quad and start it compiling - setupTexturedQuad() finishes it off
+    void createTexturedQuadShaderProgram()
+    {
         texQuadShaderProgram = new ShaderProgram("Textured Quad Shader Program");
         texQuadShaderProgram->addShader(GL_VERTEX_SHADER, ShaderProgram::loadShaderFromFile("shaders/textured_quad.vert"));
         texQuadShaderProgram->addShader(GL_FRAGMENT_SHADER, ShaderProgram::loadShaderFromFile("shaders/textured_quad.frag"));
-        texQuadShaderProgram->initialise();
+        texQuadShaderProgram->beginInitialise();
+    }
 
-        // Add shader attributes
-        texQuadShaderProgram->bindAttribute("position");
-        texQuadShaderProgram->bindAttribute("texCoords");
+    // Method to set up the textured quad and the shader program to draw it, once the shader program has been initialised
+    void setupTexturedQuad()
+    {
 
-        // Add shader uniforms
-        texQuadShaderProgram->bindUniform("modelMatrix");
-        texQuadShaderProgram->bindUniform("projectionMatrix");
-        texQuadShaderProgram->bindUniform("textureMap");
+        // Get handles to the shader uniforms (the attributes are only needed while we set up the vertex array object below)
+        texQuadModelMatrixUniform = texQuadShaderProgram->getUniform<mat4>("modelMatrix");
+        texQuadTextureMapUniform  = texQuadShaderProgram->getUniform<int>("textureMap");
 
         // x/y/z for each vertex plus s/t for the texture coordinates
         constexpr int VERTEX_COMPONENTS = 3;
@@ -208,9 +429,6 @@ private:
         vec3 normal = glm::normalize(glm::cross(vec3(modelRight), vec3(modelUp)));
         float dotProduct = glm::dot(normal, Utils::Z_AXIS);
 
-        // Get the location of the "textureMap" uniform. Note: Don't use texQuadShaderProgram->uniform("textureMap") for this! We need it as an int!
-        GLint textureMapLocation = glGetUniformLocation(texQuadShaderProgram->getProgramID(), "textureMap");
-
         // Pointing forward? Draw OpenGL logo texture...
         // Note: Just as an example I'm using sampler unit 0 for one texture and then sampler unit 1 for another - you don't have to do this.
         if (dotProduct < 0.0f)
@@ -219,21 +437,20 @@ private:
             texQuadModelMatrix = glm::rotate(texQuadModelMatrix, glm::pi<float>(), Utils::Y_AXIS);
 
             // Send the shader program the texture image unit we'll be using (0), then set that as active & bind the texture to it
-            glUniform1i(textureMapLocation, 0);
+            texQuadTextureMapUniform.set(0);
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, textureID1);
         }
         else // ...otherwise draw the "C++" texture.
         {
             // Send the shader program the texture image unit we'll be using (1), then set that as active & bind the texture to it
-            glUniform1i(textureMapLocation, 1);
+            texQuadTextureMapUniform.set(1);
             glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, textureID2);
         }
 
-        // Provide the ModelView and Projection matrix uniforms
-        glUniformMatrix4fv(texQuadShaderProgram->uniform("modelMatrix"), 1, GL_FALSE, glm::value_ptr(texQuadModelMatrix));
-        glUniformMatrix4fv(texQuadShaderProgram->uniform("projectionMatrix"), 1, GL_FALSE, glm::value_ptr(Window::getOrthoProjectionMatrix()));
+        // Provide the model matrix uniform (the orthographic projection matrix is in the FrameUniforms buffer)
+        texQuadModelMatrixUniform.set(texQuadModelMatrix);
 
         // Draw the quad
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
@@ -248,9 +465,35 @@ private:
     {
         // Data we'll use in our GUI
         string fpsString      = "FPS: " + std::to_string(Window::getFPS());
+        string drawTimeString = "Model draw time (GPU): " + std::to_string(modelDrawTimeMs) + "ms";
+        string lodString      = model ? "LOD " + std::to_string(modelLod) + ": " + std::to_string(model->getLod(modelLod).indexCount / 3) + " triangles" : string("LOD: -");
+        string materialString = model ? "Materials: " + std::to_string(model->getMaterialCount()) + ", submeshes: " + std::to_string(model->getSubmeshCount()) : string("Materials: -");
+        string meshletString  = "Meshlets drawn: " + std::to_string(modelMeshletCullResult.visible) + " / " + std::to_string(model ? model->getMeshletCount() : 0);
+        string objectsString  = "Objects drawn: " + std::to_string(sceneFrustum.getVisibleCount()) + ", culled: " + std::to_string(sceneFrustum.getCulledCount());
+        string pickString     = modelPicked ? "Picked triangle " + std::to_string(modelPickHit.triangle) + " at distance " + std::to_string(modelPickHit.distance)
+                                            : string("Picked triangle: none");
+        ModelCache::Statistics cacheStatistics = modelCache.getStatistics();
+        string cacheString    = "Model cache: " + std::to_string(cacheStatistics.hits) + " hits, " + std::to_string(cacheStatistics.misses) + " misses, "
+                              + std::to_string(cacheStatistics.cpuBytesSaved / 1024) + "KB saved";
+        string pickTimeString = "Pick time (BVH): " + std::to_string(modelPickTimeMs * 1000.0f) + " microseconds";
+        string culledString   = "Culled: " + std::to_string(modelMeshletCullResult.frustumCulled) + " off-screen, " + std::to_string(modelMeshletCullResult.backFaceCulled) + " back-facing";
         string horizFoVString = "Horiz FoV: " + std::to_string(Window::getHorizFoVDegs());
         string foVModeString  = "FoV Mode: " + Window::getFoVModeString();
 
+        // How the model's background load is getting on
+        string loadString;
+        switch (modelLoadHandle->getState())
+        {
+            case ModelLoader::LOAD_QUEUED:    loadString = "Model: queued";  break;
+            case ModelLoader::LOAD_PARSING:   loadString = "Model: loading"; break;
+            case ModelLoader::LOAD_UPLOADING: loadString = "Model: uploading (" + std::to_string(static_cast<int>(modelLoadHandle->getUploadProgress() * 100.0f)) + "%)"; break;
+            case ModelLoader::LOAD_FAILED:    loadString = "Model: failed to load"; break;
+            default:
+                loadString = "Model: loaded in " + std::to_string(modelLoadHandle->getLoadTimeMs()) + "ms, uploaded over "
+                           + std::to_string(modelLoadHandle->getUploadFrameCount()) + " frame(s)";
+                break;
+        }
+
         auto camera = Window::getCamera();
 
         string camRotDegsString = "Cam Rot (Degs): " + glm::to_string(camera->getRotationDegs());
@@ -263,7 +506,7 @@ private:
 
         // Create a window with the given title & append into it
         ImGui::SetNextWindowPos(ImVec2(20, 20));
-        ImGui::SetNextWindowSize(ImVec2(380, 325));
+        ImGui::SetNextWindowSize(ImVec2(380, 600));
         ImGui::Begin("Details / Settings");
 		ImGui::SeparatorText("Controls");
 			ImGui::Text("Use WSAD(Q/E) to move the camera & hold the RMB");
@@ -272,6 +515,8 @@ private:
                 ImGui::Text("field of view modes.");				
     		ImGui::SeparatorText("Details");
 			ImGui::Text(fpsString.c_str());
+		        ImGui::Text(drawTimeString.c_str());
+		        ImGui::Text(loadString.c_str());
 		        ImGui::Text(horizFoVString.c_str());
                 ImGui::Text(foVModeString.c_str());
 		        ImGui::Text(camRotDegsString.c_str());
@@ -280,6 +525,24 @@ private:
 		        ImGui::SliderFloat("X Rot Speed", &modelRotationSpeed.x, -5.0f, 5.0f);
 		        ImGui::SliderFloat("Y Rot Speed", &modelRotationSpeed.y, -5.0f, 5.0f);
 		        ImGui::SliderFloat("Z Rot Speed", &modelRotationSpeed.z, -5.0f, 5.0f);
+		        ImGui::Text("Vertex data:");
+		        ImGui::SameLine(); ImGui::RadioButton("Separate",    &modelVertexLayout, GpuMesh::SEPARATE_VERTEX_DATA);
+		        ImGui::SameLine(); ImGui::RadioButton("Interleaved", &modelVertexLayout, GpuMesh::INTERLEAVED_VERTEX_DATA);
+		        ImGui::SameLine(); ImGui::RadioButton("Quantised",   &modelVertexLayout, GpuMesh::QUANTISED_VERTEX_DATA);
+		        ImGui::Checkbox("Automatic LOD", &automaticModelLod);
+		        ImGui::SameLine(); ImGui::SliderFloat("Max error (px)", &modelLodErrorPixels, 0.1f, 10.0f);
+		        ImGui::SliderInt("LOD", &modelLod, 0, model ? static_cast<int>(model->getLodCount()) - 1 : 0);
+		        ImGui::Text(lodString.c_str());
+		        ImGui::Text(materialString.c_str());
+		        ImGui::Text(objectsString.c_str());
+		        ImGui::Checkbox("Meshlet culling", &cullModelMeshlets);
+		        ImGui::Text(meshletString.c_str());
+		        ImGui::Text(culledString.c_str());
+		        ImGui::Text(pickString.c_str());
+		        ImGui::Text(pickTimeString.c_str());
+		        ImGui::SliderInt("Upload budget (KB/frame)", &modelUploadBudgetKB, 16, 16 * 1024);
+		        ImGui::SliderInt("Shared cows", &sharedModelCount, 0, static_cast<int>( sharedModelInstances.size() ));
+		        ImGui::Text(cacheString.c_str());
         ImGui::End();
 
         // Rendering
@@ -290,19 +553,23 @@ private:
     // Method to draw the orientation grids
     void drawGrids()
     {
-        lowerGrid->draw( Window::getViewProjectionMatrix() );
-        upperGrid->draw( Window::getViewProjectionMatrix() );
+        lowerGrid->draw();
+        upperGrid->draw();
     }
 
 public:
     // Constructor
     OpenGLDemoScene()
     {
-        // Load our cow model & scale it up.
-       // Note: If we use `Model::DRAWING_AS_ELEMENTS` then while the vertex count is decreased the normals are per-FACE rather than per-VERTEX,
-       // so it gives the models a very 'faceted' look.
-        model = new Model("models/cow.obj", Model::DRAWING_AS_ARRAYS);
-        model->scale(4.0f);
+        // Start loading our cow model in the background. Once it's loaded (and still on the worker thread) we scale it up and build the BVH we use
+        // for mouse picking (after scaling, as it copies the triangles) - the model's data then gets uploaded over the next few frames.
+        // Note: Drawing as elements welds together vertices that share the same position and normal, so we keep smooth per-VERTEX normals
+        // while using far less vertex memory than `Model::DRAWING_AS_ARRAYS` (which duplicates every vertex of every face).
+        modelLoadHandle = modelLoader.loadAsync("models/cow.obj", Model::DRAWING_AS_ELEMENTS, ModelLoader::UPLOAD_ALL_DATA, [this](Model &loadedModel)
+        {
+            loadedModel.scale(4.0f);
+            modelBVH.build(loadedModel);
+        });
         modelRotationSpeed = vec3(0.0f, 0.0f, 0.0f);
 
         // TODO: Surely there has to be a way to do this 'nicely' via some `new float[] { value1, value2 }` stuff - but C++ complains =/
@@ -340,23 +607,64 @@ public:
     {
         delete upperGrid;
         delete lowerGrid;
-        delete model;
+        glDeleteQueries(2, modelDrawTimeQueryIds);
+        delete modelMesh;
+        delete sharedModelMesh;
+        sharedModelInstances.clear();
+        modelCache.clear();
         delete modelShaderProgram;
         delete texQuadShaderProgram;
     }
 
+    // Method to find which triangle of the model (if any) is under the mouse cursor
+    // Note: The BVH is in model space, so we transform the pick ray by the inverse of the model matrix rather than transforming the whole model
+    void pickModel()
+    {
+        if (model == nullptr)
+        {
+            return;
+        }
+
+        double cursorX, cursorY;
+        glfwGetCursorPos(Window::getGlfwWindow(), &cursorX, &cursorY);
+
+        vec3 rayOrigin, rayDirection;
+        Window::getPickRay(cursorX, cursorY, rayOrigin, rayDirection);
+
+        auto pickStartTime = std::chrono::steady_clock::now();
+        mat4 inverseModelMatrix = glm::inverse(modelMMatrix);
+        vec3 modelRayOrigin     = vec3( inverseModelMatrix * vec4(rayOrigin,    1.0f) );
+        vec3 modelRayDirection  = vec3( inverseModelMatrix * vec4(rayDirection, 0.0f) );
+        modelPicked = modelBVH.intersectRay(modelRayOrigin, modelRayDirection, modelPickHit);
+        std::chrono::duration<float, std::milli> pickDuration = std::chrono::steady_clock::now() - pickStartTime;
+        modelPickTimeMs = pickDuration.count();
+    }
+
     // Method to call all setup functions we require
+    // Note: Every shader program is started before we wait on any of them (the grids started theirs when they were created), and the textures
+    //       load while the driver compiles them.
     void setup()
     {
+        createModelShaderProgram();
+        createTexturedQuadShaderProgram();
+
+        loadTextures();
+
+        ShaderProgram::initialiseAll({ modelShaderProgram, texQuadShaderProgram, Grid::getShaderProgram() });
         setupModelShaderProgram();
         setupTexturedQuad();
+        setupSharedModels();
     }
 
     // Method to draw all the elements of our OpenGL demo scene
     void draw()
     {
+        updateModelLoading();
+        sceneFrustum.update( Window::getViewProjectionMatrix() );
         drawGrids();
         drawModel();
+        drawSharedModels();
+        pickModel();
         drawTexturedQuad();
         drawGUI();
     }
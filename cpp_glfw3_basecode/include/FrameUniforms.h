@@ -0,0 +1,66 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+// Note: This header doesn't pull in GLAD so that Window.cpp (which uses the system OpenGL header via GLFW) can include it - GLFW won't pull in
+//       the system header again if GLAD has already been included.
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+
+using glm::vec3;
+using glm::mat4;
+
+// Class to hold the camera matrices, camera position and time that every built-in shader reads from a single uniform buffer, which is
+// written once per frame (by Window::moveCamera) rather than each draw call uploading its own copy of the matrices with glUniformMatrix4fv.
+//
+// Note: A shader uses the per-frame data by declaring this uniform block, which must match the Data struct below member for member:
+//
+//           layout(std140) uniform FrameUniforms
+//           {
+//               mat4  viewMatrix;
+//               mat4  projectionMatrix;
+//               mat4  viewProjectionMatrix;
+//               mat4  orthoProjectionMatrix;
+//               vec3  cameraPosition;
+//               float time;
+//           };
+//
+// Also: ShaderProgram points any block called FrameUniforms at BINDING when it's initialised (with glUniformBlockBinding, so it works for
+//       shaders older than #version 420 which can't say layout(binding = 0) themselves), and stops if the block isn't the size of Data.
+// Further: std140 puts each mat4 on a 16 byte boundary and lets a float follow a vec3 in the same 16 bytes, so Data needs no padding - but any
+//          member added later must keep to the std140 rules (e.g. a lone vec3 after a mat4 needs padding out to 16 bytes).
+class FrameUniforms
+{
+    public:
+        // The uniform buffer binding point the block is read from, and the name of the block in the shaders
+        static const GLuint BINDING = 0;
+        inline static const char* BLOCK_NAME = "FrameUniforms";
+
+        // The contents of the uniform buffer, laid out as std140
+        struct Data
+        {
+            mat4  viewMatrix;
+            mat4  projectionMatrix;
+            mat4  viewProjectionMatrix;
+            mat4  orthoProjectionMatrix;
+            vec3  cameraPosition;
+            float time;
+        };
+        static_assert(sizeof(Data) == 4 * 64 + 16, "FrameUniforms::Data must match the std140 layout of the FrameUniforms block");
+
+        // Method to write this frame's data into the uniform buffer and bind it to BINDING.
+        // Note: The buffer is created the first time this is called, as we can't make one until GLAD has loaded the OpenGL functions.
+        static void update(const Data &data);
+
+        // Method to delete the uniform buffer - call this while the OpenGL context still exists
+        static void release();
+
+        // Getters
+        static GLuint      getBufferId()  { return bufferId;  }
+        static const Data& getFrameData() { return frameData; }
+
+    private:
+        static GLuint bufferId;
+        static Data   frameData;
+};
+
+#endif // FRAME_UNIFORMS_H
@@ -0,0 +1,65 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cstddef>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "glm/glm.hpp"
+
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+
+// Class to hold the six planes of a view frustum and test bounding volumes against them.
+//
+// Note: The planes are extracted straight from a combined (projection * view) matrix using Gribb & Hartmann's method, so they're in
+//       whatever space the matrix transforms from - pass in projection * view for world space, or projection * view * model for model space.
+// Also: The tests are conservative - a volume which is outside the frustum is always reported as outside, but a volume near a corner of the
+//       frustum may be reported as visible even though it's just outside it. That's fine for culling, as the GPU clips anything we let through.
+class Frustum
+{
+    public:
+        // The planes in the order we store them
+        // Note: We can't call these NEAR and FAR as windows.h defines those as macros
+        enum Plane { LEFT_PLANE = 0, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, NUM_PLANES };
+
+        // Constructors
+        Frustum() = default;
+        explicit Frustum(const mat4 &viewProjectionMatrix);
+
+        // Method to extract the frustum planes from a combined projection * view matrix. This also resets the visible and culled counts.
+        void update(const mat4 &viewProjectionMatrix);
+
+        // Methods to test a single bounding sphere or axis-aligned bounding box against the frustum. Returns true if it may be visible.
+        bool isSphereVisible(const vec3 &centre, float radius);
+        bool isAABBVisible(const vec3 &boundsMin, const vec3 &boundsMax);
+
+        // Methods to test a batch of bounding volumes against the frustum, setting visible[n] to 1 if volume n may be visible or 0 if it's culled.
+        // Returns the number of visible volumes. Spheres are given as their centre x/y/z and radius in w.
+        // Note: Where SSE is available these test four volumes at a time against each plane, so they're much quicker than testing one at a time.
+        size_t cullSpheres(const vec4* spheres, size_t count, GLubyte* visible);
+        size_t cullAABBs(const vec3* boundsMin, const vec3* boundsMax, size_t count, GLubyte* visible);
+
+        // Getters
+        // Note: The counts include every volume tested since the planes were last updated (or the counts were last reset)
+        vec4   getPlane(Plane plane) const { return planes[plane]; }
+        size_t getVisibleCount()     const { return visibleCount;   }
+        size_t getCulledCount()      const { return culledCount;    }
+
+        // Method to reset the visible and culled counts without changing the planes
+        void resetCounts() { visibleCount = 0; culledCount = 0; }
+
+    private:
+        // The frustum planes as (normal x, normal y, normal z, distance) with the normals pointing into the frustum and normalised,
+        // so that dot(normal, point) + distance is the signed distance of a point from the plane.
+        vec4 planes[NUM_PLANES] = {};
+
+        // How many volumes we've found to be visible and culled
+        size_t visibleCount = 0;
+        size_t culledCount  = 0;
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,100 @@
+#ifndef GPU_MESH_H
+#define GPU_MESH_H
+
+#include <vector>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "Model.h"
+#include "ModelLoader.h"
+
+using std::vector;
+
+// Class which owns the GPU side of a model - the buffers its data lives in and a vertex array object for each vertex data layout it has - and draws it.
+//
+// Note: Buffers are allocated with immutable storage (glBufferStorage) so the driver knows their size will never change, and the ones we fill
+//       ourselves can't be touched by the CPU again at all, which leaves the driver free to put them wherever the GPU reads them fastest. The
+//       vertex array objects are set up through direct state access, so creating a mesh never disturbs whatever is currently bound.
+// Also: A mesh copies what it needs to draw (the levels of detail, submeshes and index type) from its model, so it can be drawn without the model.
+// Further: The destructor deletes the buffers and vertex array objects, so a mesh must be destroyed while the OpenGL context is still current.
+//          Meshes can be moved but not copied, so there's only ever one owner of the GL objects. The exception is a mesh made with SHARE_BUFFERS
+//          (e.g. by ModelCache::SharedMesh::createGpuMesh), which only owns its vertex array objects and leaves the buffers to whoever made them.
+class GpuMesh
+{
+    public:
+        // The vertex data layouts a mesh can be drawn from - see Model::getInterleavedData and Model::getQuantisedData
+        enum VertexLayout { SEPARATE_VERTEX_DATA = 0, INTERLEAVED_VERTEX_DATA = 1, QUANTISED_VERTEX_DATA = 2, VERTEX_LAYOUT_COUNT = 3 };
+
+        // Whether a mesh made from existing buffers deletes them when it's done with them, or leaves them alone for other meshes to keep using
+        enum BufferOwnership { OWN_BUFFERS = 0, SHARE_BUFFERS = 1 };
+
+        // Constructor which uploads the layouts given by uploadFlags (see ModelLoader::UPLOAD_SEPARATE_DATA etc.) from a model into new buffers
+        // which the CPU can't access. The attribute locations are those of the shader the mesh will be drawn with (-1 for any it doesn't use).
+        GpuMesh(const Model &model, GLuint uploadFlags, GLint positionLocation, GLint normalLocation, GLint texCoordLocation = -1);
+
+        // Constructor which draws from buffers a model has already been uploaded into. By default the mesh takes ownership of them (e.g. the
+        // buffers of a model loaded by a ModelLoader). With SHARE_BUFFERS it doesn't, so the buffers must outlive the mesh.
+        GpuMesh(const Model &model, const ModelLoader::ModelBuffers &modelBuffers, GLint positionLocation, GLint normalLocation, GLint texCoordLocation = -1,
+                BufferOwnership ownership = OWN_BUFFERS);
+
+        // Destructor - deletes our vertex array objects, and our buffers if we own them
+        ~GpuMesh();
+
+        // A mesh owns GL objects, so it can be moved but not copied
+        GpuMesh(const GpuMesh&) = delete;
+        GpuMesh& operator=(const GpuMesh&) = delete;
+        GpuMesh(GpuMesh &&source) noexcept;
+        GpuMesh& operator=(GpuMesh &&source) noexcept;
+
+        // Method to find out whether we have the data to draw from a layout
+        bool hasLayout(VertexLayout layout) const;
+
+        // Method to draw a level of detail of the whole mesh from a layout with a single draw call.
+        // Note: This leaves the mesh's vertex array object bound. A mesh drawn as arrays only has the one level of detail.
+        void draw(VertexLayout layout, GLuint lodNumber = 0) const;
+
+        // Method to bind the vertex array object of a layout, to draw parts of the mesh with drawSubmesh() or drawRanges()
+        void bind(VertexLayout layout) const;
+
+        // Method to draw one submesh (i.e. the triangles of one material) of a level of detail. The mesh must be bound.
+        void drawSubmesh(GLuint lodNumber, GLuint submeshNumber) const;
+
+        // Method to draw a set of ranges of the face data in one call, e.g. the meshlets left by Model::cullMeshlets. The mesh must be bound.
+        void drawRanges(const vector<GLsizei> &counts, const vector<const GLvoid*> &offsets) const;
+
+        // Getters
+        const ModelLoader::ModelBuffers& getBuffers() const { return buffers; }
+        GLuint getVaoId(VertexLayout layout)          const { return vaoIds[layout]; }
+        GLuint getLodCount()                          const { return static_cast<GLuint>( lods.size() ); }
+        GLuint getSubmeshCount()                      const { return submeshCount; }
+
+        // Method to create a buffer holding the given data with immutable storage the CPU can't access - returns its id (or 0 if there's no data)
+        static GLuint createStaticBuffer(const GLvoid* data, size_t sizeBytes);
+
+    private:
+        ModelLoader::ModelBuffers buffers;
+        BufferOwnership           bufferOwnership             = OWN_BUFFERS;
+        GLuint                    vaoIds[VERTEX_LAYOUT_COUNT] = { 0, 0, 0 };
+
+        // What we need from the model to draw it
+        Model::DrawingMethod    drawingMethod;
+        GLenum                  faceIndexType;
+        GLuint                  faceIndexSizeBytes;
+        GLuint                  numVertices;
+        vector<Model::LodLevel> lods;
+        vector<Model::Submesh>  submeshes;
+        GLuint                  submeshCount;
+
+        // Private method to copy what we need to draw from the model
+        void copyDrawingDetails(const Model &model);
+
+        // Private method to create a vertex array object for each layout we have the buffers for
+        void createVertexArrays(GLint positionLocation, GLint normalLocation, GLint texCoordLocation);
+
+        // Private method to delete our vertex array objects and (if we own them) our buffers
+        void release();
+};
+
+#endif // GPU_MESH_H
@@ -35,13 +35,19 @@ class Grid
 
         // ----- Non-Static Properties -----
 
-        GLuint gridVaoId;          // The id of the Vertex Array Object  (VAO) containing our shader program details
+        GLuint gridVaoId = 0;      // The id of the Vertex Array Object  (VAO) containing our shader program details
         GLuint gridVertexBufferId; // The id of the Vertex Buffer Object (VBO) containing our vertex data
 
         int numVerts;              // How many vertices in this grid?
 
         float *gridVertexArray;    // Pointer to an array of floats used to draw the grid
 
+        // ----- Private methods -----
+
+        // Method to set up the VAO which points the shader's vertex position attribute at our vertex buffer.
+        // Note: This needs the attribute's location, so it waits for the shader program to finish initialising if it hasn't already.
+        void setupVertexArray();
+
     public:
         // Constructor
         // Note: width is along +/- x-axis, depth is along +/- z-axis, height is the location on
@@ -51,9 +57,13 @@ class Grid
         // Destructor
         ~Grid();
 
-        // Method to draw the grid - just takes a combined Model/View/Projection matrix
-        // to pass to the shader as a uniform.
-        void draw(glm::mat4 mvpMatrix);
+        // Method to draw the grid.
+        // Note: The grid is in world space and the shader gets the camera matrices from the FrameUniforms block, so there's nothing to pass in.
+        void draw();
+
+        // Method to get the shader program every grid draws with, e.g. to initialise it along with other programs in ShaderProgram::initialiseAll.
+        // Note: The program is created (and starts compiling) along with the first grid, so this is null until then.
+        static ShaderProgram* getShaderProgram() { return gridShaderProgram; }
 };
 
 #endif // GRID_H
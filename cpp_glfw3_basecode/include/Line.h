@@ -59,6 +59,9 @@ class Line
 
         static void setupShaderProgram();
 
+        // Method to set up the VAO which points the shader's attributes at our vertex buffer, once the shader program has finished initialising
+        static void setupVertexArray();
+
     public:
         // Default constructor
         Line();
@@ -78,9 +81,13 @@ class Line
         void setlineWidth(float lineWdith);
 
 
-        // Method to draw the line - just takes a combined Model/View/Projection matrix
-        // to pass to the shader as a uniform.
-        void draw(mat4 mvpMatrix);
+        // Method to draw the line.
+        // Note: Lines are given in world space, so the shader only needs the view-projection matrix from the per-frame FrameUniforms buffer.
+        void draw();
+
+        // Method to get the shader program every line draws with, e.g. to initialise it along with other programs in ShaderProgram::initialiseAll.
+        // Note: The program is created (and starts compiling) along with the first line, so this is null until then.
+        static ShaderProgram* getShaderProgram() { return lineShaderProgram; }
 };
 
 #endif // LINE_H
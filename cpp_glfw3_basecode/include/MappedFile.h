@@ -0,0 +1,56 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+using std::string;
+
+// Class to map a file into memory as a read-only block of bytes.
+//
+// Note: Reading a file through a memory mapping lets us walk the file contents directly without copying lines
+//       into strings (or anything else) first - the OS pages the data in for us as we touch it.
+// Also: The mapping is private (copy-on-write), so callers may modify the mapped bytes without changing the file on disk.
+class MappedFile
+{
+    private:
+        // Pointer to the start of the mapped file contents and the size of the mapping in bytes
+        char*  mappedData = nullptr;
+        size_t mappedSize = 0;
+
+        // Platform specific handles - only used on Windows, where we need a file handle AND a mapping handle
+        void* fileHandle    = nullptr;
+        void* mappingHandle = nullptr;
+
+        // Whether we successfully opened the file (an empty file is open but has no mapped data)
+        bool opened = false;
+
+    public:
+        // Constructors
+        MappedFile() = default;
+        MappedFile(const string& filename);
+
+        // Destructor - unmaps the file if it's mapped
+        ~MappedFile();
+
+        // A mapping is a unique resource - it can be moved but not copied
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& source) noexcept;
+        MappedFile& operator=(MappedFile&& source) noexcept;
+
+        // Method to map a file into memory. Returns true on success.
+        // Note: Opening an empty file succeeds, but leaves us with a null data pointer and a size of zero.
+        bool open(const string& filename);
+
+        // Method to unmap the file and release all handles
+        void close();
+
+        // Getters
+        bool        isOpen() const { return opened;     }
+        const char* data()   const { return mappedData; }
+        char*       data()         { return mappedData; }
+        size_t      size()   const { return mappedSize; }
+};
+
+#endif // MAPPED_FILE_H
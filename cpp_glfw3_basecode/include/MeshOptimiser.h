@@ -0,0 +1,159 @@
+#ifndef MESH_OPTIMISER_H
+#define MESH_OPTIMISER_H
+
+#include <vector>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "glm/glm.hpp"
+
+using std::vector;
+using glm::vec3;
+
+// Class of static methods to reorder indexed triangle meshes so that the GPU can draw them more efficiently.
+//
+// Note: All methods work on a flat list of triangle indices (three per triangle) into a vertex array of numVertices vertices.
+// Also: The GPU keeps the results of recently transformed vertices in a small "post-transform" cache. If a triangle refers to a
+//       vertex which is still in the cache then the vertex shader doesn't need to run for it again - so the order in which we
+//       draw triangles can make a big difference to how many times the vertex shader runs.
+class MeshOptimiser
+{
+    public:
+        // The number of vertices we assume the post-transform cache holds when reporting statistics.
+        // Note: Real hardware varies (and many GPUs don't use a simple FIFO at all), but a 16 entry FIFO is the usual yardstick.
+        static const GLuint STATS_CACHE_SIZE = 16;
+
+        // The default width and height in pixels of each view we rasterise when analysing overdraw
+        static const int OVERDRAW_RESOLUTION = 256;
+
+        // Method to reorder triangles so that they reuse vertices which are likely to still be in the post-transform cache.
+        // Note: This is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" - each vertex is scored on how recently it was
+        //       used and how many triangles still need it, and we greedily draw whichever triangle has the highest total score.
+        static void optimiseVertexCache(vector<GLuint> &indices, GLuint numVertices);
+
+        // Method to renumber vertices in the order that the triangles first use them so that vertex fetches walk through memory
+        // sequentially. Returns a remap table where remap[oldVertexIndex] is the new index of that vertex - use it to reorder
+        // the vertex data to match. The indices are rewritten in place.
+        // Note: Vertices which aren't used by any triangle are moved to the end.
+        static vector<GLuint> optimiseVertexFetch(vector<GLuint> &indices, GLuint numVertices);
+
+        // The default ACMR threshold for overdraw optimisation - clusters may be split as long as their ACMR stays within 5% of the cache-optimised order
+        static constexpr float DEFAULT_OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+        // Method to reorder the triangles of a (vertex cache optimised) mesh so that parts of the mesh which are likely to hide other parts are drawn first.
+        // Note: This is the clustering approach from Sander, Nehab & Barczak's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+        //       The triangles are split into clusters wherever the vertex cache order allows it, and the clusters are then sorted so that those
+        //       which face away from the centre of the mesh are drawn first. As this doesn't depend on the view direction it only has to be done once.
+        // Also: Clusters are only split at points where the ACMR of the cluster so far is within acmrThreshold times the ACMR of the whole cluster,
+        //       so a threshold of 1.0 keeps the vertex cache efficiency (almost) exactly the same and larger values trade it for less overdraw.
+        static void optimiseOverdraw(vector<GLuint> &indices, const vector<vec3> &positions, float acmrThreshold = DEFAULT_OVERDRAW_ACMR_THRESHOLD);
+
+        // The results of a software overdraw analysis
+        struct OverdrawStatistics
+        {
+            unsigned long long pixelsCovered = 0;    // Pixels covered by at least one front-facing triangle, summed over every view
+            unsigned long long pixelsShaded  = 0;    // Fragments which passed the depth test (i.e. would be shaded with early-z), summed over every view
+            float              overdraw      = 0.0f; // pixelsShaded / pixelsCovered - 1.0 means every covered pixel was shaded exactly once
+        };
+
+        // Method to measure overdraw by rasterising the mesh in software from a set of directions around it (the 6 axis directions and the 8 corners
+        // of a cube) with back-face culling and a less-than depth test. This doesn't need a GPU, so it can be used offline to compare index orders.
+        // Note: The indices may be 16-bit (GL_UNSIGNED_SHORT) or 32-bit (GL_UNSIGNED_INT), so this can be used directly on a model's face data.
+        //       If indices is null then every three consecutive vertices make a triangle (i.e. the mesh is drawn as arrays).
+        static OverdrawStatistics analyseOverdraw(const GLvoid* indices, GLenum indexType, GLuint numIndices, const GLfloat* positions, GLuint numVertices, int resolution = OVERDRAW_RESOLUTION);
+
+        // Method to simplify a mesh down to (at most) the target number of indices using the quadric error metric from Garland & Heckbert's
+        // "Surface Simplification Using Quadric Error Metrics". Returns the simplified indices, which still index the original vertex data.
+        // Note: Each vertex position accumulates the planes of the triangles around it, and we repeatedly collapse whichever edges move their vertices
+        //       the smallest distance away from those planes. Edges are collapsed into one of their existing vertices rather than a new optimal
+        //       position, so every level of detail can share one vertex buffer.
+        // Also: Vertices which share a position (e.g. along a normal seam) are simplified together, and when one is collapsed we pick the vertex at
+        //       the new position whose normal is closest to its own (pass an empty normals vector if there aren't any). Mesh borders are preserved.
+        //       If resultError isn't null it receives the largest distance (in model units) that any collapse moved the surface.
+        static vector<GLuint> simplify(const vector<GLuint> &indices, const vector<vec3> &positions, const vector<vec3> &normals, size_t targetIndexCount, float* resultError = nullptr);
+
+        // The most vertices and triangles we put in a meshlet.
+        // Note: 64 vertices and 124 triangles are the limits commonly recommended for mesh shaders, and 124 triangles (rather than 126) keeps a
+        //       meshlet's packed 8-bit triangle indices within a multiple of 4 bytes should we ever want to use them that way.
+        static const GLuint MAX_MESHLET_VERTICES  = 64;
+        static const GLuint MAX_MESHLET_TRIANGLES = 124;
+
+        // We never add a triangle to a meshlet if its normal is further than this (as a cosine) from the average normal of the meshlet so far
+        static constexpr float MESHLET_SPLIT_NORMAL_DOT = 0.5f;
+
+        // A meshlet is a small cluster of neighbouring triangles which is culled as a whole. Its triangles are a contiguous range of the indices.
+        // Note: The cone cutoff is the sine of the angle between the cone axis and the triangle normal furthest from it (or 1.0 if the normals
+        //       spread over more than a hemisphere, in which case there's always a triangle facing the camera so the meshlet can't be back-face culled).
+        struct Meshlet
+        {
+            GLuint firstIndex;
+            GLuint triangleCount;
+            GLuint vertexCount;
+            float  centre[3];
+            float  radius;
+            float  coneAxis[3];
+            float  coneCutoff;
+        };
+
+        // Method to split a list of triangles into meshlets and reorder the triangles so that each meshlet is a contiguous range of the indices.
+        // Note: Each meshlet is grown from the first triangle not yet in a meshlet by repeatedly adding the neighbouring triangle which adds the fewest
+        //       new vertices and faces closest to the meshlet's average normal. Seeding in the existing order keeps the meshlets roughly in the order
+        //       that the vertex cache and overdraw optimisations left the triangles in, and neighbouring triangles make good use of the cache anyway.
+        static vector<Meshlet> buildMeshlets(vector<GLuint> &indices, const vector<vec3> &positions);
+
+        // Method to recalculate the bounding sphere and normal cone of a meshlet (e.g. after its vertices have moved) from the indices it was built with
+        static void computeMeshletBounds(Meshlet &meshlet, const GLuint* indices, const vector<vec3> &positions);
+
+        // Method to find out whether all of a meshlet's triangles face away from a camera at the given position (in the meshlet's coordinate space)
+        static bool isMeshletBackFacing(const Meshlet &meshlet, const vec3 &cameraPosition);
+
+        // A crease angle of 180 degrees (or more) smooths across every edge, however sharp
+        static constexpr float NO_CREASE_ANGLE_DEGS = 180.0f;
+
+        // Meshes with fewer triangles than this have their smooth normals generated on a single thread
+        static const size_t PARALLEL_NORMALS_MIN_TRIANGLES = 32 * 1024;
+
+        // Method to generate a smooth normal for every corner of every triangle (so cornerNormals ends up the same size as indices).
+        // Each corner gets the normalised sum of the normals of the triangles around its position, weighted by both the area of each triangle and
+        // its angle at that position - so a fan of thin triangles doesn't outweigh one broad triangle covering the same angle around the vertex.
+        // Note: Triangles only share normals through shared indices, so weld positions with identical values to the same index before calling this.
+        // Also: A corner only takes in the triangles whose normals are within creaseAngleDegs of its own triangle's normal, so edges sharper than the
+        //       crease angle stay sharp. The corners around a position then can have different normals, which is why we return one per corner.
+        //       The triangle normals are worked out four at a time with SSE where it's available, and both passes are split across threads
+        //       without any two threads ever writing to the same data.
+        static void generateSmoothNormals(const vector<GLuint> &indices, const vector<vec3> &positions, vector<vec3> &cornerNormals, float creaseAngleDegs = NO_CREASE_ANGLE_DEGS);
+
+        // Methods to simulate a FIFO post-transform cache of the given size and report how well the indices use it:
+        //    ACMR (Average Cache Miss Ratio)         - vertex shader runs per triangle. 3.0 is the worst case, and ~0.5 is the best possible for a large regular grid.
+        //    ATVR (Average Transformed Vertex Ratio) - vertex shader runs per vertex. 1.0 is ideal (every vertex is transformed exactly once).
+        static float getACMR(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize = STATS_CACHE_SIZE);
+        static float getATVR(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize = STATS_CACHE_SIZE);
+
+    private:
+        // The size of the LRU cache we model while optimising, and the tuning values from Forsyth's paper
+        static const GLuint    FORSYTH_CACHE_SIZE   = 32;
+        static constexpr float CACHE_DECAY_POWER    = 1.5f;
+        static constexpr float LAST_TRIANGLE_SCORE  = 0.75f;
+        static constexpr float VALENCE_BOOST_SCALE  = 2.0f;
+        static constexpr float VALENCE_BOOST_POWER  = 0.5f;
+
+        // Method to score a vertex based on its position in our LRU cache (-1 if it's not in the cache) and the number of
+        // triangles still waiting to be drawn which use it
+        static float getVertexScore(int cachePosition, GLuint remainingTriangles);
+
+        // Method to count the number of times the vertex shader would run for the indices with a FIFO cache of the given size
+        static GLuint countCacheMisses(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize);
+
+        // Method to give each distinct vertex position an id (from 0 to numPositions - 1) - returns the id of each vertex
+        static vector<GLuint> getPositionIds(const vector<vec3> &positions, GLuint &numPositions);
+
+        // Method to get the unit normal of the triangle made by the first three indices (or zero if it has no area)
+        static vec3 getUnitTriangleNormal(const GLuint* triangle, const vector<vec3> &positions);
+
+        // Method to find the first triangle of each cluster we can split a vertex cache optimised mesh into for overdraw optimisation
+        static vector<size_t> getOverdrawClusterStarts(const vector<GLuint> &indices, GLuint numVertices, float acmrThreshold);
+};
+
+#endif // MESH_OPTIMISER_H
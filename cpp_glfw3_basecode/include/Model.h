@@ -1,31 +1,74 @@
 /***
 File          : Model.h
-Version       : 0.8
+Version       : 0.19
 Author        : Al Lansley
 Original Date : 26/08/2013
-Last Update   : 20/09/2018 - fixed some valgrind memory leaks where I was calling 'delete' instead of 'delete[]' to release data arrays in the destructor.
-Purpose: .OBJ format model loader. Handles vertices, normals, normal indices and faces, does not (at present) handle texture coordinates.
+Last Update   : 16/10/2026 - Every read-only method is const, so one model can be shared by many instances through a ModelCache.
+Purpose: .OBJ format model loader. Handles vertices, texture coordinates, normals, faces and materials.
 
          Notes:
-         - The .obj files must be set up to use triangles, not quads.
+         - Faces with more than 3 corners are split into a fan of triangles around their first corner, so polygons must be convex (as the .obj format says they are).
+
+         - Face corners may be written as v, v/vt, v//vn or v/vt/vn, and any index may be negative to count back from the latest element read so far
+           (so -1 is the last vertex, texture coordinate or normal before the face).
+
+         - Materials are read from the .mtl files named by mtllib lines (relative to the .obj file), and usemtl lines pick the material of the faces
+           which follow them. Ka, Kd, Ks, Ns, d/Tr and map_Kd are read - the texture is only stored as a filename, it's up to the caller to load it.
+           Faces before any usemtl line use material 0, which is always a default plain white material, and materials we can't find get the same values.
+
+         - The faces are sorted by material when the model loads (keeping their order within each material), so that each material's faces are a
+           single contiguous submesh - a model then draws with one material change per material, however often the .obj file switches between them.
+           Every level of detail has one submesh per material (see getSubmesh()), and the optimisations below are applied to each submesh separately.
 
          - Models may have:
             - vertices only,
-            - vertices and normals,
-            - vertices and normals and faces,
-            - vertices and normals and faces and normal indices.
+            - vertices and faces,
+            - vertices and faces plus normals and/or texture coordinates for their corners.
+
+         - When DRAWING_AS_ELEMENTS, face corners which share the same position, normal and texture coordinate are welded into a single
+           vertex. If there are no normals then smooth normals are generated first (weighted by face area and corner angle, and kept sharp across
+           edges steeper than smoothNormalCreaseAngleDegs), and corners either side of a crease become separate vertices.
+
+         - When DRAWING_AS_ELEMENTS (and optimiseVertexOrder is true), triangles are then reordered so they reuse recently transformed vertices, and the
+           vertices are renumbered in the order the triangles first use them. The ACMR/ATVR before and after are printed on load.
+           If optimiseOverdraw is also true then, before the vertices are renumbered, clusters of triangles are sorted so that the outer parts of the model
+           (which tend to hide the rest of it) are drawn first.
+
+         - When DRAWING_AS_ELEMENTS (and generateLods is true), a chain of simplified levels of detail is built with quadric error metric edge collapses.
+           Every level indexes the same vertex data, and their indices follow the full detail indices in faceData - use getLod() to get each range.
+
+         - When DRAWING_AS_ELEMENTS (and buildMeshlets is true), the full detail triangles are grouped into meshlets of up to 64 vertices and 124 triangles,
+           each with a bounding sphere and a cone around its triangle normals, and reordered so each meshlet is a contiguous range of the face data. Each frame, cullMeshlets() can then skip the meshlets which are outside
+           the view frustum or which face entirely away from the camera, and give us the ranges of indices to draw with glMultiDrawElements.
 
-         - If a model has vertices and faces (no normal data) then we calculate normals as a cross-product of the two vectors forming each triangle.
+         - Once the data arrays are set up (or loaded from the mesh cache) the model has an axis-aligned bounding box and a bounding sphere in model space,
+           which scale() and transform() keep up to date. Test them against a Frustum to skip drawing models which are out of view.
 
-         - This class keeps all the data read from the .obj file in vectors of vec3's called vertices, normals, normalIndices, texCoords, and faces.
+         - transform() bakes a matrix into the positions and normals (e.g. to combine static models into one scene model), and flips the triangles if
+           the matrix mirrors the model so they still face outwards. The vertices are transformed four at a time with SSE, split across threads. The
+           bounds, the meshlets' bounds and normal cones, and the level of detail errors are all updated to match the new vertex data.
+
+         - Every method which doesn't change the model is const, so a model loaded once can be shared (as a const Model) by everything which draws it -
+           see ModelCache. The interleaved and quantised layouts are still built on first use through a const model, so build them before sharing across threads.
+
+         - If a model has vertices and faces (no normal data) then we generate smooth normals for it in parallel, whichever way we're drawing it.
+           We also do this if only some of the faces have normals, as there's no sensible normal to give the rest.
+
+         - This class keeps all the data read from the .obj file in vectors called vertices, normals and texCoords, and a vector of WeldKeys called faceCorners
+           which holds the zero-based position, texture coordinate and normal index of each corner of each (triangulated) face.
+
+         - When drawing as elements, faceData holds GL_UNSIGNED_SHORT indices if the model has at most 65536 vertices, or GL_UNSIGNED_INT indices otherwise.
 
          - Once the data from the vectors has been transferred into the vertexData/normalData/faceData arrays then we no longer need the vectors.
 
          - There are TWO ways to load a model:
                 DRAWING_AS_ARRAYS   - Where the data arrays are the expanded versions which can contain duplicates based on the face/index data, and
-                DRAWING_AS_ELEMENTS - Where the data arrays DO NOT contain duplicates.
+                DRAWING_AS_ELEMENTS - Where the data arrays DO NOT contain duplicates, and the faceData array indexes into them.
 
          - When you load a model, you must specify whether you're DRAWING_AS_ARRAYS or DRAWING_AS_ELEMENTS so that the data arrays are populated correctly.
+
+         - After a model loads cleanly its data arrays are written to a binary <model>.<arrays|elements>.meshcache file next to it. Subsequent loads
+           memory-map that file instead of parsing the .obj, as long as the .obj file's path, size and modification time (and those of its .mtl files) haven't changed.
 ***/
 
 #ifndef MODEL_H
@@ -39,6 +82,9 @@ Purpose: .OBJ format model loader. Handles vertices, normals, normal indices and
 #include <iterator>
 #include <algorithm>
 #include <cstring>
+#include <string_view>
+#include <cstdint>
+#include <functional>
 
 #ifndef __glad_h_
     #include <glad/glad.h>
@@ -46,16 +92,22 @@ Purpose: .OBJ format model loader. Handles vertices, normals, normal indices and
 
 #include "glm/glm.hpp"
 
+#include "MappedFile.h"
+#include "MeshOptimiser.h"
+
 using std::cout;
 using std::endl;
 using std::string;
+using std::string_view;
 using std::vector;
 using std::ifstream;
 using std::istringstream;
 using std::istream_iterator;
 using std::back_inserter;
 
+using glm::vec2;
 using glm::vec3;
+using glm::uvec3;
 using glm::vec4;
 using glm::mat4;
 
@@ -69,22 +121,104 @@ class Model
         Model(DrawingMethod theDrawingMethod);
 
         // Constructor which also loads a model
+        // Note: If the model can't be loaded it's left empty - check hasVertices() before using it.
         Model(string filename, DrawingMethod theDrawingMethod);
 
-        // Copy constructor to create deep copies of model objects
-        // Note: We only deep copy the vertexData and normalData arrays, not all the vectors!
-        Model(Model &source);
+        // Models can't be copied - a model owns its data arrays through raw pointers, so a copy would either share (and double-free) them or
+        // need to deep copy every table we build when loading.
+        // Note: To draw the same mesh many times, share one copy of it through a ModelCache (which hands out a const Model) rather than copying it.
+        Model(const Model &source)            = delete;
+        Model& operator=(const Model &source) = delete;
 
         // Destructor - frees our allocated pointer memory
         ~Model();
 
+        // Whether models should be cached in (and loaded from) a binary .meshcache file alongside the source .obj file
+        inline static bool useMeshCache = true;
+
+        // Whether indexed models should have their triangles and vertices reordered for the GPU's vertex cache after loading
+        inline static bool optimiseVertexOrder = true;
+
+        // Whether indexed models should also have their triangles sorted to reduce overdraw (after the vertex cache optimisation), and how
+        // much vertex cache efficiency we're willing to give up for it (see MeshOptimiser::optimiseOverdraw)
+        inline static bool  optimiseOverdraw      = true;
+        inline static float overdrawAcmrThreshold = MeshOptimiser::DEFAULT_OVERDRAW_ACMR_THRESHOLD;
+
+        // Whether to measure overdraw in software before and after optimising a model (this is slow on large models, so it's off by default)
+        inline static bool reportOverdraw = false;
+
+        // Whether indexed models should get a chain of simplified levels of detail, and the fraction of the full model's triangles each level
+        // should aim for. Each level is simplified from the one before, so the fractions must get smaller.
+        inline static bool          generateLods      = true;
+        inline static vector<float> lodTriangleRatios = { 0.5f, 0.25f, 0.125f, 0.0625f };
+
+        // Whether indexed models should be split into meshlets which can be culled individually
+        inline static bool buildMeshlets = true;
+
+        // When a model has no normals we generate smooth ones, which are only smoothed across edges where the faces meet at less than this angle.
+        // The default of 180 degrees smooths every edge, and 0 degrees gives flat shaded faces.
+        inline static float smoothNormalCreaseAngleDegs = MeshOptimiser::NO_CREASE_ANGLE_DEGS;
+
+        // The number of meshlets that a call to cullMeshlets() drew and culled
+        struct MeshletCullResult
+        {
+            GLuint visible        = 0;
+            GLuint frustumCulled  = 0;
+            GLuint backFaceCulled = 0;
+        };
+
+        // A level of detail - a range of the face data, and the furthest (in model units) it strays from the full detail model
+        // Note: Scaling or transforming the model rescales the errors along with the vertex data, so they're always in the current model units.
+        struct LodLevel
+        {
+            GLuint firstIndex;
+            GLuint indexCount;
+            float  error;
+        };
+
+        // A material read from a .mtl material library.
+        // Note: The defaults are the plain white material phong.frag used before models had materials - faces which don't use a material get them.
+        struct Material
+        {
+            string name           = "default";
+            vec3   ambientColour  = vec3(1.0f); // Ka
+            vec3   diffuseColour  = vec3(1.0f); // Kd
+            vec3   specularColour = vec3(1.0f); // Ks
+            float  specularPower  = 64.0f;      // Ns
+            float  opacity        = 1.0f;       // d (or 1 - Tr)
+            string diffuseTextureFilename;      // map_Kd - relative to the .obj file, and empty if there's no texture
+        };
+
+        // A submesh is the range of the face data (or of the vertices, when drawing as arrays) whose faces all use one material.
+        // Note: Only the full detail submeshes have meshlets - their meshlets are the range [firstMeshlet, firstMeshlet + meshletCount).
+        struct Submesh
+        {
+            GLuint materialIndex;
+            GLuint firstIndex;
+            GLuint indexCount;
+            GLuint firstMeshlet;
+            GLuint meshletCount;
+        };
+
         // Method to load a model
+        // Note: If the file can't be opened, has no vertices, or can't be drawn the way we asked (e.g. drawing as elements without any faces) then
+        //       the model is left empty, with hasVertices() false. We don't exit, as models are often loaded on a worker thread (see ModelLoader).
         void load(string filename);
 
-        // Method to read through the model file adding all vertices, faces and normals to our
-        // vertices, faces and normals vectors.
+        // Method to load our data arrays straight from the binary mesh cache for a model file, if there's a valid one.
+        // Returns true if the cache was used, or false if the model must be parsed from its source file.
+        bool loadMeshCache(string filename);
+
+        // Method to write our data arrays to a binary mesh cache file for a model file
+        bool saveMeshCache(string filename);
+
+        // Method to read through the model file adding all vertices, texture coordinates, normals and face corners to our
+        // vertices, texCoords, normals and faceCorners vectors, along with the materials from any material libraries it uses.
         bool readModelFile(string filename);
 
+        // Method to read the materials from a .mtl material library. Returns false if the library can't be read or has lines we can't parse.
+        bool readMaterialLibrary(string filename);
+
         // Method to setup our data arrays of floats for OpenGL to work with
         void setupData();
 
@@ -96,29 +230,111 @@ class Model
         void printNormalData();
 
         // Simple checker methods to determine information about our model
-        bool hasVertices();
-        bool hasFaces();
-        bool hasNormals();
-        bool hasNormalIndices();
+        bool hasVertices() const;
+        bool hasFaces() const;
+        bool hasNormals() const;
+        bool hasNormalIndices() const;
+        bool hasTexCoords() const;
 
         // Getter methods
-        GLvoid* getVertexData();
-        GLvoid* getNormalData();
-        GLvoid* getNormalIndexData();
-        GLvoid* getFaceData();
-
-        GLuint  getVertexDataSizeBytes();
-        GLuint  getNormalDataSizeBytes();
-        GLuint  getNormalIndexDataSizeBytes();
-        GLuint  getFaceDataSizeBytes();
-
-        GLuint  getNumVertices();
-        GLuint  getNumNormals();
-        GLuint  getNumNormalIndices();
-        GLuint  getNumFaces();
-        GLuint  getFaceElementCount();
-
-        DrawingMethod getDrawingMethod();
+        // Note: The face data holds 16-bit indices if the model has few enough vertices, so check getFaceIndexType() when using it!
+        const GLvoid* getVertexData() const;
+        const GLvoid* getNormalData() const;
+        const GLvoid* getNormalIndexData() const;
+        const GLvoid* getTexCoordData() const;
+        const GLvoid* getFaceData() const;
+
+        GLuint        getVertexDataSizeBytes() const;
+        GLuint        getNormalDataSizeBytes() const;
+        GLuint        getNormalIndexDataSizeBytes() const;
+        GLuint        getTexCoordDataSizeBytes() const;
+        GLuint        getFaceDataSizeBytes() const;
+
+        GLuint        getNumVertices() const;
+        GLuint        getNumNormals() const;
+        GLuint        getNumNormalIndices() const; // Note: This is the number of faces whose corners all have normals
+        GLuint        getNumTexCoords() const;
+        GLuint        getNumFaces() const;
+        GLuint        getFaceElementCount() const; // Note: This is the number of indices in the full detail model - the face data also holds any other levels of detail
+        GLenum        getFaceIndexType() const;
+        GLuint        getFaceIndexSizeBytes() const;
+
+        DrawingMethod getDrawingMethod() const;
+        double        getParseTimeMs() const; // Note: This is how long load() spent reading the model file - it's 0 if the model came from its mesh cache
+
+        // Level of detail methods. Level 0 is always the full detail model, and each level's indices are a subrange of the face data.
+        GLuint   getLodCount() const;
+        LodLevel getLod(GLuint lodNumber) const;
+
+        // Method to pick the simplest level of detail whose error, when projected onto the screen, is no more than maxErrorPixels.
+        // Note: pixelsPerModelUnit is how many pixels one unit of the model covers at its distance from the camera (see Window::getProjectedSizePixels).
+        GLuint selectLod(float pixelsPerModelUnit, float maxErrorPixels = 1.0f) const;
+
+        // Material and submesh methods. Every level of detail has getSubmeshCount() submeshes, each with a different material, in material order.
+        // Note: A submesh can be empty at a lower level of detail if simplifying left nothing of it - skip those when drawing.
+        GLuint          getMaterialCount() const;
+        const Material& getMaterial(GLuint materialNumber) const;
+        GLuint          getSubmeshCount() const;
+        Submesh         getSubmesh(GLuint lodNumber, GLuint submeshNumber) const;
+
+        // Method to get the number of meshlets the full detail model is split into (0 if it isn't)
+        GLuint getMeshletCount() const;
+
+        // Method to cull our meshlets against the view frustum and the camera position, and fill in the counts and byte offsets of the ranges of
+        // face data to draw, e.g. with glMultiDrawElements(GL_TRIANGLES, counts.data(), getFaceIndexType(), offsets.data(), counts.size()).
+        // Note: Neighbouring visible meshlets are merged into a single range, so there are usually far fewer draws than visible meshlets.
+        MeshletCullResult cullMeshlets(const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const;
+
+        // Method to cull just the meshlets of one full detail submesh, so each material's visible ranges can be drawn with that material
+        MeshletCullResult cullMeshlets(GLuint submeshNumber, const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const;
+
+        // Bounding volume methods - the axis-aligned bounding box and bounding sphere of the model in model space
+        vec3  getBoundsMin() const;
+        vec3  getBoundsMax() const;
+        vec3  getBoundingSphereCentre() const;
+        float getBoundingSphereRadius() const;
+
+        // Method to get our bounding sphere in world space (i.e. transformed by the model matrix) as centre x/y/z and radius w, ready for Frustum::cullSpheres
+        vec4 getTransformedBoundingSphere(const mat4 &modelMatrix) const;
+
+        // Method to measure how much overdraw our data arrays cause by rasterising them in software from several directions
+        MeshOptimiser::OverdrawStatistics getOverdrawStatistics() const;
+
+        // Interleaved vertex data layout - each vertex is position x/y/z, normal x/y/z, then texture coordinate s/t.
+        // Note: 8 floats gives us a 32-byte stride, so vertices never straddle a 32-byte boundary.
+        static const GLuint INTERLEAVED_POSITION_COMPONENTS = 3;
+        static const GLuint INTERLEAVED_NORMAL_COMPONENTS   = 3;
+        static const GLuint INTERLEAVED_TEXCOORD_COMPONENTS = 2;
+        static const GLuint INTERLEAVED_FLOATS_PER_VERTEX   = INTERLEAVED_POSITION_COMPONENTS + INTERLEAVED_NORMAL_COMPONENTS + INTERLEAVED_TEXCOORD_COMPONENTS;
+        static const GLuint INTERLEAVED_STRIDE_BYTES        = INTERLEAVED_FLOATS_PER_VERTEX * sizeof(GLfloat);
+
+        // Methods to get our vertex data as a single interleaved stream rather than separate vertex and normal arrays.
+        // Note: The interleaved data is built on first use from the current vertex/normal data.
+        // Also: GpuMesh sets up the vertex array objects which read this layout (and the quantised layout below).
+        const GLvoid* getInterleavedData() const;
+        GLuint        getInterleavedDataSizeBytes() const;
+
+        // Quantised vertex data layout - the position is stored as 3 unsigned normalised shorts relative to the model's bounding box (plus a
+        // padding short to keep the normal aligned) and the normal is octahedral-encoded into 2 signed normalised shorts.
+        // Note: At 12 bytes per vertex this is half the size of separate float positions and normals, and 8/3rds smaller than the interleaved layout.
+        struct QuantisedVertex
+        {
+            GLushort position[4];
+            GLshort  normal[2];
+        };
+        static const GLuint QUANTISED_STRIDE_BYTES = sizeof(QuantisedVertex);
+
+        // Methods to get our vertex data in the quantised layout. The data is built on first use from the current vertex/normal data.
+        // Note: The shader must decode the position as (quantisedPosition * scale + offset) and the normal from its octahedral encoding - see phong.vert.
+        const GLvoid* getQuantisedData() const;
+        GLuint        getQuantisedDataSizeBytes() const;
+        vec3          getQuantisedPositionScale() const;
+        vec3          getQuantisedPositionOffset() const;
+
+        // The largest errors introduced by quantising our vertex data - the distance between any original and decoded position, and the
+        // angle in degrees between any original and decoded normal
+        float         getQuantisedPositionMaxError() const;
+        float         getQuantisedNormalMaxErrorDegs() const;
 
         // Method to scale the size of a model uniformly
         void scale(float scale);
@@ -126,26 +342,193 @@ class Model
         // Method to scale the size of a model on separate axes
         void scale(float xScale, float yScale, float zScale);
 
-        // Compare two floats to be within a threshold, or not
-        bool is_near(float v1, float v2, float threshold);
+        // Method to bake an affine transform into our vertex data. Positions are transformed by the matrix and normals by its normal matrix (the
+        // inverse transpose of its upper 3x3) and then renormalised. If the matrix mirrors the model then every triangle's winding is flipped too.
+        void transform(const mat4 &matrix);
 
-        int getSimilarVertexIndex(vec3 &in_vertex, vec3 &in_normal, float threshold);
+        // Method to transform numVertices packed x/y/z positions (and, if normals isn't null, packed x/y/z normals) in place the same way transform() does.
+        // Note: This works on any arrays, so it can also be used to bake copies of a model's vertex data into a combined scene buffer.
+        static void transformVertices(const mat4 &matrix, GLfloat* positions, GLfloat* normals, size_t numVertices);
+
+        // Models with fewer vertices than this are transformed on a single thread
+        static const size_t PARALLEL_TRANSFORM_MIN_VERTICES = 64 * 1024;
 
     private:
-        // Pointers to vectors of vec3's to store the data read from the model file
+        // Binary mesh cache identification and version - bump the version whenever the contents of the data arrays change!
+        inline static const char   MESH_CACHE_MAGIC[8]  = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' };
+        inline static const GLuint MESH_CACHE_VERSION   = 11;
+        inline static const char*  MESH_CACHE_EXTENSION = ".meshcache";
+
+        // Returns the mesh cache filename for a model file - we keep a separate cache per drawing method as their data arrays differ
+        string getMeshCacheFilename(string filename) { return filename + (drawingMethod == DRAWING_AS_ARRAYS ? ".arrays" : ".elements") + MESH_CACHE_EXTENSION; }
+
+        // Bits in a mesh cache header's optimisationFlags - the cache is only used if they match our current optimisation settings
+        static const uint32_t MESH_CACHE_VERTEX_ORDER_OPTIMISED = 1;
+        static const uint32_t MESH_CACHE_OVERDRAW_OPTIMISED     = 2;
+        static const uint32_t MESH_CACHE_MESHLETS_BUILT         = 4;
+
+        // Each data stream in a mesh cache file starts on a boundary of this many bytes
+        static const size_t MESH_CACHE_ALIGNMENT = 16;
+
+        // The header at the start of a binary mesh cache file. The data streams follow it at the given byte offsets.
+        // Note: The cache is keyed on the source file path, size and modification time - if any of those change then
+        //       the cache is stale and we re-parse the source file (and overwrite the cache). The material libraries the model
+        //       used are listed in the material data, and a hash of their paths, sizes and modification times is checked too.
+        struct MeshCacheHeader
+        {
+            char     magic[8];
+            uint32_t version;
+            uint32_t drawingMethod;
+            uint64_t sourcePathHash;
+            uint64_t sourceSizeBytes;
+            int64_t  sourceModifiedTime;
+
+            uint32_t numVertices;
+            uint32_t numNormals;
+            uint32_t numTexCoords;
+            uint32_t numFaces;
+            uint32_t faceIndexType;
+            uint32_t optimisationFlags;
+            float    overdrawAcmrThreshold;
+            float    smoothNormalCreaseAngleDegs;
+            uint32_t lodSettingsHash;
+
+            uint32_t numFaceIndices; // Across all levels of detail
+            uint32_t numLods;
+            uint32_t numMeshlets;
+            uint32_t numMaterials;
+            uint32_t numSubmeshes;           // Across all levels of detail
+            uint32_t numMaterialLibraries;
+            uint64_t materialLibrariesHash;
+            uint64_t materialDataSizeBytes;
+
+            uint64_t vertexDataOffset;
+            uint64_t normalDataOffset;
+            uint64_t texCoordDataOffset;
+            uint64_t faceDataOffset;
+            uint64_t lodDataOffset;
+            uint64_t meshletDataOffset;
+            uint64_t submeshDataOffset;
+            uint64_t materialDataOffset;
+            uint64_t fileSizeBytes;
+
+            float    boundsMin[3];
+            float    boundsMax[3];
+            float    boundingSphereCentre[3];
+            float    boundingSphereRadius;
+        };
+
+        // How each material is stored in a mesh cache file - its name and texture filename follow it, and then the next material.
+        // Note: The material data ends with the filename of each material library, each one after its length.
+        struct CachedMaterial
+        {
+            float    ambientColour[3];
+            float    diffuseColour[3];
+            float    specularColour[3];
+            float    specularPower;
+            float    opacity;
+            uint32_t nameLength;
+            uint32_t textureFilenameLength;
+        };
+
+        // The mapped mesh cache file - if our data arrays point into this then we must not delete them
+        MappedFile meshCacheFile;
+        bool       dataIsMapped = false;
+
+        // The zero-based position, normal and texture coordinate indices of a face corner - used to weld identical corners into a single vertex.
+        // Note: It's also exactly the size of a vec3, so we can use it to hash the bit pattern of a vec3 (or a vec2).
+        struct WeldKey
+        {
+            GLuint position;
+            GLuint normal;
+            GLuint texCoord;
+
+            bool operator==(const WeldKey &other) const { return position == other.position && normal == other.normal && texCoord == other.texCoord; }
+        };
+
+        struct WeldKeyHash
+        {
+            size_t operator()(const WeldKey &key) const
+            {
+                uint64_t hash = (uint64_t(key.position) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(key.normal) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(key.texCoord) * 0x165667B19E3779F9ull);
+                return static_cast<size_t>(hash ^ (hash >> 32));
+            }
+        };
+
+        // The index we give a face corner's normal or texture coordinate when it doesn't have one
+        static const GLuint MISSING_INDEX = 0xFFFFFFFF;
+
+        // Files smaller than this are parsed on a single thread, and larger files are split into chunks of at least this size
+        static const size_t PARALLEL_PARSE_MIN_CHUNK_BYTES = 1024 * 1024;
+
+        // The data parsed from one line-aligned chunk of a model file by one worker thread
+        struct ObjChunk
+        {
+            // A line we couldn't parse - the line number is relative to the start of the chunk
+            struct Warning
+            {
+                int         lineNumber;
+                const char* dataType;
+            };
+
+            // Where a chunk's data starts in the combined vectors (and how many lines came before it)
+            struct Offsets
+            {
+                size_t vertices    = 0;
+                size_t texCoords   = 0;
+                size_t normals     = 0;
+                size_t faceCorners = 0;
+                size_t lines       = 0;
+            };
+
+            // What we found when we checked the chunk's face corners against the combined vectors
+            struct CornerCounts
+            {
+                size_t invalidTriangles     = 0; // Triangles with a corner whose position doesn't exist - these are dropped
+                size_t invalidAttributes    = 0; // Corners whose normal or texture coordinate doesn't exist - these lose it
+                size_t trianglesWithNormals = 0; // Triangles whose corners all have normals
+                size_t cornersWithTexCoords = 0; // Corners which have a texture coordinate
+            };
+
+            vector<vec3>    vertices;
+            vector<vec2>    texCoords;
+            vector<vec3>    normals;
+            vector<WeldKey> faceCorners;
+            vector<size_t>  relativeIndices; // Where (corner * 3 + attribute) each negative index went in faceCorners - they count from the start of the chunk until merged
+            vector<Warning> warnings;
+
+            // The material libraries the chunk names, and where it switches material - each usemtl applies from the given triangle of the chunk onwards
+            // Note: The names point into the mapped model file, so they're only valid while readModelFile() has it open.
+            struct MaterialSwitch
+            {
+                size_t      firstTriangle;
+                string_view materialName;
+                GLuint      materialIndex; // Filled in by readModelFile() once it's read the material libraries
+            };
+            vector<string_view>    materialLibraries;
+            vector<MaterialSwitch> materialSwitches;
+
+            int             lineCount     = 0;
+            size_t          polygonsSplit = 0; // Faces with more than 3 corners, which we split into a fan of triangles
+        };
+
+        // Pointers to vectors to store the data read from the model file
         // Note: If we don't assign these to nullptr as we declare them then when attempting to load a model they aren't 0, so we try to free them in Model::initModel() which causes a segfault in Linux
-        vector<vec3> *vertices      = nullptr;
-        vector<vec3> *normals       = nullptr;
-        vector<vec3> *normalIndices = nullptr;
-        vector<vec3> *texCoords     = nullptr;
-        vector<vec3> *faces         = nullptr;
+        // Note: Every three face corners make a triangle, and a corner without a normal or texture coordinate has MISSING_INDEX for it.
+        vector<vec3>    *vertices    = nullptr;
+        vector<vec3>    *normals     = nullptr;
+        vector<vec2>    *texCoords   = nullptr;
+        vector<WeldKey> *faceCorners = nullptr;
 
         // Pointers to arrays of floats to store expanded data made up from the vertices and faces
         GLfloat *vertexData      = nullptr;
         GLfloat *normalData      = nullptr;
         GLfloat *normalIndexData = nullptr;
-        GLfloat *texCoordData    = nullptr;
-        GLuint  *faceData        = nullptr;
+        GLfloat *texCoordData    = nullptr; // Note: Two floats (s/t) per vertex
+        GLubyte *faceData        = nullptr; // Note: Holds either GLushort or GLuint indices depending on faceIndexType
+
+        // The type of the indices in faceData - GL_UNSIGNED_SHORT if every vertex can be indexed in 16-bits, otherwise GL_UNSIGNED_INT
+        GLenum faceIndexType = GL_UNSIGNED_INT;
 
         // Counters to keep track of how many vertices, normals, normal indices, texture coordinates and faces
         GLuint numVertices;
@@ -154,12 +537,116 @@ class Model
         GLuint numTexCoords;
         GLuint numFaces;
 
+        // How long the last load spent reading the model file
+        double parseTimeMs = 0.0;
+
+        // The levels of detail in our face data (empty if the model has just the one)
+        vector<LodLevel> lods;
+
+        // Our materials (material 0 is always the default), the material libraries they came from, and the submeshes of every level of detail in level order
+        vector<Material> materials;
+        vector<string>   materialLibraryFilenames;
+        vector<Submesh>  submeshes;
+
+        // Our bounding box and bounding sphere in model space
+        vec3  boundsMin            = vec3(0.0f);
+        vec3  boundsMax            = vec3(0.0f);
+        vec3  boundingSphereCentre = vec3(0.0f);
+        float boundingSphereRadius = 0.0f;
+
+        // The meshlets the full detail indices are split into (empty if they aren't)
+        vector<MeshOptimiser::Meshlet> meshlets;
+
+        // Our vertex data as a single interleaved stream (built on demand)
+        // Note: The on demand layouts are mutable so that they can be built through a const Model (e.g. one shared by a ModelCache), but that means
+        //       building them isn't thread-safe - build any layout you need before sharing a model between threads.
+        mutable vector<GLfloat> interleavedData;
+
+        // Our vertex data in the quantised layout (built on demand), how to decode it and how accurate it is
+        mutable vector<QuantisedVertex> quantisedData;
+        mutable vec3  quantisedPositionScale    = vec3(1.0f);
+        mutable vec3  quantisedPositionOffset   = vec3(0.0f);
+        mutable float quantisedPositionMaxError = 0.0f;
+        mutable float quantisedNormalMaxError   = 0.0f;
+
+        // Private helper methods to octahedral-encode a unit vector into two signed normalised shorts and decode it again.
+        // Note: An octahedral encoding projects the normal onto an octahedron and unfolds that onto a square, so it spreads the precision we have
+        //       evenly over the sphere rather than wasting it on the (always unit) length as storing x/y/z would.
+        static void encodeOctahedral(const vec3 &normal, GLshort encoded[2]);
+        static vec3 decodeOctahedral(const GLshort encoded[2]);
+
         // Whether we should populate the data arrays to draw as arrays or elements (controls whether vertex data is duplicated)
         DrawingMethod drawingMethod;
 
         // Private method to initialise or re-initialise a model
         void initModel();
 
+        // Private method to map each of a vector of values (vec2's or vec3's) to the index of the first identical value
+        template <typename T>
+        static vector<GLuint> getCanonicalIndices(const vector<T> &values);
+
+        // Private method to find out whether every face corner has a normal we can use
+        bool everyFaceHasNormals() const;
+
+        // Private method to generate a smooth normal for every face corner from the canonical index of every position
+        vector<vec3> generateSmoothNormals(const vector<GLuint> &canonicalPositions);
+
+        // Private method to find a material by name - returns MISSING_INDEX if we don't have it
+        GLuint findMaterial(string_view name);
+
+        // Private method to sort the triangles in faceCorners by material and make a full detail submesh for each material used
+        void sortFacesByMaterial(const vector<GLuint> &triangleMaterials);
+
+        // Private method to run a reordering on each full detail submesh's range of the indices separately, so that every triangle stays in its submesh
+        void forEachSubmesh(vector<GLuint> &indices, const std::function<void(vector<GLuint>&, Submesh&)> &process);
+
+        // Private method to weld face corners with identical attributes into the indexed data arrays we draw as elements
+        void weldVertices();
+
+        // Private method to reorder welded vertices and their indices for the post-transform vertex cache, reduced overdraw, meshlets and sequential vertex fetches
+        void optimiseVertexOrderForGPU(vector<GLuint> &indices, vector<WeldKey> &uniqueVertices);
+
+        // Private method to append simplified levels of detail to the full detail indices, using the positions and normals in our data arrays
+        void buildLodChain(vector<GLuint> &indices);
+
+        // Private method to split the full detail indices into meshlets, reordering the indices so each meshlet is a contiguous range of them
+        void buildMeshletTable(vector<GLuint> &indices, const vector<WeldKey> &uniqueVertices);
+
+        // Private method to work out our bounding box and bounding sphere from our vertex data
+        void calculateBounds();
+
+        // Private method to recalculate the bounds of our meshlets after the vertex data has changed
+        void updateMeshletBounds();
+
+        // Private method to reverse the winding of every triangle (e.g. after mirroring the model) so they still face the same way as their normals
+        void flipWinding();
+
+        // Private method to get the total number of indices in the face data across all levels of detail
+        GLuint getTotalFaceIndexCount() const;
+
+        // Private method to store face indices in faceData using the smallest index type that can address every vertex
+        void setFaceData(const vector<GLuint> &indices);
+
+        // Private method to free our data arrays (or unmap them if they came from a mesh cache)
+        void freeDataArrays();
+
+        // Private method to fill in the key part of a mesh cache header for a source file. Returns false if the file can't be queried.
+        bool getMeshCacheKey(string filename, MeshCacheHeader &header);
+
+        // Private method to hash the paths, sizes and modification times of the material libraries a model uses, so we can tell if any have changed
+        static uint64_t getMaterialLibrariesHash(const vector<string> &libraryFilenames);
+
+        // Private methods to pack our materials and material library filenames into a block of mesh cache data, and to unpack them again.
+        // Unpacking returns false if the data is malformed.
+        vector<char> packMaterialData();
+        static bool  unpackMaterialData(const char* data, size_t sizeBytes, GLuint numMaterials, GLuint numLibraries, vector<Material> &materialsOut, vector<string> &librariesOut);
+
+        // Private method to cull a range of our meshlets (see cullMeshlets)
+        MeshletCullResult cullMeshletRange(GLuint firstMeshlet, GLuint meshletCount, const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const;
+
+        // Private method to parse a line-aligned range of a model file into a chunk (called from worker threads)
+        static void parseObjChunk(const char* begin, const char* end, ObjChunk &chunk);
+
 }; // End of Model class
 
 #endif // MODEL_H
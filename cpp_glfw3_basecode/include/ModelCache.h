@@ -0,0 +1,143 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "glm/glm.hpp"
+
+#include "Model.h"
+#include "ModelLoader.h"
+#include "GpuMesh.h"
+
+using std::string;
+using std::vector;
+using glm::mat4;
+
+// Class to share one copy of each model (and of the GPU buffers it's uploaded into) between everything that draws it.
+//
+// Note: Asking for a model we already hold just hands back another reference to it, so a mesh drawn hundreds of times is read, parsed and uploaded
+//       once, and its vertex data and buffers exist once. Models are keyed on the canonical path of their file plus everything that changes the data
+//       we end up with - the drawing method, which layouts we upload, and Model's static load settings (vertex order and overdraw optimisation,
+//       levels of detail, meshlets and the smooth normal crease angle) - so changing a setting between loads gives you a separately loaded model.
+// Also: The shared models are const. Anything that differs between the copies we draw (where it is, which level of detail it's using and so on)
+//       belongs in an Instance instead. A model you want to change (e.g. with scale() or transform()) needs loading as a Model of its own.
+// Further: The cache holds a reference to every model it has loaded, so a model stays loaded after its last user lets it go (in case it's asked
+//          for again) until purgeUnused() or clear() is called. Only use a cache from the thread with the OpenGL context.
+class ModelCache
+{
+    public:
+        // A model shared through the cache, along with the buffers it was uploaded into and how much memory each copy of it takes
+        class SharedMesh
+        {
+            public:
+                // Getters
+                const Model&                     getModel()    const { return *model;   }
+                const ModelLoader::ModelBuffers& getBuffers()  const { return buffers;  }
+                const string&                    getFilename() const { return filename; }
+                size_t                           getCpuBytes() const { return cpuBytes; }
+                size_t                           getGpuBytes() const { return gpuBytes; }
+
+                // Method to make a GpuMesh which draws from our buffers, with a vertex array object for each layout we uploaded. The attribute
+                // locations are those of the shader it will be drawn with, so make one mesh per shader rather than one per instance.
+                // Note: The mesh shares our buffers rather than owning them, so destroy it before the cache deletes them (see purgeUnused and clear).
+                GpuMesh createGpuMesh(GLint positionLocation, GLint normalLocation, GLint texCoordLocation = -1) const;
+
+            private:
+                friend class ModelCache;
+
+                string                    filename;
+                std::unique_ptr<Model>    model;
+                ModelLoader::ModelBuffers buffers;
+                size_t                    cpuBytes = 0;
+                size_t                    gpuBytes = 0;
+        };
+
+        // A handle to a shared model. The model (and its buffers) stay valid for as long as you hold the handle, even if the cache is purged.
+        // Note: Destroying the last handle doesn't make any OpenGL calls - the buffers are deleted by purgeUnused() or clear().
+        using MeshHandle = std::shared_ptr<const SharedMesh>;
+
+        // The state of one drawn copy of a shared model
+        struct Instance
+        {
+            MeshHandle mesh;
+            mat4       modelMatrix = mat4(1.0f);
+            GLuint     lod         = 0;
+        };
+
+        // How well the cache is doing
+        // Note: The bytes saved are what every extra user of a model would have cost had it loaded (and uploaded) the model itself.
+        struct Statistics
+        {
+            size_t hits          = 0; // Calls to acquire() which were given a model we already held
+            size_t misses        = 0; // Calls to acquire() which had to load a model
+            size_t liveMeshes    = 0; // Models held by the cache
+            size_t meshUsers     = 0; // Handles to those models held outside the cache
+            size_t cpuBytesHeld  = 0; // Memory used by the models we hold
+            size_t gpuBytesHeld  = 0; // GPU memory used by the buffers of the models we hold
+            size_t cpuBytesSaved = 0; // Memory we would have used had every user loaded its own copy, less what we did use
+            size_t gpuBytesSaved = 0; // The same for GPU memory
+        };
+
+        // Constructor
+        ModelCache() = default;
+
+        // Destructor
+        // Note: This doesn't make any OpenGL calls, as the context may already be gone - call clear() first if it isn't.
+        ~ModelCache() = default;
+
+        // A cache owns buffers, so it can't be copied
+        ModelCache(const ModelCache&) = delete;
+        ModelCache& operator=(const ModelCache&) = delete;
+
+        // Method to get a shared model, loading and uploading it if we don't already hold one loaded the same way. Returns a null handle if the
+        // model can't be loaded. Loading a model this way blocks until it's uploaded, so use a ModelLoader for large models loaded mid-frame.
+        MeshHandle acquire(string filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags = ModelLoader::UPLOAD_ALL_DATA);
+
+        // Method to let go of (and delete the buffers of) every model which nothing outside the cache is using. Returns how many we let go of.
+        size_t purgeUnused();
+
+        // Method to let go of every model and delete all their buffers. Handles still held elsewhere keep their models, but their buffers are gone.
+        void clear();
+
+        // Methods to get and print out how well the cache is doing
+        Statistics getStatistics() const;
+        void printStatistics() const;
+
+    private:
+        // Everything that decides what data loading a model gives us
+        struct MeshKey
+        {
+            string               canonicalFilename;
+            Model::DrawingMethod drawingMethod;
+            GLuint               uploadFlags;
+            bool                 optimiseVertexOrder;
+            bool                 optimiseOverdraw;
+            float                overdrawAcmrThreshold;
+            bool                 generateLods;
+            vector<float>        lodTriangleRatios;
+            bool                 buildMeshlets;
+            float                smoothNormalCreaseAngleDegs;
+
+            auto operator<=>(const MeshKey&) const = default;
+        };
+
+        std::map< MeshKey, std::shared_ptr<SharedMesh> > meshes;
+        size_t hits   = 0;
+        size_t misses = 0;
+
+        // Private method to build the key for a model loaded from the given file with the current load settings
+        static MeshKey makeKey(const string &filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags);
+
+        // Private method to load a model and upload the layouts we were asked for - returns null if the model couldn't be loaded
+        static std::shared_ptr<SharedMesh> loadMesh(const string &filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags);
+};
+
+#endif // MODEL_CACHE_H
@@ -0,0 +1,162 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "Model.h"
+
+using std::string;
+using std::vector;
+
+// Class to load models in the background so that large models don't stall the window while they're parsed and set up.
+//
+// Note: Loading happens in two stages. A worker thread constructs the Model (parsing the .obj file or mapping its mesh cache, welding,
+//       optimising, building levels of detail and so on) and builds whichever vertex data layouts we want to upload. The main thread then
+//       creates the GPU buffers (with immutable storage) and copies the data into them in chunks, a limited number of bytes per frame, from
+//       update() - so even a very large model only ever costs a frame a small, predictable amount of upload time.
+// Also: OpenGL calls must come from the thread with the context, so only update() touches OpenGL. Call it once per frame from the main thread.
+class ModelLoader
+{
+    public:
+        // The stages a model goes through as it loads
+        enum LoadState { LOAD_QUEUED = 0, LOAD_PARSING, LOAD_UPLOADING, LOAD_READY, LOAD_FAILED };
+
+        // Flags for which of a model's vertex data layouts to upload to the GPU. The face data is always uploaded if the model is drawn as elements.
+        static const GLuint UPLOAD_SEPARATE_DATA    = 1; // Separate position and normal buffers (and a texture coordinate buffer if the model has them)
+        static const GLuint UPLOAD_INTERLEAVED_DATA = 2; // A single interleaved buffer (see Model::getInterleavedData)
+        static const GLuint UPLOAD_QUANTISED_DATA   = 4; // A single quantised buffer (see Model::getQuantisedData)
+        static const GLuint UPLOAD_ALL_DATA         = UPLOAD_SEPARATE_DATA | UPLOAD_INTERLEAVED_DATA | UPLOAD_QUANTISED_DATA;
+
+        // How many bytes update() uploads per call by default
+        static const size_t DEFAULT_UPLOAD_BUDGET_BYTES = 2 * 1024 * 1024;
+
+        // The GPU buffers a model was uploaded into - any layout we weren't asked to upload (or that the model has no data for) is left as 0.
+        // Note: Once a model is ready these buffers belong to whoever asked for the model, just like buffers they'd generated themselves - the easiest
+        //       thing to do with them is to hand them to a GpuMesh, which sets up the vertex array objects to draw them and deletes them when it's done.
+        struct ModelBuffers
+        {
+            GLuint vertexBufferId      = 0;
+            GLuint normalBufferId      = 0;
+            GLuint texCoordBufferId    = 0;
+            GLuint interleavedBufferId = 0;
+            GLuint quantisedBufferId   = 0;
+            GLuint indexBufferId       = 0;
+        };
+
+        // A handle to a model that's loading. The handle owns the model, so keep hold of it for as long as you use the model.
+        // Note: Dropping a handle before its model is ready cancels the load - the loader notices nobody wants the model and throws it away.
+        class LoadHandle
+        {
+            public:
+                // Destructor - frees the model
+                ~LoadHandle() { delete model; }
+
+                // Getters
+                // Note: The model and buffers are only available once the state is LOAD_READY, as until then the worker thread or update() is still filling them in.
+                LoadState           getState()            const { return state.load(std::memory_order_acquire); }
+                bool                isReady()             const { return getState() == LOAD_READY;  }
+                bool                hasFailed()           const { return getState() == LOAD_FAILED; }
+                Model*              getModel()            const { return isReady() ? model : nullptr; }
+                const ModelBuffers& getBuffers()          const { return buffers;          }
+                const string&       getFilename()         const { return filename;         }
+                double              getLoadTimeMs()       const { return loadTimeMs;       }
+                GLuint              getUploadFrameCount() const { return uploadFrameCount; }
+
+                // Method to get how far through uploading the model we are, from 0 to 1
+                float getUploadProgress() const;
+
+            private:
+                friend class ModelLoader;
+
+                // A block of data to copy into one of our buffers, and how much of it we've copied so far
+                struct UploadStream
+                {
+                    GLuint*        bufferId;
+                    const GLubyte* data;
+                    size_t         sizeBytes;
+                    size_t         uploadedBytes;
+                };
+
+                // What we were asked to load
+                string                      filename;
+                Model::DrawingMethod        drawingMethod;
+                GLuint                      uploadFlags;
+                std::function<void(Model&)> onLoaded;
+
+                // What we've loaded, and how far we've got
+                Model*                 model = nullptr;
+                std::atomic<LoadState> state { LOAD_QUEUED };
+                ModelBuffers           buffers;
+                vector<UploadStream>   uploadStreams;
+                size_t                 totalUploadBytes = 0;
+                size_t                 uploadedBytes    = 0;
+                double                 loadTimeMs       = 0.0;
+                GLuint                 uploadFrameCount = 0;
+        };
+
+        using Handle = std::shared_ptr<LoadHandle>;
+
+        // Constructor - starts the worker thread
+        ModelLoader();
+
+        // Destructor - stops the worker thread once it's finished the model it's on (if any)
+        // Note: This doesn't make any OpenGL calls, as the context may already be gone. Buffers of models that were still uploading are
+        //       left for the context to free.
+        ~ModelLoader();
+
+        // A loader owns a thread, so it can't be copied
+        ModelLoader(const ModelLoader&) = delete;
+        ModelLoader& operator=(const ModelLoader&) = delete;
+
+        // Method to queue a model to be loaded in the background. Models are loaded (and uploaded) in the order they're queued.
+        // Note: If given, onLoaded is called on the worker thread once the model is set up and before its data is uploaded - so it's the place to do
+        //       anything else slow that needs the model, such as scaling it or building a TriangleBVH over it, without stalling the main thread.
+        Handle loadAsync(string filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags = UPLOAD_ALL_DATA, std::function<void(Model&)> onLoaded = nullptr);
+
+        // Method to upload up to uploadBudgetBytes of loaded model data to the GPU (or everything that's loaded, if the budget is 0), which marks
+        // each model that finishes uploading as ready. Returns the number of bytes uploaded. Must be called from the thread with the OpenGL context.
+        size_t update(size_t uploadBudgetBytes = DEFAULT_UPLOAD_BUDGET_BYTES);
+
+        // Method to find out whether there are any models still queued, loading or uploading
+        bool isBusy();
+
+        // Method to delete the buffers a model was uploaded into and zero their ids. Must be called from the thread with the OpenGL context.
+        static void deleteBuffers(ModelBuffers &buffers);
+
+    private:
+        // The worker thread and the queue of models waiting for it
+        std::thread             workerThread;
+        std::mutex              queueMutex;
+        std::condition_variable queueCondition;
+        std::deque<Handle>      loadQueue;
+        bool                    stopping = false;
+
+        // Models the worker thread has finished with, waiting for update() to pick them up (guarded by queueMutex)
+        std::deque<Handle> loadedQueue;
+
+        // Models being uploaded - only ever touched by update() on the main thread
+        std::deque<Handle> uploadQueue;
+
+        // The number of models queued, loading or uploading
+        std::atomic<GLuint> busyCount { 0 };
+
+        // Private method run by the worker thread to load each queued model in turn
+        void workerLoop();
+
+        // Private method (called on the worker thread) to build a loaded model's vertex data layouts and list what we need to upload
+        static void prepareUploadStreams(LoadHandle &handle);
+};
+
+#endif // MODEL_LOADER_H
@@ -66,6 +66,9 @@ class Point
 
         static void setupShaderProgram();
 
+        // Method to set up the VAO which points the shader's attributes at our vertex buffer, once the shader program has finished initialising
+        static void setupVertexArray();
+
     public:
         // Default constructor
         Point();
@@ -87,12 +90,16 @@ class Point
         void setPointSize(float pointSize);
 
 
-        // Method to draw the point - just takes a combined Model/View/Projection matrix
-        // to pass to the shader as a uniform.
-        void draw(mat4 mvpMatrix);
+        // Method to draw the point.
+        // Note: Points are given in world space, and the shader reads the camera matrices from the FrameUniforms buffer written each frame.
+        void draw();
 
         // Static method to draw an array of Points - this is more efficient, but each point must the same size (i.e. the same glPointSize)
-        static void draw(Point* pointArray, int numPoints, float pointSize, mat4 mvpMatrix);
+        static void draw(Point* pointArray, int numPoints, float pointSize);
+
+        // Method to get the shader program every point draws with, e.g. to initialise it along with other programs in ShaderProgram::initialiseAll.
+        // Note: The program is created (and starts compiling) along with the first point, so this is null until then.
+        static ShaderProgram* getShaderProgram() { return pointShaderProgram; }
 
         void update();
 };
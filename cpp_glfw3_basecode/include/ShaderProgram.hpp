@@ -6,12 +6,22 @@
 #include <sstream>
 #include <map>
 #include <list>
+#include <vector>
+#include <algorithm>  // Needed to sort and search the reflected resources
+#include <tuple>      // Needed for tie
+#include <chrono>     // Needed to time how long initialising takes
+#include <cstdint>
+#include <cstdio>     // Needed for snprintf
+#include <cstring>    // Needed for memcmp and memcpy
+#include <filesystem> // Needed to create the program binary cache directory and replace cache files
 
 #ifndef __glad_h_
 	#include "glad/glad.h"
 #endif
 
 #include "Utils.hpp"
+#include "FrameUniforms.h"
+#include "glm/gtc/type_ptr.hpp" // Needed for the value_ptr() method
 
 // Save some typing
 using std::cout;
@@ -30,6 +40,67 @@ using std::pair;
 typedef pair<GLenum, GLuint> ShaderPair;
 typedef list<ShaderPair> ShaderPairList;
 
+// A handle to a uniform of GLSL type T, which holds the uniform's location so that setting it is just the glUniform* call.
+//
+// Note: Get one with ShaderProgram::getUniform<T>() when the program is set up and keep it - the name is only looked up then, so drawing with a
+//       handle does no string building, map lookups or allocation. The type is checked when we compile, so you can't set a mat4 from a vec3,
+//       and T is checked against the uniform's type in the shader when we get the handle, so you can't ask for a mat4 handle to a vec3 either.
+// Also: Like glUniform*, set() sets the uniform of whichever shader program is in use, so use() the handle's program first.
+template <typename T>
+struct Uniform
+{
+	GLint location = -1;
+
+	void set(const T &value) const;
+
+	// Whether a uniform of the given GLSL type (e.g. GL_FLOAT_MAT4) can be set through this handle
+	static bool matchesType(GLenum glslType);
+};
+
+template <> inline void Uniform<float>::set(const float &value) const { glUniform1f(location, value);                                  }
+template <> inline void Uniform<int>::set(const int &value)     const { glUniform1i(location, value);                                  }
+template <> inline void Uniform<bool>::set(const bool &value)   const { glUniform1i(location, value ? GL_TRUE : GL_FALSE);             }
+template <> inline void Uniform<vec3>::set(const vec3 &value)   const { glUniform3fv(location, 1, glm::value_ptr(value));              }
+template <> inline void Uniform<vec4>::set(const vec4 &value)   const { glUniform4fv(location, 1, glm::value_ptr(value));              }
+template <> inline void Uniform<mat3>::set(const mat3 &value)   const { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+template <> inline void Uniform<mat4>::set(const mat4 &value)   const { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+
+template <> inline bool Uniform<float>::matchesType(GLenum glslType) { return glslType == GL_FLOAT;      }
+template <> inline bool Uniform<bool>::matchesType(GLenum glslType)  { return glslType == GL_BOOL;       }
+template <> inline bool Uniform<vec3>::matchesType(GLenum glslType)  { return glslType == GL_FLOAT_VEC3; }
+template <> inline bool Uniform<vec4>::matchesType(GLenum glslType)  { return glslType == GL_FLOAT_VEC4; }
+template <> inline bool Uniform<mat3>::matchesType(GLenum glslType)  { return glslType == GL_FLOAT_MAT3; }
+template <> inline bool Uniform<mat4>::matchesType(GLenum glslType)  { return glslType == GL_FLOAT_MAT4; }
+
+// Note: Samplers are set to the texture image unit they read from with glUniform1i, so an int handle can set those too
+template <> inline bool Uniform<int>::matchesType(GLenum glslType)
+{
+	switch (glslType)
+	{
+		case GL_INT:
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// A handle to a vertex attribute, which holds the attribute's location for setting up vertex array objects.
+// Note: Get one with ShaderProgram::getAttribute() - unlike attribute(), it can't quietly hand back location 0 for a misspelt name.
+struct Attribute
+{
+	GLint location = -1;
+};
+
 class ShaderProgram
 {
 private:
@@ -52,20 +123,75 @@ private:
     // How many shaders are attached to the shader program
 	GLuint shaderCount;
 
-	// Map of attributes and their binding locations
-	map<string,int> attributeMap;
+public:
+	// The kinds of resource we find in a linked program - the order here is the order they're sorted (and printed) in
+	enum class ShaderResourceType { ATTRIBUTE, UNIFORM, UNIFORM_BLOCK, STORAGE_BLOCK, BUFFER_VARIABLE };
 
-	// Map of uniforms and their binding locations
-	map<string,int> uniformMap;
+	// An active attribute, uniform, uniform block, shader storage block or shader storage block member found in the linked program by reflect().
+	// Note: Offsets and strides are in bytes and are the ones the driver actually uses, so for a block declared layout(std140) they're its std140
+	//       layout - which is what you need to fill a buffer for the block correctly. Uniforms outside of any block have a location but no offset.
+	struct ShaderResource
+	{
+		ShaderResourceType resourceType;
+		string             name;               // Arrays are named without their trailing "[0]"
+		GLuint             resourceIndex = 0;  // The index of the resource within its program interface (what a member's blockIndex refers to)
+		GLenum             glslType      = 0;  // e.g. GL_FLOAT_MAT4 - zero for blocks
+		GLint              arraySize     = 1;
+		GLint              location      = -1; // Attributes, and uniforms outside of any block
+		GLint              blockIndex    = -1; // Uniforms and buffer variables which live in a block - the resourceIndex of that block
+		GLint              offset        = -1; // ...and where they are within it
+		GLint              arrayStride   = 0;
+		GLint              matrixStride  = 0;
+		GLint              binding       = -1; // Blocks - the buffer binding point the block reads from
+		GLint              dataSizeBytes = 0;  // Blocks - how big a buffer for the block needs to be
+	};
+
+private:
+	// Every active resource of the linked program, sorted by type and then name so we can find them with a binary search
+	std::vector<ShaderResource> resources;
 
 	// List of shader pairs - each pair has the type of shader as 'first' and the shaderId as 'second'
 	ShaderPairList shaderPairList;
 
+	// List of the shaders added to the program - each pair has the type of shader as 'first' and its source as 'second'.
+	// Note: The shaders aren't compiled until we're initialised, so that we can skip compiling them when the program binary cache has the program.
+	list< pair<GLenum, string> > shaderSourceList;
+
+	// The header at the start of each program binary cache file.
+	// Note: The source hash covers the type and source of every shader along with the OpenGL vendor, renderer and version strings, so a binary is
+	//       never handed to a different driver (or driver version) than the one that made it - and any change to a shader gives a different file.
+	struct ProgramBinaryHeader
+	{
+		char     magic[8];
+		uint32_t version;
+		uint32_t binaryFormat;
+		uint64_t sourceHash;
+		uint64_t binarySizeBytes;
+	};
+	inline static const char     PROGRAM_BINARY_MAGIC[8]  = { 'P', 'R', 'O', 'G', 'B', 'I', 'N', 0 };
+	inline static const uint32_t PROGRAM_BINARY_VERSION   = 1;
+	inline static const char*    PROGRAM_BINARY_EXTENSION = ".progbin";
+
     // Has this shader program been initialised?
 	bool initialised;
 
+	// What beginInitialise() found out or started, for finishInitialise() to pick up
+	bool                                  initialising     = false;
+	bool                                  usingCache       = false;
+	bool                                  loadedFromCache  = false;
+	uint64_t                              sourceHash       = 0;
+	std::chrono::steady_clock::time_point initialiseStartTime;
+
+	// Whether we've asked the driver to compile shaders on its own threads (which we only need to do once per context)
+	inline static bool parallelCompileRequested = false;
+
 public:
 
+	// Whether linked programs should be cached in (and loaded from) binary files in programBinaryCacheDirectory.
+	// Note: Drivers which don't support any program binary formats are detected and the cache is skipped for them.
+	inline static bool   useProgramBinaryCache       = true;
+	inline static string programBinaryCacheDirectory = "shader_cache";
+
     // Constructor
 	ShaderProgram(string name)
 	{
@@ -90,41 +216,50 @@ public:
 		glDeleteProgram(programId);
 	}
 
-	// Method to compile a shader of a given type
-	GLuint addShader(GLenum shaderType, string shaderSource)
+	// Method to get the name of a shader type (or an empty string if it's a type we don't support)
+	static string getShaderTypeString(GLenum shaderType)
 	{
-		string shaderTypeString;
 		switch (shaderType)
 		{
-			case GL_VERTEX_SHADER:
-				shaderTypeString = "GL_VERTEX_SHADER";
-				break;
-			case GL_FRAGMENT_SHADER:
-				shaderTypeString = "GL_FRAGMENT_SHADER";
-				break;
-            case GL_TESS_CONTROL_SHADER:
-				shaderTypeString = "GL_TESS_CONTROL_SHADER";
-				break;
-            case GL_TESS_EVALUATION_SHADER:
-				shaderTypeString = "GL_TESS_EVALUATION_SHADER";
-				break;
-			case GL_GEOMETRY_SHADER:
-				cout << "[ERROR] Geometry shaders are unsupported at this time." << endl;
-				Utils::getKeypressThenExit();
-				break;
-            default:
-				cout << "[ERROR] Bad shader type enum in addShader." << endl;
-				Utils::getKeypressThenExit();
-				break;
+			case GL_VERTEX_SHADER:          return "GL_VERTEX_SHADER";
+			case GL_FRAGMENT_SHADER:        return "GL_FRAGMENT_SHADER";
+			case GL_TESS_CONTROL_SHADER:    return "GL_TESS_CONTROL_SHADER";
+			case GL_TESS_EVALUATION_SHADER: return "GL_TESS_EVALUATION_SHADER";
+			default:                        return "";
+		}
+	}
+
+	// Method to add a shader of a given type to the program.
+	// Note: The shader is compiled when the program is initialised - unless the program binary cache already has the linked program, in which case
+	//       it's never compiled at all.
+	void addShader(GLenum shaderType, string shaderSource)
+	{
+		if (shaderType == GL_GEOMETRY_SHADER)
+		{
+			cout << "[ERROR] Geometry shaders are unsupported at this time." << endl;
+			Utils::getKeypressThenExit();
+		}
+		else if ( getShaderTypeString(shaderType).empty() )
+		{
+			cout << "[ERROR] Bad shader type enum in addShader." << endl;
+			Utils::getKeypressThenExit();
 		}
 
+		shaderSourceList.push_back( pair<GLenum, string>(shaderType, shaderSource) );
+		++shaderCount;
+	}
+
+	// Method to create a shader of a given type, start it compiling and add it to the list of shaders to link.
+	// Note: We don't ask whether it compiled here - asking makes us wait for the compile to finish, so we leave that until we check the link.
+	GLuint compileShader(GLenum shaderType, const string &shaderSource)
+	{
 		// Generate a shader id
 		// Note: Shader id will be non-zero if successfully created.
 		GLuint shaderId = glCreateShader(shaderType);
 		if (shaderId == 0)
 		{
 			// Get and display the shader log
-			cout << "[ERROR] Could not create shader of type " << shaderTypeString << ": " << getInfoLog(ShaderObjectType::SHADER, shaderId) << endl;
+			cout << "[ERROR] Could not create shader of type " << getShaderTypeString(shaderType) << ": " << getInfoLog(ShaderObjectType::SHADER, shaderId) << endl;
 			Utils::getKeypressThenExit();
 		}
 
@@ -140,36 +275,170 @@ public:
 		// Compile the shader
 		glCompileShader(shaderId);
 
-		// Check the compilation status and report any errors
-		GLint shaderStatus;
-		glGetShaderiv(shaderId, GL_COMPILE_STATUS, &shaderStatus);
-		if (shaderStatus == GL_FALSE)
+		// Add the map of shader-type to shader-id to the list of shader maps
+		shaderPairList.push_back( ShaderPair(shaderType, shaderId) );
+
+		// Return the shader id
+		return shaderId;
+	}
+
+	// Method to ask the driver to compile shaders and link programs on as many of its own threads as it likes, if it can (via the
+	// KHR_parallel_shader_compile or ARB_parallel_shader_compile extensions). Once asked, compiles carry on in the background until we
+	// ask how they went, and isInitialiseComplete() can tell whether a program is ready without waiting for it.
+	// Note: Most drivers compile on a few threads by default anyway, so this mostly matters for the ones that don't.
+	static bool parallelCompileSupported()
+	{
+		return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+	}
+
+	static void requestParallelCompile()
+	{
+		if (parallelCompileRequested)
 		{
-			cout << shaderTypeString << " compilation failed: " << getInfoLog(ShaderObjectType::SHADER, shaderId) << endl;
-			Utils::getKeypressThenExit();
+			return;
 		}
-		else // All good!
+		parallelCompileRequested = true;
+
+		// Note: 0xFFFFFFFF lets the driver pick how many threads to use
+		if (GLAD_GL_KHR_parallel_shader_compile)
 		{
-			if (DEBUG) { cout << "[OK] " << shaderTypeString << " shader compilation successful." << endl; }
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		}
+		else if (GLAD_GL_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		}
+	}
 
-			// Add the map of shader-type to shader-id to the list of shader maps
-			ShaderPair tempPair(shaderType, shaderId);
-			ShaderPairList::iterator it = shaderPairList.end();
-			shaderPairList.insert(it, tempPair);
+	// Method to start initialising the program without waiting for the driver: we load the linked program from the program binary cache if it's
+	// there, or otherwise start every shader compiling and the program linking. Call finishInitialise() before using the program.
+	// Note: Between the two the driver can be compiling while we get on with something else (e.g. loading textures) - and starting every
+	//       program before finishing any of them (see initialiseAll) lets a driver with several compiler threads compile them all at once.
+	void beginInitialise()
+	{
+		if (initialised || initialising)
+		{
+			return;
 		}
 
-		++shaderCount;
+		initialiseStartTime = std::chrono::steady_clock::now();
+		requestParallelCompile();
 
-        // Assuming everything went well, return the shader id
-		return shaderId;
+		// Try the program binary cache first - if the driver rejects the binary we fall back to compiling the shaders as usual
+		usingCache      = useProgramBinaryCache && programBinariesSupported();
+		sourceHash      = usingCache ? getSourceHash() : 0;
+		loadedFromCache = usingCache && loadProgramBinary(sourceHash);
+		if ( !loadedFromCache )
+		{
+			submitCompileAndLink(usingCache);
+		}
+		initialising = true;
 	}
 
-	// Method to compile/attach/link/verify the shaders.
+	// Method to find out whether finishInitialise() can run without waiting for the driver to finish compiling and linking.
+	// Note: Without a parallel shader compile extension we can't ask without waiting, so we say we're complete and let finishInitialise() wait.
+	bool isInitialiseComplete()
+	{
+		if ( initialised || !initialising || loadedFromCache || !parallelCompileSupported() )
+		{
+			return true;
+		}
+
+		GLint completionStatus = GL_TRUE;
+		glGetProgramiv(programId, GL_COMPLETION_STATUS_KHR, &completionStatus);
+		return completionStatus == GL_TRUE;
+	}
+
+	// Method to finish initialising the program - wait for (and check) the compile and link if they're still going, save the linked program to the
+	// program binary cache, then validate the program and find its attributes, uniforms and blocks.
 	// Note: Rather than returning a boolean as a success/fail status we'll just consider
 	// a failure here to be an unrecoverable error and abort on failure.
+	void finishInitialise()
+	{
+		if (initialised)
+		{
+			return;
+		}
+		beginInitialise();
+
+		if ( !loadedFromCache )
+		{
+			checkCompileAndLink();
+			if (usingCache)
+			{
+				saveProgramBinary(sourceHash);
+			}
+		}
+
+		// Validate the program
+		glValidateProgram(programId);
+
+		// Check the validation status - GL_TRUE indicates success.
+		GLint programValidatationStatus;
+		glGetProgramiv(programId, GL_VALIDATE_STATUS, &programValidatationStatus);
+		if (programValidatationStatus == GL_TRUE)
+		{
+			if (DEBUG) { cout << "[OK] Shader program validation successful." << endl; }
+		}
+		else // Get the program info log, display it, and bail
+		{
+			cout << "[ERROR] Shader program validation failed. Reason: " << getInfoLog(ShaderObjectType::PROGRAM, programId) << endl;
+			Utils::getKeypressThenExit();
+		}
+
+		// Find every active attribute, uniform and block so nothing needs registering by hand, then point any per-frame uniform block at its buffer
+		reflect();
+		bindFrameUniformsBlock();
+
+		if (DEBUG)
+		{
+			printResources();
+
+			// Note: For a program started with beginInitialise() this includes whatever else we did before finishing it
+			std::chrono::duration<double, std::milli> initialiseDuration = std::chrono::steady_clock::now() - initialiseStartTime;
+			cout << "Shader program " << (loadedFromCache ? "loaded from the program binary cache" : "compiled and linked") << " in " << initialiseDuration.count() << "ms." << endl;
+		}
+
+		// Finally, the shader program is initialised
+		initialising = false;
+		initialised  = true;
+	}
+
+	// Method to compile/attach/link/verify the shaders, or load the linked program from the program binary cache if it's there - waiting until it's done.
 	void initialise()
 	{
-	    // Attach all added shaders
+		beginInitialise();
+		finishInitialise();
+	}
+
+	// Method to initialise a batch of programs: every program is started before we wait on any of them, so a driver which compiles on several
+	// threads can compile them all at the same time (and we only wait for the slowest, rather than for each in turn).
+	// Note: Programs that have already been started (or initialised) are fine to pass in. We finish whichever programs the driver says are done
+	//       first, so validating and reflecting those overlaps the compiles still going - and only wait on a program when none of the rest are done.
+	static void initialiseAll(const std::vector<ShaderProgram*> &programs)
+	{
+		for (ShaderProgram *program : programs) { program->beginInitialise(); }
+
+		std::vector<ShaderProgram*> unfinishedPrograms(programs);
+		while ( !unfinishedPrograms.empty() )
+		{
+			auto firstComplete = std::find_if(unfinishedPrograms.begin(), unfinishedPrograms.end(), [](ShaderProgram *program) { return program->isInitialiseComplete(); });
+			auto nextProgram   = (firstComplete != unfinishedPrograms.end()) ? firstComplete : unfinishedPrograms.begin();
+			(*nextProgram)->finishInitialise();
+			unfinishedPrograms.erase(nextProgram);
+		}
+	}
+
+	// Method to start all the added shaders compiling and link them into our program, without waiting for either to finish.
+	// Note: If retrievable is true we tell the driver we'll be asking for the program binary, as some drivers only keep it around if we do.
+	void submitCompileAndLink(bool retrievable)
+	{
+		for (const pair<GLenum, string> &shaderSource : shaderSourceList)
+		{
+			compileShader(shaderSource.first, shaderSource.second);
+		}
+
+	    // Attach all compiled shaders
 	    for (ShaderPairList::iterator it = shaderPairList.begin(); it != shaderPairList.end(); ++it)
         {
             ShaderPair tempPair = *it;
@@ -179,17 +448,46 @@ public:
         }
 
 		// Link the shader program - details are placed in the program info log
+		if (retrievable)
+		{
+			glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
 		glLinkProgram(programId);
+	}
+
+	// Method to wait for our shaders to compile and the program to link, and check how they went.
+	// Note: Asking for the first status is what waits for the driver - after that the rest are ready, so checking each shader costs nothing extra.
+	void checkCompileAndLink()
+	{
+		// Check the compile status of each shader and report any errors
+		for (const ShaderPair &shaderPair : shaderPairList)
+		{
+			string shaderTypeString = getShaderTypeString(shaderPair.first);
+			GLint shaderStatus;
+			glGetShaderiv(shaderPair.second, GL_COMPILE_STATUS, &shaderStatus);
+			if (shaderStatus == GL_FALSE)
+			{
+				cout << shaderTypeString << " compilation failed: " << getInfoLog(ShaderObjectType::SHADER, shaderPair.second) << endl;
+				Utils::getKeypressThenExit();
+			}
+			else // All good!
+			{
+				if (DEBUG) { cout << "[OK] " << shaderTypeString << " shader compilation successful." << endl; }
+			}
+		}
 
 		// Once the shader program has the shaders attached and linked, the shaders are no longer required.
-		// If the linking failed, then we're going to abort anyway so we still detach the shaders.
+		// If the linking failed, then we're going to abort anyway so we still detach (and delete) the shaders.
+		// Note: Detaching doesn't stop a link that's still going, as the link works from the shaders it had when it was started.
 		for (ShaderPairList::iterator it = shaderPairList.begin(); it != shaderPairList.end(); ++it)
         {
             ShaderPair tempPair = *it;
             //GLenum shaderType = tempPair.first;
             GLuint shaderId = tempPair.second;
             glDetachShader(programId, shaderId);
+            glDeleteShader(shaderId);
         }
+        shaderPairList.clear();
 
 		// Check the link status - zero indicates success.
 		GLint programLinkSuccess;
@@ -203,38 +501,379 @@ public:
             cout << "[ERROR] Shader program link failed: " << getInfoLog(ShaderObjectType::PROGRAM, programId) << endl;
 			Utils::getKeypressThenExit();
 		}
+	}
 
-		// Validate the program
-		glValidateProgram(programId);
+	// Method to find out whether the driver can give us program binaries at all
+	static bool programBinariesSupported()
+	{
+		GLint binaryFormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+		return binaryFormatCount > 0;
+	}
 
-		// Check the validation status - GL_TRUE indicates success.
-		GLint programValidatationStatus;
-		glGetProgramiv(programId, GL_VALIDATE_STATUS, &programValidatationStatus);
-		if (programValidatationStatus == GL_TRUE)
+	// Method to get the FNV-1a hash of the OpenGL vendor, renderer and version strings and the type and source of each of our shaders
+	uint64_t getSourceHash()
+	{
+		uint64_t hash = 14695981039346656037ull;
+		auto hashBytes = [&hash](const void* data, size_t sizeBytes)
 		{
-			if (DEBUG) { cout << "[OK] Shader program validation successful." << endl; }
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t loop = 0; loop < sizeBytes; ++loop)
+			{
+				hash ^= bytes[loop];
+				hash *= 1099511628211ull;
+			}
+		};
+
+		// Note: Each string is hashed along with its terminating zero, so "ab" + "c" doesn't hash the same as "a" + "bc"
+		const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+		for (GLenum driverString : driverStrings)
+		{
+			const GLubyte* value = glGetString(driverString);
+			string valueString = value ? reinterpret_cast<const char*>(value) : "";
+			hashBytes(valueString.c_str(), valueString.size() + 1);
 		}
-		else // Get the program info log, display it, and bail
+		for (const pair<GLenum, string> &shaderSource : shaderSourceList)
 		{
-			cout << "[ERROR] Shader program validation failed. Reason: " << getInfoLog(ShaderObjectType::PROGRAM, programId) << endl;
-			Utils::getKeypressThenExit();
+			hashBytes(&shaderSource.first, sizeof(shaderSource.first));
+			hashBytes(shaderSource.second.c_str(), shaderSource.second.size() + 1);
 		}
+		return hash;
+	}
 
-		if (DEBUG)
+	// Method to get the name of the program binary cache file for a source hash
+	static string getProgramBinaryFilename(uint64_t sourceHash)
+	{
+		char hashString[17];
+		snprintf(hashString, sizeof(hashString), "%016llx", static_cast<unsigned long long>(sourceHash));
+		return programBinaryCacheDirectory + "/" + hashString + PROGRAM_BINARY_EXTENSION;
+	}
+
+	// Method to load our linked program from the program binary cache. Returns false if there's no cache file for our shaders, or if the
+	// driver won't take the binary (e.g. because it's been updated since) - in which case we delete the file, as it'll never be any use.
+	bool loadProgramBinary(uint64_t sourceHash)
+	{
+		string cacheFilename = getProgramBinaryFilename(sourceHash);
+		std::ifstream file(cacheFilename, std::ios::binary);
+		if ( !file.good() )
 		{
-			// Spit the active attributes
-			GLint activeAttributeCount;
-			glGetProgramiv(programId, GL_ACTIVE_ATTRIBUTES, &activeAttributeCount);
-			cout << "Shader program active attributes: " << activeAttributeCount << endl;
+			return false;
+		}
 
-			// Spit the active uniforms
-			GLint activeUniformCount;
-			glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &activeUniformCount);
-			cout << "Shader program active uniforms: " << activeUniformCount << endl;
+		ProgramBinaryHeader header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		bool headerValid = file.good()                                                         &&
+		                   memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) == 0 &&
+		                   header.version    == PROGRAM_BINARY_VERSION                           &&
+		                   header.sourceHash == sourceHash                                       &&
+		                   header.binarySizeBytes > 0 && header.binarySizeBytes < 0x7FFFFFFF;
+
+		std::vector<char> binary;
+		if (headerValid)
+		{
+			binary.resize(header.binarySizeBytes);
+			file.read(binary.data(), binary.size());
+			headerValid = file.good();
 		}
+		file.close();
 
-		// Finally, the shader program is initialised
-		initialised = true;
+		GLint programLinkSuccess = GL_FALSE;
+		if (headerValid)
+		{
+			glProgramBinary(programId, header.binaryFormat, binary.data(), static_cast<GLsizei>( binary.size() ));
+			glGetProgramiv(programId, GL_LINK_STATUS, &programLinkSuccess);
+		}
+
+		if (programLinkSuccess != GL_TRUE)
+		{
+			cout << "Program binary cache file " << cacheFilename << " is stale or invalid - compiling shaders." << endl;
+			std::error_code error;
+			std::filesystem::remove(cacheFilename, error);
+			return false;
+		}
+
+		if (DEBUG) { cout << "[OK] Shader program loaded from program binary cache file: " << cacheFilename << endl; }
+		return true;
+	}
+
+	// Method to save our linked program to the program binary cache.
+	// Note: We write to a temporary file and then rename it over the cache file, so another run never sees a half-written file.
+	void saveProgramBinary(uint64_t sourceHash)
+	{
+		GLint binarySizeBytes = 0;
+		glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binarySizeBytes);
+		if (binarySizeBytes <= 0)
+		{
+			return;
+		}
+
+		ProgramBinaryHeader header;
+		memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+		header.version    = PROGRAM_BINARY_VERSION;
+		header.sourceHash = sourceHash;
+
+		std::vector<char> binary(binarySizeBytes);
+		GLsizei writtenSizeBytes = 0;
+		GLenum  binaryFormat     = 0;
+		glGetProgramBinary(programId, binarySizeBytes, &writtenSizeBytes, &binaryFormat, binary.data());
+		header.binaryFormat    = binaryFormat;
+		header.binarySizeBytes = static_cast<uint64_t>(writtenSizeBytes);
+		if (writtenSizeBytes <= 0)
+		{
+			return;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(programBinaryCacheDirectory, error);
+
+		string cacheFilename = getProgramBinaryFilename(sourceHash);
+		string tempFilename  = cacheFilename + ".tmp";
+		std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), writtenSizeBytes);
+		file.close();
+
+		if ( !file.fail() )
+		{
+			std::filesystem::rename(tempFilename, cacheFilename, error);
+		}
+		if ( file.fail() || error )
+		{
+			cout << "Could not write program binary cache file: " << cacheFilename << endl;
+			std::filesystem::remove(tempFilename, error);
+			return;
+		}
+
+		if (DEBUG) { cout << "Wrote program binary cache file: " << cacheFilename << " (" << writtenSizeBytes << " bytes)" << endl; }
+	}
+
+	// Method to find every active attribute, uniform, uniform block, shader storage block and shader storage block member of the linked program
+	// Note: This uses program interface queries, which need OpenGL 4.3 (or ARB_program_interface_query) - but not a #version 430 shader.
+	void reflect()
+	{
+		resources.clear();
+		reflectInterface(GL_PROGRAM_INPUT,        ShaderResourceType::ATTRIBUTE);
+		reflectInterface(GL_UNIFORM,              ShaderResourceType::UNIFORM);
+		reflectInterface(GL_UNIFORM_BLOCK,        ShaderResourceType::UNIFORM_BLOCK);
+		reflectInterface(GL_SHADER_STORAGE_BLOCK, ShaderResourceType::STORAGE_BLOCK);
+		reflectInterface(GL_BUFFER_VARIABLE,      ShaderResourceType::BUFFER_VARIABLE);
+
+		std::sort(resources.begin(), resources.end(), [](const ShaderResource &a, const ShaderResource &b)
+		{
+			return std::tie(a.resourceType, a.name) < std::tie(b.resourceType, b.name);
+		});
+	}
+
+	// Method to point the program's FrameUniforms block (if it has one) at the binding point the per-frame uniform buffer is bound to.
+	// Note: A block whose size doesn't match FrameUniforms::Data has been declared differently to the struct we fill the buffer from, so every
+	//       matrix in it would be read from the wrong place - we treat that as an unrecoverable error just like a failed link.
+	void bindFrameUniformsBlock()
+	{
+		for (ShaderResource &resource : resources)
+		{
+			if (resource.resourceType != ShaderResourceType::UNIFORM_BLOCK || resource.name != FrameUniforms::BLOCK_NAME)
+			{
+				continue;
+			}
+
+			if (resource.dataSizeBytes != static_cast<GLint>( sizeof(FrameUniforms::Data) ))
+			{
+				cout << "[ERROR] Shader program " << shaderProgramName << " declares the " << FrameUniforms::BLOCK_NAME << " block as " << resource.dataSizeBytes
+				     << " bytes but FrameUniforms::Data is " << sizeof(FrameUniforms::Data) << " bytes - the declarations don't match." << endl;
+				Utils::getKeypressThenExit();
+			}
+
+			glUniformBlockBinding(programId, resource.resourceIndex, FrameUniforms::BINDING);
+			resource.binding = FrameUniforms::BINDING;
+		}
+	}
+
+	// Method to add every active resource of one program interface (e.g. GL_UNIFORM) to our resources
+	// Note: Each interface only has some of the properties (asking a block for its type is an error), so we ask each kind for the ones it has.
+	void reflectInterface(GLenum programInterface, ShaderResourceType resourceType)
+	{
+		GLint resourceCount = 0;
+		glGetProgramInterfaceiv(programId, programInterface, GL_ACTIVE_RESOURCES, &resourceCount);
+
+		for (GLint index = 0; index < resourceCount; ++index)
+		{
+			ShaderResource resource;
+			resource.resourceType  = resourceType;
+			resource.resourceIndex = static_cast<GLuint>(index);
+
+			GLint nameLength = 0;
+			if (resourceType == ShaderResourceType::ATTRIBUTE)
+			{
+				const GLenum properties[] = { GL_NAME_LENGTH, GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION };
+				GLint values[4];
+				glGetProgramResourceiv(programId, programInterface, index, 4, properties, 4, NULL, values);
+				nameLength         = values[0];
+				resource.glslType  = values[1];
+				resource.arraySize = values[2];
+				resource.location  = values[3];
+			}
+			else if (resourceType == ShaderResourceType::UNIFORM || resourceType == ShaderResourceType::BUFFER_VARIABLE)
+			{
+				const GLenum properties[] = { GL_NAME_LENGTH, GL_TYPE, GL_ARRAY_SIZE, GL_BLOCK_INDEX, GL_OFFSET, GL_ARRAY_STRIDE, GL_MATRIX_STRIDE };
+				GLint values[7];
+				glGetProgramResourceiv(programId, programInterface, index, 7, properties, 7, NULL, values);
+				nameLength            = values[0];
+				resource.glslType     = values[1];
+				resource.arraySize    = values[2];
+				resource.blockIndex   = values[3];
+				resource.offset       = values[4];
+				resource.arrayStride  = values[5];
+				resource.matrixStride = values[6];
+
+				// Note: Buffer variables don't have locations - they're only ever reached through their block's buffer
+				if (resourceType == ShaderResourceType::UNIFORM)
+				{
+					const GLenum locationProperty = GL_LOCATION;
+					glGetProgramResourceiv(programId, programInterface, index, 1, &locationProperty, 1, NULL, &resource.location);
+				}
+			}
+			else // Must be a uniform block or shader storage block
+			{
+				const GLenum properties[] = { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+				GLint values[3];
+				glGetProgramResourceiv(programId, programInterface, index, 3, properties, 3, NULL, values);
+				nameLength             = values[0];
+				resource.binding       = values[1];
+				resource.dataSizeBytes = values[2];
+			}
+
+			std::vector<GLchar> name(nameLength + 1, 0);
+			glGetProgramResourceName(programId, programInterface, index, nameLength + 1, NULL, name.data());
+			resource.name = name.data();
+
+			// Skip built-in inputs like gl_VertexID, and name arrays the way we'd write them in the shader
+			if (resource.name.compare(0, 3, "gl_") == 0)
+			{
+				continue;
+			}
+			if (resource.name.size() > 3 && resource.name.compare(resource.name.size() - 3, 3, "[0]") == 0)
+			{
+				resource.name.erase(resource.name.size() - 3);
+			}
+
+			resources.push_back(resource);
+		}
+	}
+
+	// Method to find an active resource of the given type by name - returns null if the linked program doesn't have one
+	const ShaderResource* findResource(ShaderResourceType resourceType, const string &name) const
+	{
+		auto found = std::lower_bound(resources.begin(), resources.end(), name, [resourceType](const ShaderResource &resource, const string &value)
+		{
+			return std::tie(resource.resourceType, resource.name) < std::tie(resourceType, value);
+		});
+		bool matched = (found != resources.end() && found->resourceType == resourceType && found->name == name);
+		return matched ? &(*found) : nullptr;
+	}
+
+	// Method to get every active resource of the linked program, sorted by type and then name
+	const std::vector<ShaderResource>& getResources() const { return resources; }
+
+	// Method to get the members of a uniform block or shader storage block in the order they're laid out in the block's buffer
+	std::vector<ShaderResource> getBlockMembers(const string &blockName) const
+	{
+		std::vector<ShaderResource> members;
+		const ShaderResource *block = findResource(ShaderResourceType::UNIFORM_BLOCK, blockName);
+		ShaderResourceType memberType = ShaderResourceType::UNIFORM;
+		if (block == nullptr)
+		{
+			block      = findResource(ShaderResourceType::STORAGE_BLOCK, blockName);
+			memberType = ShaderResourceType::BUFFER_VARIABLE;
+		}
+		if (block == nullptr)
+		{
+			return members;
+		}
+
+		for (const ShaderResource &resource : resources)
+		{
+			if (resource.resourceType == memberType && resource.blockIndex == static_cast<GLint>(block->resourceIndex))
+			{
+				members.push_back(resource);
+			}
+		}
+		std::sort(members.begin(), members.end(), [](const ShaderResource &a, const ShaderResource &b) { return a.offset < b.offset; });
+		return members;
+	}
+
+	// Method to get the name of the kind of a resource
+	static string getShaderResourceTypeString(ShaderResourceType resourceType)
+	{
+		switch (resourceType)
+		{
+			case ShaderResourceType::ATTRIBUTE:       return "attribute";
+			case ShaderResourceType::UNIFORM:         return "uniform";
+			case ShaderResourceType::UNIFORM_BLOCK:   return "uniform block";
+			case ShaderResourceType::STORAGE_BLOCK:   return "storage block";
+			case ShaderResourceType::BUFFER_VARIABLE: return "buffer variable";
+			default:                                  return "";
+		}
+	}
+
+	// Method to get the GLSL name of a type (e.g. "mat4" for GL_FLOAT_MAT4), or its enum value in hex if it's one we don't name
+	static string getGLSLTypeString(GLenum glslType)
+	{
+		switch (glslType)
+		{
+			case GL_FLOAT:             return "float";
+			case GL_FLOAT_VEC2:        return "vec2";
+			case GL_FLOAT_VEC3:        return "vec3";
+			case GL_FLOAT_VEC4:        return "vec4";
+			case GL_INT:               return "int";
+			case GL_INT_VEC2:          return "ivec2";
+			case GL_INT_VEC3:          return "ivec3";
+			case GL_INT_VEC4:          return "ivec4";
+			case GL_UNSIGNED_INT:      return "uint";
+			case GL_UNSIGNED_INT_VEC2: return "uvec2";
+			case GL_UNSIGNED_INT_VEC3: return "uvec3";
+			case GL_UNSIGNED_INT_VEC4: return "uvec4";
+			case GL_BOOL:              return "bool";
+			case GL_FLOAT_MAT2:        return "mat2";
+			case GL_FLOAT_MAT3:        return "mat3";
+			case GL_FLOAT_MAT4:        return "mat4";
+			case GL_SAMPLER_2D:        return "sampler2D";
+			case GL_SAMPLER_3D:        return "sampler3D";
+			case GL_SAMPLER_CUBE:      return "samplerCube";
+			case GL_SAMPLER_2D_SHADOW: return "sampler2DShadow";
+			case GL_SAMPLER_2D_ARRAY:  return "sampler2DArray";
+			default:
+			{
+				char typeString[11];
+				snprintf(typeString, sizeof(typeString), "0x%04X", glslType);
+				return typeString;
+			}
+		}
+	}
+
+	// Method to print out every active resource of the linked program
+	void printResources() const
+	{
+		cout << "Shader program active resources: " << resources.size() << endl;
+		for (const ShaderResource &resource : resources)
+		{
+			cout << "    " << getShaderResourceTypeString(resource.resourceType) << " ";
+			if (resource.resourceType == ShaderResourceType::UNIFORM_BLOCK || resource.resourceType == ShaderResourceType::STORAGE_BLOCK)
+			{
+				cout << resource.name << " (binding " << resource.binding << ", " << resource.dataSizeBytes << " bytes)" << endl;
+				continue;
+			}
+
+			cout << getGLSLTypeString(resource.glslType) << " " << resource.name;
+			if (resource.arraySize > 1) { cout << "[" << resource.arraySize << "]"; }
+			if (resource.location != -1) { cout << " at location " << resource.location; }
+			if (resource.blockIndex != -1)
+			{
+				cout << " in block " << resource.blockIndex << " at offset " << resource.offset;
+				if (resource.arrayStride  > 0) { cout << ", array stride "  << resource.arrayStride;  }
+				if (resource.matrixStride > 0) { cout << ", matrix stride " << resource.matrixStride; }
+			}
+			cout << endl;
+		}
 	}
 
 	// Method to load the shader source code from a file
@@ -307,60 +946,74 @@ public:
 	// Method to disable the shader - we'll also suggest this for inlining
 	inline void disable() { glUseProgram(0); }
 
-	// Method to return the bound location of a named attribute.
+	// Method to return the location of a named attribute, or -1 if the linked program has no such active attribute.
 	// Note: Be careful in the shader that you actually USE the attribute - non-used attributes can get automatically stripped!
-	GLuint attribute(const string attributeName) { return attributeMap[attributeName]; }
+	// Also: This looks the name up on every call, so anything done each frame should use a handle from getAttribute() instead.
+	GLuint attribute(const string &attributeName) const
+	{
+		const ShaderResource *resource = findResource(ShaderResourceType::ATTRIBUTE, attributeName);
+		return (resource != nullptr) ? resource->location : -1;
+	}
 
-	// Method to return the bound location of a named uniform.
+	// Method to return the location of a named uniform, or -1 if the linked program has no such active uniform (or it lives in a block).
 	// Note: Be careful in the shader that you actually USE the uniform - non-used uniforms can get automatically stripped!
-	GLuint uniform(const string uniformName) { return uniformMap[uniformName]; }
+	// Also: This looks the name up on every call, so anything done each frame should use a handle from getUniform() instead.
+	GLuint uniform(const string &uniformName) const
+	{
+		const ShaderResource *resource = findResource(ShaderResourceType::UNIFORM, uniformName);
+		return (resource != nullptr) ? resource->location : -1;
+	}
 
-	// Method to add an attribute to the shader and return the bound location
-	int bindAttribute(const string attributeName)
+	// Method to get a handle to a named attribute.
+	// Note: Asking for an attribute the linked program doesn't have is a setup error, so we bail here rather than hand back a location of -1.
+	Attribute getAttribute(const string &attributeName)
 	{
-	    // Add the attribute location value for the attributeName key
-		attributeMap[attributeName] = glGetAttribLocation( programId, attributeName.c_str() );
+		Attribute handle;
+		handle.location = bindAttribute(attributeName);
+		return handle;
+	}
 
-		// Check to ensure that the shader contains an attribute with this name
-		if (attributeMap[attributeName] == -1)
+	// Method to get a handle of GLSL type T to a named uniform.
+	// Note: As with getAttribute(), a missing uniform - or one whose type in the shader isn't T - stops us here rather than when we draw.
+	template <typename T>
+	Uniform<T> getUniform(const string &uniformName)
+	{
+		Uniform<T> handle;
+		handle.location = bindUniform(uniformName);
+
+		GLenum glslType = findResource(ShaderResourceType::UNIFORM, uniformName)->glslType;
+		if ( !Uniform<T>::matchesType(glslType) )
 		{
-			cout << "Could not add attribute: " << attributeName << " - location returned -1!" << endl;
+			cout << "[ERROR] Uniform " << uniformName << " in shader program " << shaderProgramName << " is a " << getGLSLTypeString(glslType) << " - the handle asked for can't set it." << endl;
 			Utils::getKeypressThenExit();
 		}
-		else // Valid attribute location? Inform user if we're in debug mode.
-		{
-		    if (DEBUG)
-            {
-                cout << "Attribute: " << attributeName << " bound to location: " << attributeMap[attributeName] << endl;
-            }
-		}
-
-        // Return the attribute location
-		return attributeMap[attributeName];
+		return handle;
 	}
 
-	// Method to add a uniform to the shader and return the bound location
-	int bindUniform(const string uniformName)
+	// Method to check that the linked program has a named attribute and return its location.
+	// Note: Every active attribute is found when we're initialised, so there's no need to call this before using one - it's just a check.
+	int bindAttribute(const string &attributeName)
 	{
-	    // Add the uniform location value for the uniformName key
-		uniformMap[uniformName] = glGetUniformLocation( programId, uniformName.c_str() );
-
-		// Check to ensure that the shader contains a uniform with this name
-		if (uniformMap[uniformName] == -1)
+		const ShaderResource *resource = findResource(ShaderResourceType::ATTRIBUTE, attributeName);
+		if (resource == nullptr)
 		{
-			cout << "Could not add uniform: " << uniformName << " - location returned -1!" << endl;
+			cout << "[ERROR] Shader program " << shaderProgramName << " has no active attribute: " << attributeName << (initialised ? "" : " (it hasn't been initialised)") << endl;
 			Utils::getKeypressThenExit();
 		}
-		else // Valid uniform location? Inform user if we're in debug mode.
+		return (resource != nullptr) ? resource->location : -1;
+	}
+
+	// Method to check that the linked program has a named uniform outside of any block and return its location.
+	// Note: Every active uniform is found when we're initialised, so there's no need to call this before using one - it's just a check.
+	int bindUniform(const string &uniformName)
+	{
+		const ShaderResource *resource = findResource(ShaderResourceType::UNIFORM, uniformName);
+		if (resource == nullptr || resource->location == -1)
 		{
-		    if (DEBUG)
-            {
-                cout << "Uniform: " << uniformName << " bound to location: " << uniformMap[uniformName] << endl;
-            }
+			cout << "[ERROR] Shader program " << shaderProgramName << " has no active uniform: " << uniformName << (initialised ? "" : " (it hasn't been initialised)") << endl;
+			Utils::getKeypressThenExit();
 		}
-
-        // Return the uniform location
-		return uniformMap[uniformName];
+		return (resource != nullptr) ? resource->location : -1;
 	}
 
 	GLuint getProgramID() { return programId; }
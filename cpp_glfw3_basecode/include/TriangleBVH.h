@@ -0,0 +1,125 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include <vector>
+#include <atomic>
+#include <limits>
+
+#ifndef __glad_h_
+    #include <glad/glad.h>
+#endif
+
+#include "glm/glm.hpp"
+
+#include "Model.h"
+
+using std::vector;
+using glm::vec3;
+
+// Class to build a bounding volume hierarchy (BVH) over a mesh's triangles so that we can quickly find which triangle a ray or line segment
+// hits first (e.g. for mouse picking), or which point on the mesh is closest to a given point.
+//
+// Note: The tree is built with the surface area heuristic (SAH) - at each node we try splitting the triangles into two groups at a number of
+//       positions along the longest axis, and pick the split which minimises the expected cost of tracing a random ray through the children.
+// Also: The nodes are stored in a single flat array with each node's two children next to each other, and each leaf's triangles are copied into
+//       a contiguous block in leaf order - so a query walks through memory rather than chasing pointers and indices around the original mesh.
+//       All queries are in the mesh's own (model) space, so transform rays into model space with the inverse model matrix before using them.
+class TriangleBVH
+{
+    public:
+        // The result of a ray or segment query
+        struct RayHit
+        {
+            float  distance = std::numeric_limits<float>::infinity(); // Distance along the ray (in units of the ray direction's length)
+            GLuint triangle = 0;                                      // The triangle's number in the mesh (i.e. its first index / 3)
+            float  u        = 0.0f;                                   // Barycentric coordinates of the hit - the hit point is
+            float  v        = 0.0f;                                   // v0 * (1 - u - v) + v1 * u + v2 * v
+            vec3   position = vec3(0.0f);                             // Where the ray hit the triangle
+            vec3   normal   = vec3(0.0f);                             // The triangle's unit face normal
+        };
+
+        // The result of a closest point query
+        struct ClosestPoint
+        {
+            float  distance = std::numeric_limits<float>::infinity(); // Distance from the query point to the closest point
+            GLuint triangle = 0;                                      // The triangle the closest point is on
+            vec3   position = vec3(0.0f);                             // The closest point itself
+        };
+
+        // Constructors
+        TriangleBVH() = default;
+        explicit TriangleBVH(const Model &model);
+
+        // Method to build the BVH over a mesh. If indices is null then every three consecutive vertices make a triangle (i.e. the mesh is drawn
+        // as arrays), otherwise the indices may be GL_UNSIGNED_SHORT or GL_UNSIGNED_INT - so this can be used directly on a model's face data.
+        // Note: Nodes with more than PARALLEL_BUILD_MIN_TRIANGLES triangles build one of their children on another thread - but only in the top
+        //       few levels of the tree, so we never have more threads building than we have cores.
+        void build(const GLfloat* positions, GLuint numVertices, const GLvoid* indices, GLenum indexType, GLuint numIndices);
+
+        // Method to build the BVH over the full detail triangles of a model
+        void build(const Model &model);
+
+        // Method to find the first triangle hit by a ray within maxDistance of its origin. Returns true if a triangle was hit.
+        // Note: Triangles are hit from either side, as a picked triangle may be facing away from the camera if back-face culling is off.
+        bool intersectRay(const vec3 &origin, const vec3 &direction, RayHit &hit, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Method to find the first triangle hit by the line segment from start to end. The hit distance is then a fraction (0 to 1) of the way along it.
+        bool intersectSegment(const vec3 &start, const vec3 &end, RayHit &hit) const;
+
+        // Method to find the closest point on the mesh to a point, as long as it's within maxDistance. Returns true if such a point was found.
+        bool findClosestPoint(const vec3 &point, ClosestPoint &result, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Getters
+        GLuint getNumNodes()     const { return static_cast<GLuint>( nodes.size() ); }
+        GLuint getNumTriangles() const { return static_cast<GLuint>( triangles.size() ); }
+        GLuint getDepth()        const { return depth; }
+        bool   isEmpty()         const { return nodes.empty(); }
+
+        // The number of candidate split positions we try along each node's longest axis, the most triangles we'll put in a leaf, and
+        // how large a node must be before we build its children in parallel
+        static const int    SAH_BIN_COUNT                = 16;
+        static const GLuint MAX_LEAF_TRIANGLES           = 4;
+        static const GLuint PARALLEL_BUILD_MIN_TRIANGLES = 64 * 1024;
+
+    private:
+        // A node is 32 bytes, so two sibling nodes fill a 64-byte cache line.
+        // Note: For a leaf (triangleCount > 0) leftFirst is the first of its triangles. For an interior node it's the index of the left child,
+        //       and the right child follows it.
+        struct Node
+        {
+            float  boundsMin[3];
+            GLuint leftFirst;
+            float  boundsMax[3];
+            GLuint triangleCount;
+        };
+
+        // A triangle copied out of the mesh in leaf order, along with its number in the original mesh
+        struct Triangle
+        {
+            vec3   vertex[3];
+            GLuint meshTriangle;
+        };
+
+        // The bounds and centroid of a triangle, used while building
+        struct BuildTriangle
+        {
+            vec3   boundsMin;
+            vec3   boundsMax;
+            vec3   centroid;
+            GLuint meshTriangle;
+        };
+
+        vector<Node>     nodes;
+        vector<Triangle> triangles;
+        GLuint           depth = 0;
+
+        // How many levels from the root may still hand a child to another thread while building - each level doubles the number of threads
+        GLuint parallelBuildLevels = 0;
+
+        // Private method to build the subtree at a node from a range of the build triangles, returning the depth of the subtree.
+        // Note: Child nodes are allocated from nodesUsed so that subtrees can be built on different threads at the same time.
+        // Also: Nodes at the maximum depth (level) are always leaves, so queries never need more than a fixed size stack.
+        GLuint buildNode(GLuint nodeIndex, vector<BuildTriangle> &buildTriangles, GLuint first, GLuint count, std::atomic<GLuint> &nodesUsed, GLuint level = 0);
+};
+
+#endif // TRIANGLE_BVH_H
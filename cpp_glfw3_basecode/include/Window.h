@@ -18,6 +18,7 @@
 #include "backends/imgui_impl_opengl3.h"
 
 #include "Camera.h"
+#include "FrameUniforms.h"
 #include "../demo_scenes/DemoSceneGlobals.h"
 #include "Utils.hpp"
 
@@ -93,6 +94,7 @@ public:
     static GLFWwindow* getGlfwWindow();
     static void displayWindowProperties(GLFWwindow* window);
     static GLsizei getWindowWidth()      { return windowWidth;          }
+    static GLsizei getWindowHeight()     { return windowHeight;         }
     static bool IsRightMouseButtonDown() { return rightMouseButtonDown; }
     
     // Callbacks
@@ -104,6 +106,7 @@ public:
     static void handleMouseWheelScroll(GLFWwindow* window, double xOffset, double yOffset);
 
     // Camera related methods
+    // Note: moveCamera also writes the frame's camera matrices into the FrameUniforms buffer, so call it once per frame before drawing.
     static Camera* getCamera() { return camera; }
     static void moveCamera(double deltaTimeSecs);
     static void setCameraLocation(vec3 location);
@@ -115,6 +118,14 @@ public:
     static mat4 getViewProjectionMatrix();
     static mat4 getOrthoProjectionMatrix();
 
+    // Method to get how many pixels high something of the given size appears at the given distance from the camera with our projection matrix.
+    // Note: This is what we use to turn an error in world units (e.g. a model's level of detail error) into an error in pixels.
+    static float getProjectedSizePixels(float worldSize, float distance);
+
+    // Method to get the world space ray through a pixel of the window, e.g. for mouse picking. The pixel coordinates are measured from the
+    // top-left of the window (as GLFW gives us the cursor position), and the ray starts on the near clip plane with a unit length direction.
+    static void getPickRay(double pixelX, double pixelY, vec3 &rayOrigin, vec3 &rayDirection);
+
     // FPS-tracking related methods
     static void setFrameStartTime(double timeSecs) { frameStartTimeSecs = timeSecs; }
     static double getDeltaTime()                   { return deltaTime;              }
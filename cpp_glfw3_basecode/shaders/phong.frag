@@ -5,6 +5,12 @@ smooth in vec3 directionToLightEye; // Direction to light in eye space
 
 out vec4 fragColour;             // Outgoing fragment colour
 
+// Material colours (see Model::Material). The defaults are a plain white material.
+uniform vec3  ambientMaterialColour  = vec3(1.0);
+uniform vec3  diffuseMaterialColour  = vec3(1.0);
+uniform vec3  specularMaterialColour = vec3(1.0);
+uniform float specularPower          = 64.0;
+
 void main()
 {
     // Light colours
@@ -12,12 +18,6 @@ void main()
     vec3 diffuseLightColour = vec3(0.9, 0.5, 0.5);
     vec3 specularLightColour = vec3(1.0, 1.0, 1.0);
 
-    // Material colours
-    vec3 ambientMaterialColour  = vec3(1.0);
-    vec3 diffuseMaterialColour  = vec3(1.0);
-    vec3 specularMaterialColour = vec3(1.0);
-    float specularPower = 64.0f;
-
 	// Add ambient contribution
 	fragColour = vec4(ambientLightColour * ambientMaterialColour, 1.0);
 
@@ -37,8 +37,8 @@ void main()
         // If the diffuse light is more than zero then (and only then) calculate specular contribution (pow function is expensive!)
         if (diffuseIntensity > 0.0)
         {
-            float specularPower = pow(specularIntensity, specularPower);
-            fragColour.rgb += specularLightColour * specularMaterialColour * specularPower;
+            float specularFactor = pow(specularIntensity, specularPower);
+            fragColour.rgb += specularLightColour * specularMaterialColour * specularFactor;
         }
     }
 }
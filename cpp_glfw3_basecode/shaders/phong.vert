@@ -1,6 +1,8 @@
 #version 430 core
 
 // --- Incoming per-vertex data ---
+// Note: If the model uses the quantised vertex layout then the position is normalised to [0..1] across the model's bounding box and the
+//       normal is octahedral-encoded into x/y (see Model::getQuantisedData).
 in vec3 vertexPosition;
 in vec3 vertexNormal;
 
@@ -8,11 +10,25 @@ in vec3 vertexNormal;
 smooth out vec3 eyeNormal;        // Vertex normal in eye space
 smooth out vec3 directionToLightEye; // Direction to light in eye space
 
-uniform mat4 projectionMatrix;  // Eye->Screen (i.e. rasterisation)
-uniform mat4 viewMatrix;        // World->Eye
+// Camera matrices, written once per frame into a uniform buffer shared by every shader (see FrameUniforms.h)
+layout(std140) uniform FrameUniforms
+{
+    mat4  viewMatrix;            // World->Eye
+    mat4  projectionMatrix;      // Eye->Screen (i.e. rasterisation)
+    mat4  viewProjectionMatrix;
+    mat4  orthoProjectionMatrix;
+    vec3  cameraPosition;
+    float time;
+};
+
 uniform mat4 modelMatrix;       // Model->World
 uniform mat3 normalMatrix;      // Normal matrix. Note: The normal matrix is just a 3x3 as that's all that's req'd.
 
+// Quantised vertex decoding. The defaults leave unquantised (float) vertex data untouched.
+uniform vec3 positionDecodeScale  = vec3(1.0); // Model::getQuantisedPositionScale()
+uniform vec3 positionDecodeOffset = vec3(0.0); // Model::getQuantisedPositionOffset()
+uniform bool octahedralNormals    = false;     // Whether vertexNormal.xy holds an octahedral-encoded normal
+
 //uniform float time;
 
 /*
@@ -33,20 +49,36 @@ float gold_noise(in vec2 coordinate, in float seed){
 }
 */
 
+// Function to decode an octahedral-encoded normal. This must match Model::decodeOctahedral!
+vec3 decodeOctahedralNormal(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    // Unfold the lower half of the octahedron
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
+    // Decode our vertex data (this does nothing for unquantised data)
+    vec3 position = vertexPosition * positionDecodeScale + positionDecodeOffset;
+    vec3 normal   = octahedralNormals ? decodeOctahedralNormal(vertexNormal.xy) : vertexNormal;
+
     // Calculate the vertex normal in eye space
-    eyeNormal = normalize(normalMatrix * vertexNormal);
+    eyeNormal = normalize(normalMatrix * normal);
 
 	// Get vertex position in eye coordinates
-	vec4 eyePosition4 = viewMatrix * modelMatrix * vec4(vertexPosition, 1.0);
+	vec4 eyePosition4 = viewMatrix * modelMatrix * vec4(position, 1.0);
 	vec3 eyePosition3 = eyePosition4.xyz / eyePosition4.z; // Normalise
 
 	vec3 lightPosition = vec3(0.0, 0.0, 1000.0);
 	directionToLightEye = normalize(lightPosition - eyePosition3);
 
 	// Project our geometry. Note: Matrix multiplication is not commutative so the order of multiplication matters!
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertexPosition, 1.0);
+	gl_Position = viewProjectionMatrix * modelMatrix * vec4(position, 1.0);
 
 	//float temp = vertexLocation.x + (gold_noise(vertexPosition.xy, time) * (sin(time / 2.0f) * 20.0f) );
 
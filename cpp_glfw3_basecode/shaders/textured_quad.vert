@@ -5,8 +5,19 @@ in vec2 texCoords;
 
 out vec2 interpolatedTexCoords;
 
+// Camera matrices, written once per frame into a uniform buffer shared by every shader (see FrameUniforms.h).
+// Note: The quad is drawn over the top of the scene in window coordinates, so it only uses the orthographic projection.
+layout(std140) uniform FrameUniforms
+{
+    mat4  viewMatrix;
+    mat4  projectionMatrix;
+    mat4  viewProjectionMatrix;
+    mat4  orthoProjectionMatrix;
+    vec3  cameraPosition;
+    float time;
+};
+
 uniform mat4 modelMatrix;
-uniform mat4 projectionMatrix;
 
 void main()
 {
@@ -14,5 +25,5 @@ void main()
     interpolatedTexCoords = texCoords;
 
 	// Project our geometry
-    gl_Position = projectionMatrix * modelMatrix * vec4(position.xyz, 1.0);
+    gl_Position = orthoProjectionMatrix * modelMatrix * vec4(position.xyz, 1.0);
 }
@@ -0,0 +1,35 @@
+#ifndef __glad_h_
+	#include "glad/glad.h"
+#endif
+
+#include "FrameUniforms.h"
+
+// Static declarations
+GLuint              FrameUniforms::bufferId = 0;
+FrameUniforms::Data FrameUniforms::frameData;
+
+// Method to write this frame's data into the uniform buffer and bind it to BINDING
+// Note: The buffer only ever holds the one Data struct, so it has immutable storage which we update (rather than reallocate) each frame.
+// Also: We bind the buffer every time rather than just once so that anything else which binds a uniform buffer to BINDING can't break us.
+void FrameUniforms::update(const Data &data)
+{
+	if (bufferId == 0)
+	{
+		glCreateBuffers(1, &bufferId);
+		glNamedBufferStorage(bufferId, sizeof(Data), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	}
+
+	frameData = data;
+	glNamedBufferSubData(bufferId, 0, sizeof(Data), &frameData);
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, bufferId);
+}
+
+// Method to delete the uniform buffer
+void FrameUniforms::release()
+{
+	if (bufferId != 0)
+	{
+		glDeleteBuffers(1, &bufferId);
+		bufferId = 0;
+	}
+}
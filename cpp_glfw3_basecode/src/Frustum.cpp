@@ -0,0 +1,208 @@
+#include "Frustum.h"
+
+#include <cmath> // Needed for abs
+
+// Use SSE for the batch tests where it's available - it's part of the baseline for every x86-64 compiler
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define FRUSTUM_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
+// Constructor which also extracts the frustum planes
+Frustum::Frustum(const mat4 &viewProjectionMatrix)
+{
+	update(viewProjectionMatrix);
+}
+
+// Method to extract the frustum planes from a combined projection * view matrix.
+// Note: A point p is inside the frustum if -w <= x, y, z <= w in clip space, where clip space (x, y, z, w) is the matrix rows dotted with p.
+//       So, for example, x >= -w gives us the left plane as (row 3 + row 0), and x <= w gives us the right plane as (row 3 - row 0).
+void Frustum::update(const mat4 &viewProjectionMatrix)
+{
+	// GLM matrices are column-major, so we have to pick out the rows ourselves
+	vec4 row[4];
+	for (int loop = 0; loop < 4; ++loop)
+	{
+		row[loop] = vec4(viewProjectionMatrix[0][loop], viewProjectionMatrix[1][loop], viewProjectionMatrix[2][loop], viewProjectionMatrix[3][loop]);
+	}
+
+	planes[LEFT_PLANE]   = row[3] + row[0];
+	planes[RIGHT_PLANE]  = row[3] - row[0];
+	planes[BOTTOM_PLANE] = row[3] + row[1];
+	planes[TOP_PLANE]    = row[3] - row[1];
+	planes[NEAR_PLANE]   = row[3] + row[2];
+	planes[FAR_PLANE]    = row[3] - row[2];
+
+	// Normalise the planes so we can compare distances from them against radii
+	for (vec4 &plane : planes)
+	{
+		float length = glm::length( vec3(plane) );
+		if (length > 0.0f)
+		{
+			plane /= length;
+		}
+	}
+
+	resetCounts();
+}
+
+// Method to test a bounding sphere against the frustum - it's culled if it's entirely behind any one plane
+bool Frustum::isSphereVisible(const vec3 &centre, float radius)
+{
+	for (const vec4 &plane : planes)
+	{
+		if (glm::dot(vec3(plane), centre) + plane.w < -radius)
+		{
+			++culledCount;
+			return false;
+		}
+	}
+	++visibleCount;
+	return true;
+}
+
+// Method to test an axis-aligned bounding box against the frustum.
+// Note: We treat the box as a centre and half-size - the box is entirely behind a plane if its centre is further behind it than the
+//       "radius" of the box in the direction of the plane normal, which is the half-size dotted with the absolute plane normal.
+bool Frustum::isAABBVisible(const vec3 &boundsMin, const vec3 &boundsMax)
+{
+	vec3 centre   = (boundsMin + boundsMax) * 0.5f;
+	vec3 halfSize = (boundsMax - boundsMin) * 0.5f;
+	for (const vec4 &plane : planes)
+	{
+		if (glm::dot(vec3(plane), centre) + plane.w < -glm::dot(glm::abs( vec3(plane) ), halfSize))
+		{
+			++culledCount;
+			return false;
+		}
+	}
+	++visibleCount;
+	return true;
+}
+
+// Method to test a batch of bounding spheres against the frustum
+size_t Frustum::cullSpheres(const vec4* spheres, size_t count, GLubyte* visible)
+{
+	size_t loop = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	// Test four spheres at a time. We transpose each group of four spheres so we have their x, y, z and radius in separate registers,
+	// and then each plane test is just three multiply-adds and a compare for all four spheres.
+	for (; loop + 4 <= count; loop += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres[loop].x);
+		__m128 y = _mm_loadu_ps(&spheres[loop + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[loop + 2].x);
+		__m128 r = _mm_loadu_ps(&spheres[loop + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+
+		__m128 outside = _mm_setzero_ps();
+		for (const vec4 &plane : planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+			                             _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+		for (int sphere = 0; sphere < 4; ++sphere)
+		{
+			visible[loop + sphere] = ((outsideMask >> sphere) & 1) ? 0 : 1;
+		}
+	}
+#endif
+
+	// Test any spheres left over one at a time
+	for (; loop < count; ++loop)
+	{
+		visible[loop] = 1;
+		for (const vec4 &plane : planes)
+		{
+			if (glm::dot(vec3(plane), vec3(spheres[loop])) + plane.w < -spheres[loop].w)
+			{
+				visible[loop] = 0;
+				break;
+			}
+		}
+	}
+
+	size_t numVisible = 0;
+	for (loop = 0; loop < count; ++loop)
+	{
+		numVisible += visible[loop];
+	}
+	visibleCount += numVisible;
+	culledCount  += count - numVisible;
+	return numVisible;
+}
+
+// Method to test a batch of axis-aligned bounding boxes against the frustum
+size_t Frustum::cullAABBs(const vec3* boundsMin, const vec3* boundsMax, size_t count, GLubyte* visible)
+{
+	size_t loop = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	// Test four boxes at a time, as centres and half-sizes with each axis in its own register (see isAABBVisible)
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; loop + 4 <= count; loop += 4)
+	{
+		const vec3* mins = &boundsMin[loop];
+		const vec3* maxs = &boundsMax[loop];
+		__m128 minX = _mm_setr_ps(mins[0].x, mins[1].x, mins[2].x, mins[3].x);
+		__m128 minY = _mm_setr_ps(mins[0].y, mins[1].y, mins[2].y, mins[3].y);
+		__m128 minZ = _mm_setr_ps(mins[0].z, mins[1].z, mins[2].z, mins[3].z);
+		__m128 maxX = _mm_setr_ps(maxs[0].x, maxs[1].x, maxs[2].x, maxs[3].x);
+		__m128 maxY = _mm_setr_ps(maxs[0].y, maxs[1].y, maxs[2].y, maxs[3].y);
+		__m128 maxZ = _mm_setr_ps(maxs[0].z, maxs[1].z, maxs[2].z, maxs[3].z);
+
+		__m128 centreX   = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+		__m128 centreY   = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+		__m128 centreZ   = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+		__m128 halfSizeX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+		__m128 halfSizeY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+		__m128 halfSizeZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+		__m128 outside = _mm_setzero_ps();
+		for (const vec4 &plane : planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centreX, _mm_set1_ps(plane.x)), _mm_mul_ps(centreY, _mm_set1_ps(plane.y))),
+			                             _mm_add_ps(_mm_mul_ps(centreZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			__m128 radius   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(halfSizeX, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(halfSizeY, _mm_set1_ps(std::abs(plane.y)))),
+			                             _mm_mul_ps(halfSizeZ, _mm_set1_ps(std::abs(plane.z))));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+		for (int box = 0; box < 4; ++box)
+		{
+			visible[loop + box] = ((outsideMask >> box) & 1) ? 0 : 1;
+		}
+	}
+#endif
+
+	// Test any boxes left over one at a time
+	for (; loop < count; ++loop)
+	{
+		vec3 centre   = (boundsMin[loop] + boundsMax[loop]) * 0.5f;
+		vec3 halfSize = (boundsMax[loop] - boundsMin[loop]) * 0.5f;
+		visible[loop] = 1;
+		for (const vec4 &plane : planes)
+		{
+			if (glm::dot(vec3(plane), centre) + plane.w < -glm::dot(glm::abs( vec3(plane) ), halfSize))
+			{
+				visible[loop] = 0;
+				break;
+			}
+		}
+	}
+
+	size_t numVisible = 0;
+	for (loop = 0; loop < count; ++loop)
+	{
+		numVisible += visible[loop];
+	}
+	visibleCount += numVisible;
+	culledCount  += count - numVisible;
+	return numVisible;
+}
@@ -0,0 +1,270 @@
+#include "GpuMesh.h"
+
+#include <algorithm> // Needed for min
+#include <cstddef>   // Needed for offsetof
+#include <utility>
+
+// Static helper function to point an attribute of a vertex array object at a vertex buffer binding point and enable it (if the shader uses it)
+static void setupAttribute(GLuint vaoId, GLint location, GLuint bindingIndex, GLint components, GLenum type, GLboolean normalised, GLuint offset)
+{
+	if (location == -1)
+	{
+		return;
+	}
+
+	// Args: vertex array object, attribute location, num components, component data type, normalised?, offset within each vertex
+	glVertexArrayAttribFormat(vaoId, location, components, type, normalised, offset);
+	glVertexArrayAttribBinding(vaoId, location, bindingIndex);
+	glEnableVertexArrayAttrib(vaoId, location);
+}
+
+// Constructor which uploads the layouts given by uploadFlags from a model into new buffers
+GpuMesh::GpuMesh(const Model &model, GLuint uploadFlags, GLint positionLocation, GLint normalLocation, GLint texCoordLocation)
+{
+	copyDrawingDetails(model);
+
+	if (uploadFlags & ModelLoader::UPLOAD_SEPARATE_DATA)
+	{
+		buffers.vertexBufferId   = createStaticBuffer(model.getVertexData(),   model.getVertexDataSizeBytes());
+		buffers.normalBufferId   = createStaticBuffer(model.getNormalData(),   model.getNormalDataSizeBytes());
+		buffers.texCoordBufferId = createStaticBuffer(model.getTexCoordData(), model.getTexCoordDataSizeBytes());
+	}
+	if (uploadFlags & ModelLoader::UPLOAD_INTERLEAVED_DATA)
+	{
+		buffers.interleavedBufferId = createStaticBuffer(model.getInterleavedData(), model.getInterleavedDataSizeBytes());
+	}
+	if (uploadFlags & ModelLoader::UPLOAD_QUANTISED_DATA)
+	{
+		buffers.quantisedBufferId = createStaticBuffer(model.getQuantisedData(), model.getQuantisedDataSizeBytes());
+	}
+	if (drawingMethod == Model::DRAWING_AS_ELEMENTS)
+	{
+		buffers.indexBufferId = createStaticBuffer(model.getFaceData(), model.getFaceDataSizeBytes());
+	}
+
+	createVertexArrays(positionLocation, normalLocation, texCoordLocation);
+}
+
+// Constructor which draws from buffers a model has already been uploaded into, taking ownership of them unless we're asked to share them
+GpuMesh::GpuMesh(const Model &model, const ModelLoader::ModelBuffers &modelBuffers, GLint positionLocation, GLint normalLocation, GLint texCoordLocation,
+                 BufferOwnership ownership)
+{
+	copyDrawingDetails(model);
+	buffers         = modelBuffers;
+	bufferOwnership = ownership;
+	createVertexArrays(positionLocation, normalLocation, texCoordLocation);
+}
+
+// Destructor - deletes our vertex array objects, and our buffers if we own them
+GpuMesh::~GpuMesh()
+{
+	release();
+}
+
+// Move constructor - takes ownership of the source mesh's GL objects
+GpuMesh::GpuMesh(GpuMesh &&source) noexcept
+{
+	*this = std::move(source);
+}
+
+// Move assignment operator - frees our GL objects and takes ownership of the source mesh's
+GpuMesh& GpuMesh::operator=(GpuMesh &&source) noexcept
+{
+	if (this != &source)
+	{
+		release();
+
+		buffers            = source.buffers;
+		bufferOwnership    = source.bufferOwnership;
+		drawingMethod      = source.drawingMethod;
+		faceIndexType      = source.faceIndexType;
+		faceIndexSizeBytes = source.faceIndexSizeBytes;
+		numVertices        = source.numVertices;
+		lods               = std::move(source.lods);
+		submeshes          = std::move(source.submeshes);
+		submeshCount       = source.submeshCount;
+		for (int layout = 0; layout < VERTEX_LAYOUT_COUNT; ++layout)
+		{
+			vaoIds[layout]        = source.vaoIds[layout];
+			source.vaoIds[layout] = 0;
+		}
+		source.buffers = ModelLoader::ModelBuffers();
+	}
+	return *this;
+}
+
+// Method to create a buffer holding the given data with immutable storage the CPU can't access
+// Note: Passing no flags to glNamedBufferStorage means the buffer can't be mapped or updated with glBufferSubData - it can only be filled here.
+GLuint GpuMesh::createStaticBuffer(const GLvoid* data, size_t sizeBytes)
+{
+	if (data == nullptr || sizeBytes == 0)
+	{
+		return 0;
+	}
+
+	GLuint bufferId;
+	glCreateBuffers(1, &bufferId);
+	glNamedBufferStorage(bufferId, sizeBytes, data, 0);
+	return bufferId;
+}
+
+// Private method to copy what we need to draw from the model
+void GpuMesh::copyDrawingDetails(const Model &model)
+{
+	drawingMethod      = model.getDrawingMethod();
+	faceIndexType      = model.getFaceIndexType();
+	faceIndexSizeBytes = model.getFaceIndexSizeBytes();
+	numVertices        = model.getNumVertices();
+	submeshCount       = model.getSubmeshCount();
+
+	for (GLuint lodNumber = 0; lodNumber < model.getLodCount(); ++lodNumber)
+	{
+		lods.push_back( model.getLod(lodNumber) );
+		for (GLuint submeshNumber = 0; submeshNumber < submeshCount; ++submeshNumber)
+		{
+			submeshes.push_back( model.getSubmesh(lodNumber, submeshNumber) );
+		}
+	}
+}
+
+// Private method to create a vertex array object for each layout we have the buffers for.
+// Note: Each buffer is attached to a binding point of the vertex array object along with its stride, and each attribute reads from a binding point
+//       at an offset within each vertex - so the interleaved and quantised layouts read all their attributes from a single binding point.
+void GpuMesh::createVertexArrays(GLint positionLocation, GLint normalLocation, GLint texCoordLocation)
+{
+	const GLuint POSITION_BINDING = 0;
+	const GLuint NORMAL_BINDING   = 1;
+	const GLuint TEXCOORD_BINDING = 2;
+
+	if (buffers.vertexBufferId != 0)
+	{
+		GLuint vaoId;
+		glCreateVertexArrays(1, &vaoId);
+		glVertexArrayVertexBuffer(vaoId, POSITION_BINDING, buffers.vertexBufferId, 0, 3 * sizeof(GLfloat));
+		setupAttribute(vaoId, positionLocation, POSITION_BINDING, 3, GL_FLOAT, GL_FALSE, 0);
+
+		if (buffers.normalBufferId != 0)
+		{
+			glVertexArrayVertexBuffer(vaoId, NORMAL_BINDING, buffers.normalBufferId, 0, 3 * sizeof(GLfloat));
+			setupAttribute(vaoId, normalLocation, NORMAL_BINDING, 3, GL_FLOAT, GL_FALSE, 0);
+		}
+		if (buffers.texCoordBufferId != 0)
+		{
+			glVertexArrayVertexBuffer(vaoId, TEXCOORD_BINDING, buffers.texCoordBufferId, 0, 2 * sizeof(GLfloat));
+			setupAttribute(vaoId, texCoordLocation, TEXCOORD_BINDING, 2, GL_FLOAT, GL_FALSE, 0);
+		}
+		vaoIds[SEPARATE_VERTEX_DATA] = vaoId;
+	}
+
+	if (buffers.interleavedBufferId != 0)
+	{
+		const GLuint normalOffset   = Model::INTERLEAVED_POSITION_COMPONENTS * sizeof(GLfloat);
+		const GLuint texCoordOffset = normalOffset + Model::INTERLEAVED_NORMAL_COMPONENTS * sizeof(GLfloat);
+
+		GLuint vaoId;
+		glCreateVertexArrays(1, &vaoId);
+		glVertexArrayVertexBuffer(vaoId, POSITION_BINDING, buffers.interleavedBufferId, 0, Model::INTERLEAVED_STRIDE_BYTES);
+		setupAttribute(vaoId, positionLocation, POSITION_BINDING, Model::INTERLEAVED_POSITION_COMPONENTS, GL_FLOAT, GL_FALSE, 0);
+		setupAttribute(vaoId, normalLocation,   POSITION_BINDING, Model::INTERLEAVED_NORMAL_COMPONENTS,   GL_FLOAT, GL_FALSE, normalOffset);
+		setupAttribute(vaoId, texCoordLocation, POSITION_BINDING, Model::INTERLEAVED_TEXCOORD_COMPONENTS, GL_FLOAT, GL_FALSE, texCoordOffset);
+		vaoIds[INTERLEAVED_VERTEX_DATA] = vaoId;
+	}
+
+	// Note: Normalised attributes arrive in the shader as floats in the range [0..1] (unsigned) or [-1..1] (signed)
+	if (buffers.quantisedBufferId != 0)
+	{
+		GLuint vaoId;
+		glCreateVertexArrays(1, &vaoId);
+		glVertexArrayVertexBuffer(vaoId, POSITION_BINDING, buffers.quantisedBufferId, 0, Model::QUANTISED_STRIDE_BYTES);
+		setupAttribute(vaoId, positionLocation, POSITION_BINDING, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(Model::QuantisedVertex, position));
+		setupAttribute(vaoId, normalLocation,   POSITION_BINDING, 2, GL_SHORT,          GL_TRUE, offsetof(Model::QuantisedVertex, normal));
+		vaoIds[QUANTISED_VERTEX_DATA] = vaoId;
+	}
+
+	// All of our vertex array objects share the same index buffer
+	if (buffers.indexBufferId != 0)
+	{
+		for (GLuint vaoId : vaoIds)
+		{
+			if (vaoId != 0)
+			{
+				glVertexArrayElementBuffer(vaoId, buffers.indexBufferId);
+			}
+		}
+	}
+}
+
+// Private method to delete our vertex array objects and (if we own them) our buffers
+// Note: Shared buffers are just forgotten - whoever made them deletes them once every mesh using them is gone.
+void GpuMesh::release()
+{
+	for (GLuint &vaoId : vaoIds)
+	{
+		if (vaoId != 0)
+		{
+			glDeleteVertexArrays(1, &vaoId);
+			vaoId = 0;
+		}
+	}
+
+	if (bufferOwnership == OWN_BUFFERS)
+	{
+		ModelLoader::deleteBuffers(buffers);
+	}
+	buffers = ModelLoader::ModelBuffers();
+}
+
+// Method to find out whether we have the data to draw from a layout
+bool GpuMesh::hasLayout(VertexLayout layout) const { return vaoIds[layout] != 0; }
+
+// Method to bind the vertex array object of a layout
+void GpuMesh::bind(VertexLayout layout) const { glBindVertexArray(vaoIds[layout]); }
+
+// Method to draw a level of detail of the whole mesh from a layout with a single draw call
+void GpuMesh::draw(VertexLayout layout, GLuint lodNumber) const
+{
+	bind(layout);
+	if (drawingMethod == Model::DRAWING_AS_ELEMENTS)
+	{
+		const Model::LodLevel &lod = lods[ std::min<size_t>(lodNumber, lods.size() - 1) ];
+		glDrawElements(GL_TRIANGLES, lod.indexCount, faceIndexType, (GLvoid*)(size_t(lod.firstIndex) * faceIndexSizeBytes));
+	}
+	else
+	{
+		glDrawArrays(GL_TRIANGLES, 0, numVertices);
+	}
+}
+
+// Method to draw one submesh of a level of detail
+// Note: When drawing as arrays each submesh is a range of the vertices rather than the indices
+void GpuMesh::drawSubmesh(GLuint lodNumber, GLuint submeshNumber) const
+{
+	if (submeshNumber >= submeshCount)
+	{
+		return;
+	}
+
+	if (drawingMethod == Model::DRAWING_AS_ELEMENTS)
+	{
+		lodNumber = std::min<GLuint>( lodNumber, getLodCount() - 1 );
+		const Model::Submesh &submesh = submeshes[lodNumber * submeshCount + submeshNumber];
+		if (submesh.indexCount > 0)
+		{
+			glDrawElements(GL_TRIANGLES, submesh.indexCount, faceIndexType, (GLvoid*)(size_t(submesh.firstIndex) * faceIndexSizeBytes));
+		}
+	}
+	else
+	{
+		const Model::Submesh &submesh = submeshes[submeshNumber];
+		glDrawArrays(GL_TRIANGLES, submesh.firstIndex, submesh.indexCount);
+	}
+}
+
+// Method to draw a set of ranges of the face data in one call
+void GpuMesh::drawRanges(const vector<GLsizei> &counts, const vector<const GLvoid*> &offsets) const
+{
+	if (drawingMethod == Model::DRAWING_AS_ELEMENTS && !counts.empty())
+	{
+		glMultiDrawElements(GL_TRIANGLES, counts.data(), faceIndexType, offsets.data(), static_cast<GLsizei>( counts.size() ));
+	}
+}
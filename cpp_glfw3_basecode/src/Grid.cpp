@@ -17,11 +17,19 @@ const char *Grid::vertexShaderSource = R"(
 
 in vec4 vertexPosition; // Incoming vertex attribute
 
-uniform mat4 mvpMatrix; // Combined Model/View/Projection matrix
+layout(std140) uniform FrameUniforms // Written once per frame - see FrameUniforms.h
+{
+    mat4  viewMatrix;
+    mat4  projectionMatrix;
+    mat4  viewProjectionMatrix;
+    mat4  orthoProjectionMatrix;
+    vec3  cameraPosition;
+    float time;
+};
 
 void main(void)
 {
-    gl_Position = mvpMatrix * vertexPosition; // Project our geometry
+    gl_Position = viewProjectionMatrix * vertexPosition; // Project our geometry (the grid is already in world space)
 }
 )";
 
@@ -60,15 +68,9 @@ Grid::Grid(const float width, const float depth, const float height, const int n
         Grid::gridShaderProgram = new ShaderProgram("Grid Shader Program");
         Grid::gridShaderProgram->addShader(GL_VERTEX_SHADER,   Grid::vertexShaderSource);
         Grid::gridShaderProgram->addShader(GL_FRAGMENT_SHADER, Grid::fragmentShaderSource);
-        Grid::gridShaderProgram->initialise();
-
-        // ----- Grid shader attributes and uniforms -----
 
-        // Add the shader attributes
-        Grid::gridShaderProgram->bindAttribute("vertexPosition");
-
-        // Add the shader uniforms
-        Grid::gridShaderProgram->bindUniform("mvpMatrix");
+        // Note: We only start the program compiling here - it's finished off when we first need the attribute location (or by initialiseAll)
+        Grid::gridShaderProgram->beginInitialise();
     }
 
     // Increment our count of gridInstances so we can keep track of how many we have
@@ -129,25 +131,35 @@ Grid::Grid(const float width, const float depth, const float height, const int n
         zLoc += zStep;
     }
 
-    // ----- Set up our Vertex Array Object (VAO) to hold the shader attributes -----
-    // Note: The grid VAO cannot be static because we may have multiple grids of various sizes.
+    // ----- Location Vertex Buffer Object (VBO) -----
+
+    // Generate an id for the locationBuffer and bind to it
+    glGenBuffers(1, &gridVertexBufferId);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVertexBufferId);
+
+    // Place the location data into the VBO
+    GLint gridArraySizeBytes = numVerts * VERTEX_COMPONENTS * sizeof(float);
+    glBufferData(GL_ARRAY_BUFFER, gridArraySizeBytes, gridVertexArray, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Note: The Vertex Array Object (VAO) is set up when we're first drawn, by which time the shader program should have finished compiling
+}
+
+// Method to set up our Vertex Array Object (VAO) to hold the shader attributes
+// Note: The grid VAO cannot be static because we may have multiple grids of various sizes.
+void Grid::setupVertexArray()
+{
+    gridShaderProgram->finishInitialise();
 
     // Get an Id for the Vertex Array Object (VAO) and bind to it
     glGenVertexArrays(1, &gridVaoId);
     glBindVertexArray(gridVaoId);
 
-        // ----- Location Vertex Buffer Object (VBO) -----
-
-        // Generate an id for the locationBuffer and bind to it
-        glGenBuffers(1, &gridVertexBufferId);
+        // Bind to our vertex buffer...
         glBindBuffer(GL_ARRAY_BUFFER, gridVertexBufferId);
 
-        // Place the location data into the VBO...
-        GLint gridArraySizeBytes = numVerts * VERTEX_COMPONENTS * sizeof(float);
-        glBufferData(GL_ARRAY_BUFFER, gridArraySizeBytes, gridVertexArray, GL_STATIC_DRAW);
-
         // ...and specify the data format.
-        glVertexAttribPointer(gridShaderProgram->attribute("vertexLocation"),  // Vertex location attribute index
+        glVertexAttribPointer(gridShaderProgram->attribute("vertexPosition"),  // Vertex location attribute index
                                                            VERTEX_COMPONENTS,  // Number of normal components per vertex
                                                                     GL_FLOAT,  // Data type
                                                                        false,  // Normalised?
@@ -157,7 +169,7 @@ Grid::Grid(const float width, const float depth, const float height, const int n
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         // Enable the vertex attribute at this location
-        glEnableVertexAttribArray(gridShaderProgram->attribute("vertexLocation"));
+        glEnableVertexAttribArray(gridShaderProgram->attribute("vertexPosition"));
 
     // Unbind our Vertex Array object - all the buffer and attribute settings above will be associated with our VAO!
     glBindVertexArray(0);
@@ -173,19 +185,20 @@ Grid::~Grid()
     if (gridInstances == 0) { delete gridShaderProgram; }
 }
 
-// Method to draw the grid - takes a combined Model/View/Projection matrix
-// to pass to the shader as a uniform.
-void Grid::draw(glm::mat4 mvpMatrix)
+// Method to draw the grid
+void Grid::draw()
 {
+    if (gridVaoId == 0)
+    {
+        setupVertexArray();
+    }
+
     // Specify we're using our shader program
     gridShaderProgram->use();
 
         // Bind to our vertex array object
         glBindVertexArray(gridVaoId);
 
-            // Provide the projection matrix uniform
-            glUniformMatrix4fv(gridShaderProgram->uniform("mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvpMatrix) );
-
             // Draw the grid as lines
             glDrawArrays(GL_LINES, 0, numVerts * VERTEX_COMPONENTS);
 
@@ -23,12 +23,20 @@ in vec4 vertexColour;   // Incoming vertex attribute
 
 out vec4 fragColour;
 
-uniform mat4 mvpMatrix; // Combined Model/View/Projection matrix
+layout(std140) uniform FrameUniforms // Written once per frame - see FrameUniforms.h
+{
+    mat4  viewMatrix;
+    mat4  projectionMatrix;
+    mat4  viewProjectionMatrix;
+    mat4  orthoProjectionMatrix;
+    vec3  cameraPosition;
+    float time;
+};
 
 void main(void)
 {
     fragColour = vertexColour;
-    gl_Position = mvpMatrix * vec4(vertexLocation, 1.0); // Project our geometry
+    gl_Position = viewProjectionMatrix * vec4(vertexLocation, 1.0); // Project our geometry (the line is already in world space)
 }
 )";
 
@@ -55,28 +63,27 @@ void Line::setupShaderProgram()
     Line::lineShaderProgram = new ShaderProgram("Line Shader");
     Line::lineShaderProgram->addShader(GL_VERTEX_SHADER,   Line::vertexShaderSource);
     Line::lineShaderProgram->addShader(GL_FRAGMENT_SHADER, Line::fragmentShaderSource);
-    Line::lineShaderProgram->initialise();
 
-    // ----- line shader attributes and uniforms -----
+    // Note: We only start the program compiling here - it's finished off when we first draw (or by initialiseAll)
+    Line::lineShaderProgram->beginInitialise();
 
-    // Add the shader attributes
-    Line::lineShaderProgram->bindAttribute("vertexLocation");
-    Line::lineShaderProgram->bindAttribute("vertexColour");
+    // ----- Location Vertex Buffer Object (VBO) -----
 
-    // Add the shader uniforms
-    Line::lineShaderProgram->bindUniform("mvpMatrix");
+    // Generate an id for the locationBuffer
+    // Note: The line data goes into it when we draw
+    glGenBuffers(1, &lineVertexBufferId);
+}
 
-    // ----- Set up our Vertex Array Object (VAO) to hold the shader attributes -----
-    // Note: The line VAO cannot be static because we may have multiple lines of various sizes.
+// Method to set up our Vertex Array Object (VAO) to hold the shader attributes
+void Line::setupVertexArray()
+{
+    Line::lineShaderProgram->finishInitialise();
 
     // Get an Id for the Vertex Array Object (VAO) and bind to it
     glGenVertexArrays(1, &lineVaoId);
     glBindVertexArray(Line::lineVaoId);
 
-        // ----- Location Vertex Buffer Object (VBO) -----
-
-        // Generate an id for the locationBuffer and bind to it
-        glGenBuffers(1, &lineVertexBufferId);
+        // Bind to our vertex buffer
         glBindBuffer(GL_ARRAY_BUFFER, Line::lineVertexBufferId);
 
         // Specify the attribute lineer for the vertex location
@@ -144,6 +151,11 @@ Line::~Line()
     {
         delete[] lineDataArray;
         delete lineShaderProgram;
+
+        // Note: The next line gets a new shader program, so it needs a new VAO too
+        glDeleteVertexArrays(1, &lineVaoId);
+        glDeleteBuffers(1, &lineVertexBufferId);
+        lineVaoId = 0;
     }
 }
 
@@ -179,10 +191,14 @@ void Line::setColour(float r, float g, float b, float a)
 
 void Line::setlineWidth(float width) { lineWidth = width; }
 
-// Method to draw the line - takes a combined Model/View/Projection matrix
-// to pass to the shader as a uniform.
-void Line::draw(mat4 mvpMatrix)
+// Method to draw the line
+void Line::draw()
 {
+    if (Line::lineVaoId == 0)
+    {
+        setupVertexArray();
+    }
+
     // Specify we're using our shader program
     Line::lineShaderProgram->use();
 
@@ -210,9 +226,6 @@ void Line::draw(mat4 mvpMatrix)
             // ...and push it to the graphics card
             glBufferData(GL_ARRAY_BUFFER, Line::BUFFER_SIZE_BYTES, Line::lineDataArray, GL_STATIC_DRAW);
 
-            // Provide the projection matrix uniform
-            glUniformMatrix4fv(Line::lineShaderProgram->uniform("mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvpMatrix) );
-
             // Save all line related attributes
             //glPushAttrib(GL_LINE_BIT);  ---------------------------------------------------------------------------------------------------- FIX THIS! GL_LINE_BIT not declared anywhere? WTF?
 
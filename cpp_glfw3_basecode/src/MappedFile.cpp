@@ -0,0 +1,158 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// Constructor which also maps a file
+MappedFile::MappedFile(const string& filename)
+{
+	open(filename);
+}
+
+// Destructor
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// Move constructor - takes ownership of the source mapping
+MappedFile::MappedFile(MappedFile&& source) noexcept
+{
+	*this = std::move(source);
+}
+
+// Move assignment - releases any mapping we already have and takes ownership of the source mapping
+MappedFile& MappedFile::operator=(MappedFile&& source) noexcept
+{
+	if (this != &source)
+	{
+		close();
+
+		mappedData    = source.mappedData;
+		mappedSize    = source.mappedSize;
+		fileHandle    = source.fileHandle;
+		mappingHandle = source.mappingHandle;
+		opened        = source.opened;
+
+		source.mappedData    = nullptr;
+		source.mappedSize    = 0;
+		source.fileHandle    = nullptr;
+		source.mappingHandle = nullptr;
+		source.opened        = false;
+	}
+	return *this;
+}
+
+// Method to map a file into memory
+bool MappedFile::open(const string& filename)
+{
+	// Release any existing mapping first
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// Nothing to map? Then we're open, but empty
+	fileHandle = file;
+	opened     = true;
+	if (fileSize.QuadPart == 0)
+	{
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	mappingHandle = mapping;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (view == NULL)
+	{
+		close();
+		return false;
+	}
+
+	mappedData = static_cast<char*>(view);
+	mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		return false;
+	}
+
+	struct stat fileStats;
+	if (fstat(fd, &fileStats) == -1)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// Nothing to map? Then we're open, but empty
+	opened = true;
+	if (fileStats.st_size == 0)
+	{
+		::close(fd);
+		return true;
+	}
+
+	// Note: The mapping keeps its own reference to the file, so we can close the descriptor straight away
+	void* view = mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (view == MAP_FAILED)
+	{
+		opened = false;
+		return false;
+	}
+
+	mappedData = static_cast<char*>(view);
+	mappedSize = static_cast<size_t>(fileStats.st_size);
+
+	// We'll typically walk the file from start to finish, so ask the kernel to read ahead aggressively
+	madvise(view, mappedSize, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+// Method to unmap the file and release all handles
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (mappedData    != nullptr) { UnmapViewOfFile(mappedData);                      }
+	if (mappingHandle != nullptr) { CloseHandle(static_cast<HANDLE>(mappingHandle)); }
+	if (fileHandle    != nullptr) { CloseHandle(static_cast<HANDLE>(fileHandle));    }
+#else
+	if (mappedData != nullptr) { munmap(mappedData, mappedSize); }
+#endif
+
+	mappedData    = nullptr;
+	mappedSize    = 0;
+	fileHandle    = nullptr;
+	mappingHandle = nullptr;
+	opened        = false;
+}
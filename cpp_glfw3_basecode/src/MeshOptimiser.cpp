@@ -0,0 +1,1461 @@
+#include "MeshOptimiser.h"
+
+#include <cmath>         // Needed for pow
+#include <utility>       // Needed for swap
+#include <algorithm>     // Needed for stable_sort, min and max
+#include <limits>        // Needed for numeric_limits
+#include <iostream>
+#include <cstring>       // Needed for memcpy
+#include <unordered_map> // Needed to find vertices which share a position and edges on the border of a mesh
+#include <thread>        // Needed to generate smooth normals in parallel
+#include <memory>        // Needed for unique_ptr
+
+// Use SSE to work out triangle normals four at a time where it's available - it's part of the baseline for every x86-64 compiler
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define MESH_OPTIMISER_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
+using std::cout;
+using std::endl;
+
+// Private method to score a vertex for the vertex cache optimiser.
+// Note: Vertices used by the most recent triangle get a fixed score (so we don't favour a strip-like order which would
+//       reuse only two of them), and the score of older cached vertices decays the further back in the cache they are.
+//       Vertices with few remaining triangles get a boost so that we finish off lone triangles rather than leaving them
+//       stranded until the end where they'd cost us a cache miss each.
+float MeshOptimiser::getVertexScore(int cachePosition, GLuint remainingTriangles)
+{
+	// No triangles left which use this vertex? Then it's of no use to us at all.
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	// The scores only depend on small integers, so we work them out once rather than calling pow for every vertex we re-score
+	static const int VALENCE_TABLE_SIZE = 32;
+	struct ScoreTables
+	{
+		float cache[FORSYTH_CACHE_SIZE];
+		float valence[VALENCE_TABLE_SIZE];
+
+		ScoreTables()
+		{
+			const float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+			for (GLuint loop = 0; loop < FORSYTH_CACHE_SIZE; ++loop)
+			{
+				cache[loop] = (loop < 3) ? LAST_TRIANGLE_SCORE : std::pow(1.0f - (loop - 3) * scaler, CACHE_DECAY_POWER);
+			}
+			for (int loop = 1; loop < VALENCE_TABLE_SIZE; ++loop)
+			{
+				valence[loop] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(loop), -VALENCE_BOOST_POWER);
+			}
+			valence[0] = 0.0f;
+		}
+	};
+	static const ScoreTables tables;
+
+	float score = (cachePosition >= 0) ? tables.cache[cachePosition] : 0.0f;
+	score += (remainingTriangles < VALENCE_TABLE_SIZE) ? tables.valence[remainingTriangles] : VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+	return score;
+}
+
+// Method to reorder triangles for post-transform vertex cache reuse
+void MeshOptimiser::optimiseVertexCache(vector<GLuint> &indices, GLuint numVertices)
+{
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0 || numVertices == 0)
+	{
+		return;
+	}
+
+	// Count the triangles which use each vertex...
+	vector<GLuint> remainingTriangles(numVertices, 0);
+	for (GLuint index : indices)
+	{
+		++remainingTriangles[index];
+	}
+
+	// ...and build a list of those triangles for each vertex, where vertex n's triangles start at triangleListStart[n]
+	vector<GLuint> triangleListStart(numVertices + 1, 0);
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		triangleListStart[loop + 1] = triangleListStart[loop] + remainingTriangles[loop];
+	}
+	vector<GLuint> triangleLists(indices.size());
+	vector<GLuint> fillCount(numVertices, 0);
+	for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint vertex = indices[triangle * 3 + corner];
+			triangleLists[ triangleListStart[vertex] + fillCount[vertex]++ ] = static_cast<GLuint>(triangle);
+		}
+	}
+
+	// Initial scores - nothing is in the cache yet
+	vector<int>   cachePosition(numVertices, -1);
+	vector<float> vertexScore(numVertices);
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		vertexScore[loop] = getVertexScore(-1, remainingTriangles[loop]);
+	}
+
+	vector<float> triangleScore(numTriangles);
+	for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		triangleScore[triangle] = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+	}
+	vector<bool> triangleAdded(numTriangles, false);
+
+	// Our modelled LRU cache - it may briefly hold 3 more vertices than the real cache while we add a triangle
+	vector<GLuint> cache;
+	vector<GLuint> newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	vector<GLuint> optimisedIndices;
+	optimisedIndices.reserve(indices.size());
+
+	// Start with the highest scoring triangle
+	size_t bestTriangle = 0;
+	for (size_t triangle = 1; triangle < numTriangles; ++triangle)
+	{
+		if (triangleScore[triangle] > triangleScore[bestTriangle]) { bestTriangle = triangle; }
+	}
+
+	// Note: When none of the triangles using cached vertices are left we carry on from the first triangle we haven't drawn
+	//       yet in the original order, rather than searching every triangle for the best score, which keeps this linear.
+	size_t nextUnaddedTriangle = 0;
+
+	for (size_t addedTriangles = 0; addedTriangles < numTriangles; ++addedTriangles)
+	{
+		// Draw the best triangle and remove it from the triangle lists of its vertices
+		triangleAdded[bestTriangle] = true;
+		const GLuint* triangleVertices = &indices[bestTriangle * 3];
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint vertex = triangleVertices[corner];
+			optimisedIndices.push_back(vertex);
+
+			GLuint* listStart = &triangleLists[ triangleListStart[vertex] ];
+			GLuint  listSize  = remainingTriangles[vertex];
+			for (GLuint loop = 0; loop < listSize; ++loop)
+			{
+				if (listStart[loop] == bestTriangle)
+				{
+					listStart[loop] = listStart[listSize - 1];
+					break;
+				}
+			}
+			--remainingTriangles[vertex];
+		}
+
+		// The triangle's vertices move to the front of the cache, followed by everything else that was in it
+		newCache.assign(triangleVertices, triangleVertices + 3);
+		for (GLuint vertex : cache)
+		{
+			if (vertex != triangleVertices[0] && vertex != triangleVertices[1] && vertex != triangleVertices[2])
+			{
+				newCache.push_back(vertex);
+			}
+		}
+		std::swap(cache, newCache);
+
+		// Re-score every vertex which is in (or has just dropped out of) the cache
+		for (size_t loop = 0; loop < cache.size(); ++loop)
+		{
+			GLuint vertex = cache[loop];
+			cachePosition[vertex] = (loop < FORSYTH_CACHE_SIZE) ? static_cast<int>(loop) : -1;
+			vertexScore[vertex]   = getVertexScore(cachePosition[vertex], remainingTriangles[vertex]);
+		}
+
+		// Re-score the remaining triangles which use those vertices, picking the best of them to draw next
+		float bestScore = -1.0f;
+		bool  foundTriangle = false;
+		for (GLuint vertex : cache)
+		{
+			const GLuint* listStart = &triangleLists[ triangleListStart[vertex] ];
+			for (GLuint loop = 0; loop < remainingTriangles[vertex]; ++loop)
+			{
+				GLuint triangle = listStart[loop];
+				float score = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+				if (score > bestScore)
+				{
+					bestScore     = score;
+					bestTriangle  = triangle;
+					foundTriangle = true;
+				}
+			}
+		}
+
+		// Trim the cache back down to size
+		if (cache.size() > FORSYTH_CACHE_SIZE)
+		{
+			cache.resize(FORSYTH_CACHE_SIZE);
+		}
+
+		// Dead end? Then carry on from the next triangle we haven't drawn yet
+		if (!foundTriangle)
+		{
+			while (nextUnaddedTriangle < numTriangles && triangleAdded[nextUnaddedTriangle])
+			{
+				++nextUnaddedTriangle;
+			}
+			bestTriangle = nextUnaddedTriangle;
+		}
+	}
+
+	indices.swap(optimisedIndices);
+}
+
+// Method to renumber vertices in the order they're first used
+vector<GLuint> MeshOptimiser::optimiseVertexFetch(vector<GLuint> &indices, GLuint numVertices)
+{
+	const GLuint UNUSED = 0xFFFFFFFF;
+	vector<GLuint> remap(numVertices, UNUSED);
+
+	GLuint nextVertex = 0;
+	for (GLuint &index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = nextVertex++;
+		}
+		index = remap[index];
+	}
+
+	// Any vertices which no triangle refers to go at the end
+	for (GLuint &newIndex : remap)
+	{
+		if (newIndex == UNUSED)
+		{
+			newIndex = nextVertex++;
+		}
+	}
+
+	return remap;
+}
+
+// Private method to count the vertex shader runs for a FIFO post-transform cache of the given size
+GLuint MeshOptimiser::countCacheMisses(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize)
+{
+	// Rather than shuffling a FIFO along we stamp each vertex with the time it entered the cache - it's still in the cache if
+	// fewer than cacheSize other vertices have entered since.
+	vector<GLuint> entryTime(numVertices, 0);
+	GLuint time   = cacheSize + 1;
+	GLuint misses = 0;
+	for (GLuint index : indices)
+	{
+		if (time - entryTime[index] > cacheSize)
+		{
+			entryTime[index] = time++;
+			++misses;
+		}
+	}
+	return misses;
+}
+
+// Method to get the Average Cache Miss Ratio - the number of vertex shader runs per triangle
+float MeshOptimiser::getACMR(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize)
+{
+	size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0) { return 0.0f; }
+	return static_cast<float>( countCacheMisses(indices, numVertices, cacheSize) ) / static_cast<float>(numTriangles);
+}
+
+// Method to get the Average Transformed Vertex Ratio - the number of vertex shader runs per vertex
+float MeshOptimiser::getATVR(const vector<GLuint> &indices, GLuint numVertices, GLuint cacheSize)
+{
+	if (numVertices == 0) { return 0.0f; }
+	return static_cast<float>( countCacheMisses(indices, numVertices, cacheSize) ) / static_cast<float>(numVertices);
+}
+
+// Private method to split a vertex cache optimised triangle order into clusters which can be drawn in any order.
+// Note: A triangle which misses the cache on all three of its vertices doesn't benefit from the triangles before it, so it always starts
+//       a new ("hard") cluster. We then split each hard cluster further at any point where the ACMR of the triangles so far is within the
+//       threshold of the ACMR of the whole cluster - starting again from there with an empty cache then won't cost us much cache efficiency.
+vector<size_t> MeshOptimiser::getOverdrawClusterStarts(const vector<GLuint> &indices, GLuint numVertices, float acmrThreshold)
+{
+	const size_t numTriangles = indices.size() / 3;
+
+	// FIFO cache where each vertex is stamped with the time it entered the cache (see countCacheMisses).
+	// Note: Moving time on by more than the cache size empties the cache without touching every vertex.
+	vector<GLuint> entryTime(numVertices, 0);
+	GLuint time = STATS_CACHE_SIZE + 1;
+	auto countTriangleMisses = [&](size_t triangle)
+	{
+		GLuint misses = 0;
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint vertex = indices[triangle * 3 + corner];
+			if (time - entryTime[vertex] > STATS_CACHE_SIZE)
+			{
+				entryTime[vertex] = time++;
+				++misses;
+			}
+		}
+		return misses;
+	};
+	auto emptyCache = [&]() { time += STATS_CACHE_SIZE + 1; };
+
+	// Hard cluster boundaries
+	vector<size_t> hardStarts;
+	for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		if (countTriangleMisses(triangle) == 3 || triangle == 0)
+		{
+			hardStarts.push_back(triangle);
+		}
+	}
+	hardStarts.push_back(numTriangles);
+
+	// Soft cluster boundaries
+	vector<size_t> clusterStarts;
+	for (size_t cluster = 0; cluster + 1 < hardStarts.size(); ++cluster)
+	{
+		size_t start = hardStarts[cluster];
+		size_t end   = hardStarts[cluster + 1];
+
+		emptyCache();
+		GLuint clusterMisses = 0;
+		for (size_t triangle = start; triangle < end; ++triangle)
+		{
+			clusterMisses += countTriangleMisses(triangle);
+		}
+		float clusterThreshold = acmrThreshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+		clusterStarts.push_back(start);
+		emptyCache();
+		GLuint runningMisses    = 0;
+		GLuint runningTriangles = 0;
+		for (size_t triangle = start; triangle < end; ++triangle)
+		{
+			runningMisses += countTriangleMisses(triangle);
+			++runningTriangles;
+
+			if (triangle + 1 < end && static_cast<float>(runningMisses) / static_cast<float>(runningTriangles) <= clusterThreshold)
+			{
+				clusterStarts.push_back(triangle + 1);
+				emptyCache();
+				runningMisses    = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+	clusterStarts.push_back(numTriangles);
+
+	return clusterStarts;
+}
+
+// Method to reorder triangle clusters so that the ones most likely to hide the rest of the mesh are drawn first
+void MeshOptimiser::optimiseOverdraw(vector<GLuint> &indices, const vector<vec3> &positions, float acmrThreshold)
+{
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles < 2)
+	{
+		return;
+	}
+
+	vector<size_t> clusterStarts = getOverdrawClusterStarts(indices, static_cast<GLuint>( positions.size() ), acmrThreshold);
+	const size_t numClusters = clusterStarts.size() - 1;
+
+	// Work out the area-weighted centroid and normal of each cluster, and the area-weighted centroid of the whole mesh
+	// Note: The length of a triangle's cross product is twice its area, so we can use it directly as the weight.
+	vector<vec3>  clusterCentroids(numClusters, vec3(0.0f));
+	vector<vec3>  clusterNormals(numClusters, vec3(0.0f));
+	vector<float> clusterAreas(numClusters, 0.0f);
+	vec3  meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < numClusters; ++cluster)
+	{
+		for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+		{
+			const vec3 &v1 = positions[ indices[triangle * 3]     ];
+			const vec3 &v2 = positions[ indices[triangle * 3 + 1] ];
+			const vec3 &v3 = positions[ indices[triangle * 3 + 2] ];
+			vec3  normal = glm::cross(v2 - v1, v3 - v1);
+			float area   = glm::length(normal);
+
+			clusterCentroids[cluster] += (v1 + v2 + v3) * (area / 3.0f);
+			clusterNormals[cluster]   += normal;
+			clusterAreas[cluster]     += area;
+		}
+		meshCentroid += clusterCentroids[cluster];
+		meshArea     += clusterAreas[cluster];
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	// Clusters which are far out from the centre of the mesh and face away from it are likely to be in front of the rest of the mesh
+	// whichever direction we look at it from, so they get the highest scores
+	vector<float> clusterScores(numClusters, 0.0f);
+	for (size_t cluster = 0; cluster < numClusters; ++cluster)
+	{
+		float normalLength = glm::length(clusterNormals[cluster]);
+		if (clusterAreas[cluster] > 0.0f && normalLength > 0.0f)
+		{
+			vec3 centroid = clusterCentroids[cluster] / clusterAreas[cluster];
+			clusterScores[cluster] = glm::dot(centroid - meshCentroid, clusterNormals[cluster] / normalLength);
+		}
+	}
+
+	vector<size_t> clusterOrder(numClusters);
+	for (size_t cluster = 0; cluster < numClusters; ++cluster)
+	{
+		clusterOrder[cluster] = cluster;
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](size_t a, size_t b) { return clusterScores[a] > clusterScores[b]; });
+
+	// Copy the clusters into their new order
+	vector<GLuint> reorderedIndices;
+	reorderedIndices.reserve(indices.size());
+	for (size_t cluster : clusterOrder)
+	{
+		reorderedIndices.insert(reorderedIndices.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+	}
+	indices.swap(reorderedIndices);
+
+	cout << "Overdraw optimisation sorted " << numTriangles << " triangles in " << numClusters << " clusters." << endl;
+}
+
+// Method to measure overdraw by rasterising the mesh in software from several directions
+MeshOptimiser::OverdrawStatistics MeshOptimiser::analyseOverdraw(const GLvoid* indices, GLenum indexType, GLuint numIndices, const GLfloat* positions, GLuint numVertices, int resolution)
+{
+	OverdrawStatistics statistics;
+	if (numVertices == 0 || numIndices < 3 || resolution <= 0)
+	{
+		return statistics;
+	}
+
+	auto getIndex = [&](GLuint loop) -> GLuint
+	{
+		if (indices == nullptr)             { return loop;                                        }
+		if (indexType == GL_UNSIGNED_SHORT) { return static_cast<const GLushort*>(indices)[loop]; }
+		return static_cast<const GLuint*>(indices)[loop];
+	};
+
+	// Fit every view around the bounding sphere of the mesh
+	vec3 boundsMin(positions[0], positions[1], positions[2]);
+	vec3 boundsMax = boundsMin;
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		vec3 position(positions[loop * 3], positions[loop * 3 + 1], positions[loop * 3 + 2]);
+		boundsMin = glm::min(boundsMin, position);
+		boundsMax = glm::max(boundsMax, position);
+	}
+	vec3  centre = (boundsMin + boundsMax) * 0.5f;
+	float radius = glm::length(boundsMax - centre);
+	if (radius <= 0.0f)
+	{
+		return statistics;
+	}
+	const float halfResolution = resolution * 0.5f;
+	const float pixelsPerUnit  = halfResolution / radius;
+
+	// We look at the mesh along the axes and along the diagonals of a cube
+	const vec3 viewDirections[] =
+	{
+		vec3( 1.0f,  0.0f,  0.0f), vec3(-1.0f,  0.0f,  0.0f), vec3( 0.0f,  1.0f,  0.0f), vec3( 0.0f, -1.0f,  0.0f),
+		vec3( 0.0f,  0.0f,  1.0f), vec3( 0.0f,  0.0f, -1.0f), vec3( 1.0f,  1.0f,  1.0f), vec3( 1.0f,  1.0f, -1.0f),
+		vec3( 1.0f, -1.0f,  1.0f), vec3( 1.0f, -1.0f, -1.0f), vec3(-1.0f,  1.0f,  1.0f), vec3(-1.0f,  1.0f, -1.0f),
+		vec3(-1.0f, -1.0f,  1.0f), vec3(-1.0f, -1.0f, -1.0f)
+	};
+
+	const float farDepth = std::numeric_limits<float>::max();
+	vector<float> depthBuffer(static_cast<size_t>(resolution) * resolution);
+	vector<vec3>  screenPositions(numVertices);
+
+	for (const vec3 &viewDirection : viewDirections)
+	{
+		// Build a right-handed basis where we look down the negative view direction (i.e. from a camera out along the view direction)
+		vec3 towardsViewer = glm::normalize(viewDirection);
+		vec3 helperAxis    = (std::abs(towardsViewer.y) < 0.99f) ? vec3(0.0f, 1.0f, 0.0f) : vec3(1.0f, 0.0f, 0.0f);
+		vec3 right         = glm::normalize( glm::cross(helperAxis, towardsViewer) );
+		vec3 up            = glm::cross(towardsViewer, right);
+
+		// Orthographic projection into pixel coordinates, with smaller depths being closer to the viewer
+		for (GLuint loop = 0; loop < numVertices; ++loop)
+		{
+			vec3 position = vec3(positions[loop * 3], positions[loop * 3 + 1], positions[loop * 3 + 2]) - centre;
+			screenPositions[loop] = vec3(halfResolution + glm::dot(position, right) * pixelsPerUnit,
+			                             halfResolution + glm::dot(position, up)    * pixelsPerUnit,
+			                             -glm::dot(position, towardsViewer));
+		}
+
+		std::fill(depthBuffer.begin(), depthBuffer.end(), farDepth);
+
+		for (GLuint loop = 0; loop + 2 < numIndices; loop += 3)
+		{
+			const vec3 &a = screenPositions[ getIndex(loop)     ];
+			const vec3 &b = screenPositions[ getIndex(loop + 1) ];
+			const vec3 &c = screenPositions[ getIndex(loop + 2) ];
+
+			// Twice the signed area of the triangle on screen - anticlockwise triangles face us, so anything else gets culled
+			float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (area <= 0.0f)
+			{
+				continue;
+			}
+
+			int minX = std::max(0,              static_cast<int>( std::floor(std::min({ a.x, b.x, c.x })) ));
+			int maxX = std::min(resolution - 1, static_cast<int>( std::ceil (std::max({ a.x, b.x, c.x })) ));
+			int minY = std::max(0,              static_cast<int>( std::floor(std::min({ a.y, b.y, c.y })) ));
+			int maxY = std::min(resolution - 1, static_cast<int>( std::ceil (std::max({ a.y, b.y, c.y })) ));
+
+			// Test the centre of every pixel in the triangle's bounding box against its three edges
+			for (int y = minY; y <= maxY; ++y)
+			{
+				float py = y + 0.5f;
+				for (int x = minX; x <= maxX; ++x)
+				{
+					float px = x + 0.5f;
+					float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+					float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+					float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					{
+						continue;
+					}
+
+					float depth = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+					float &storedDepth = depthBuffer[static_cast<size_t>(y) * resolution + x];
+					if (depth < storedDepth)
+					{
+						storedDepth = depth;
+						++statistics.pixelsShaded;
+					}
+				}
+			}
+		}
+
+		for (float depth : depthBuffer)
+		{
+			if (depth != farDepth) { ++statistics.pixelsCovered; }
+		}
+	}
+
+	if (statistics.pixelsCovered > 0)
+	{
+		statistics.overdraw = static_cast<float>(statistics.pixelsShaded) / static_cast<float>(statistics.pixelsCovered);
+	}
+	return statistics;
+}
+
+// ----- Quadric error metric helpers -----
+
+// A symmetric 4x4 matrix which gives the sum of the squared distances of a point from a set of planes, along with the total weight of those planes.
+// Note: We only need to store the upper triangle of the matrix, and we use doubles as summing many planes in floats loses too much precision.
+struct Quadric
+{
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double           b2 = 0.0, bc = 0.0, bd = 0.0;
+	double                     c2 = 0.0, cd = 0.0;
+	double                               d2 = 0.0;
+	double weight = 0.0;
+};
+
+// Add the plane ax + by + cz + d = 0 (where a/b/c is a unit normal) to a quadric with the given weight
+static void addPlaneToQuadric(Quadric &q, const vec3 &normal, float distance, double weight)
+{
+	double a = normal.x, b = normal.y, c = normal.z, d = distance;
+	q.a2 += weight * a * a; q.ab += weight * a * b; q.ac += weight * a * c; q.ad += weight * a * d;
+	q.b2 += weight * b * b; q.bc += weight * b * c; q.bd += weight * b * d;
+	q.c2 += weight * c * c; q.cd += weight * c * d;
+	q.d2 += weight * d * d;
+	q.weight += weight;
+}
+
+static void addQuadric(Quadric &q, const Quadric &other)
+{
+	q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+	q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+	q.c2 += other.c2; q.cd += other.cd;
+	q.d2 += other.d2;
+	q.weight += other.weight;
+}
+
+// Returns the weighted average squared distance of a point from the planes of a quadric
+static double getQuadricError(const Quadric &q, const vec3 &point)
+{
+	double x = point.x, y = point.y, z = point.z;
+	double error = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z
+	             + 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+	             + 2.0 * (q.ad * x + q.bd * y + q.cd * z)
+	             + q.d2;
+	return (q.weight > 0.0) ? std::max(error, 0.0) / q.weight : 0.0;
+}
+
+// Method to give each distinct vertex position an id, so that vertices which only differ in their other attributes can be treated as one
+vector<GLuint> MeshOptimiser::getPositionIds(const vector<vec3> &positions, GLuint &numPositions)
+{
+	struct PositionKey
+	{
+		uint32_t bits[3];
+		bool operator==(const PositionKey &other) const { return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2]; }
+	};
+	struct PositionKeyHash
+	{
+		size_t operator()(const PositionKey &key) const
+		{
+			uint64_t hash = (uint64_t(key.bits[0]) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(key.bits[1]) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(key.bits[2]) * 0x165667B19E3779F9ull);
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	vector<GLuint> positionIds(positions.size());
+	std::unordered_map<PositionKey, GLuint, PositionKeyHash> positionIdOfValue;
+	positionIdOfValue.reserve(positions.size());
+	numPositions = 0;
+	for (size_t loop = 0; loop < positions.size(); ++loop)
+	{
+		PositionKey key;
+		memcpy(key.bits, &positions[loop], sizeof(key.bits));
+		auto found = positionIdOfValue.try_emplace(key, numPositions);
+		if (found.second) { ++numPositions; }
+		positionIds[loop] = found.first->second;
+	}
+	return positionIds;
+}
+
+// Method to simplify a mesh using quadric error metrics
+vector<GLuint> MeshOptimiser::simplify(const vector<GLuint> &indices, const vector<vec3> &positions, const vector<vec3> &normals, size_t targetIndexCount, float* resultError)
+{
+	// How much more the planes which hold a border edge in place count for than the planes of the triangles themselves
+	const double BORDER_WEIGHT = 10.0;
+
+	// Collapses which would rotate any triangle by more than this (i.e. the cosine of the angle between the old and new triangle normals is less than this) are rejected
+	const float MIN_COS_TRIANGLE_ROTATION = 0.25f;
+
+	vector<GLuint> result = indices;
+	float maxError = 0.0f;
+	if (resultError != nullptr) { *resultError = 0.0f; }
+
+	const GLuint numVertices = static_cast<GLuint>( positions.size() );
+	if (result.size() <= targetIndexCount || numVertices == 0)
+	{
+		return result;
+	}
+	const bool useNormals = (normals.size() == positions.size());
+
+	// Give each distinct position an id, and list the vertices at each position (where position p's vertices start at positionVertexStart[p])
+	GLuint numPositions = 0;
+	vector<GLuint> positionIds = getPositionIds(positions, numPositions);
+	vector<GLuint> positionVertexStart(numPositions + 1, 0);
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		++positionVertexStart[ positionIds[loop] + 1 ];
+	}
+	for (GLuint loop = 0; loop < numPositions; ++loop)
+	{
+		positionVertexStart[loop + 1] += positionVertexStart[loop];
+	}
+	vector<GLuint> positionVertices(numVertices);
+	{
+		vector<GLuint> fillCount(numPositions, 0);
+		for (GLuint loop = 0; loop < numVertices; ++loop)
+		{
+			GLuint positionId = positionIds[loop];
+			positionVertices[ positionVertexStart[positionId] + fillCount[positionId]++ ] = loop;
+		}
+	}
+
+	// The position of the first vertex with each position id
+	auto getPosition = [&](GLuint positionId) -> const vec3& { return positions[ positionVertices[ positionVertexStart[positionId] ] ]; };
+
+	// Build the quadric of each position from the planes of the triangles around it, weighted by their area
+	vector<Quadric> quadrics(numPositions);
+	std::unordered_map<uint64_t, GLuint> edgeUseCount;
+	edgeUseCount.reserve(result.size());
+	for (size_t loop = 0; loop + 2 < result.size(); loop += 3)
+	{
+		GLuint p[3] = { positionIds[result[loop]], positionIds[result[loop + 1]], positionIds[result[loop + 2]] };
+		const vec3 &v1 = getPosition(p[0]);
+		vec3  normal = glm::cross(getPosition(p[1]) - v1, getPosition(p[2]) - v1);
+		float length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			normal /= length;
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				addPlaneToQuadric(quadrics[ p[corner] ], normal, -glm::dot(normal, v1), 0.5 * length);
+			}
+		}
+
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint a = p[corner];
+			GLuint b = p[(corner + 1) % 3];
+			++edgeUseCount[ (uint64_t(std::min(a, b)) << 32) | std::max(a, b) ];
+		}
+	}
+
+	// Edges used by only one triangle are on the border of the mesh - we hold them in place with a plane through the edge at right angles to the triangle
+	for (size_t loop = 0; loop + 2 < result.size(); loop += 3)
+	{
+		GLuint p[3] = { positionIds[result[loop]], positionIds[result[loop + 1]], positionIds[result[loop + 2]] };
+		vec3 triangleNormal = glm::cross(getPosition(p[1]) - getPosition(p[0]), getPosition(p[2]) - getPosition(p[0]));
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint a = p[corner];
+			GLuint b = p[(corner + 1) % 3];
+			if (a == b || edgeUseCount[ (uint64_t(std::min(a, b)) << 32) | std::max(a, b) ] != 1)
+			{
+				continue;
+			}
+
+			vec3  edge       = getPosition(b) - getPosition(a);
+			vec3  edgeNormal = glm::cross(edge, triangleNormal);
+			float length     = glm::length(edgeNormal);
+			if (length > 0.0f)
+			{
+				edgeNormal /= length;
+				double edgeLengthSquared = glm::dot(edge, edge);
+				addPlaneToQuadric(quadrics[a], edgeNormal, -glm::dot(edgeNormal, getPosition(a)), BORDER_WEIGHT * edgeLengthSquared);
+				addPlaneToQuadric(quadrics[b], edgeNormal, -glm::dot(edgeNormal, getPosition(a)), BORDER_WEIGHT * edgeLengthSquared);
+			}
+		}
+	}
+	edgeUseCount.clear();
+
+	// An edge collapse moves every vertex at the "from" position to the "to" position
+	struct Collapse
+	{
+		GLuint from;
+		GLuint to;
+		float  error;
+	};
+	vector<Collapse> collapses;
+	vector<uint64_t> edges;
+	vector<GLuint>   triangleListStart(numPositions + 1);
+	vector<GLuint>   triangleLists;
+	vector<GLuint>   positionRemap(numPositions);
+	vector<bool>     positionLocked(numPositions);
+	vector<GLuint>   vertexRemap(numVertices);
+	vector<GLuint>   simplified;
+
+	// We collapse edges in passes - each pass collapses the cheapest edges that don't touch each other, then rebuilds the triangles
+	while (result.size() > targetIndexCount)
+	{
+		const size_t numTriangles = result.size() / 3;
+
+		// Find the unique edges of the current triangles
+		edges.clear();
+		for (size_t loop = 0; loop < result.size(); loop += 3)
+		{
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				GLuint a = positionIds[ result[loop + corner] ];
+				GLuint b = positionIds[ result[loop + (corner + 1) % 3] ];
+				if (a != b)
+				{
+					edges.push_back( (uint64_t(std::min(a, b)) << 32) | std::max(a, b) );
+				}
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		// Work out the cheapest direction to collapse each edge in, and sort the collapses from cheapest to most expensive
+		collapses.clear();
+		for (uint64_t edge : edges)
+		{
+			GLuint a = static_cast<GLuint>(edge >> 32);
+			GLuint b = static_cast<GLuint>(edge & 0xFFFFFFFF);
+			Quadric combined = quadrics[a];
+			addQuadric(combined, quadrics[b]);
+			double errorAToB = getQuadricError(combined, getPosition(b));
+			double errorBToA = getQuadricError(combined, getPosition(a));
+			if (errorAToB <= errorBToA) { collapses.push_back({ a, b, static_cast<float>( std::sqrt(errorAToB) ) }); }
+			else                        { collapses.push_back({ b, a, static_cast<float>( std::sqrt(errorBToA) ) }); }
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y) { return x.error < y.error; });
+
+		// List the triangles around each position
+		std::fill(triangleListStart.begin(), triangleListStart.end(), 0);
+		for (GLuint index : result)
+		{
+			++triangleListStart[ positionIds[index] + 1 ];
+		}
+		for (GLuint loop = 0; loop < numPositions; ++loop)
+		{
+			triangleListStart[loop + 1] += triangleListStart[loop];
+		}
+		triangleLists.resize(result.size());
+		{
+			vector<GLuint> fillCount(numPositions, 0);
+			for (size_t loop = 0; loop < result.size(); ++loop)
+			{
+				GLuint positionId = positionIds[ result[loop] ];
+				triangleLists[ triangleListStart[positionId] + fillCount[positionId]++ ] = static_cast<GLuint>(loop / 3);
+			}
+		}
+
+		// Each collapse removes two triangles from a closed mesh, so we don't need to do more than half as many as we have triangles to lose
+		const size_t trianglesToRemove = numTriangles - targetIndexCount / 3;
+		const size_t maxCollapses      = std::max<size_t>(1, (trianglesToRemove + 1) / 2);
+
+		for (GLuint loop = 0; loop < numPositions; ++loop)
+		{
+			positionRemap[loop] = loop;
+		}
+		std::fill(positionLocked.begin(), positionLocked.end(), false);
+
+		size_t collapseCount = 0;
+		for (const Collapse &collapse : collapses)
+		{
+			if (collapseCount >= maxCollapses)
+			{
+				break;
+			}
+			if (positionLocked[collapse.from] || positionLocked[collapse.to])
+			{
+				continue;
+			}
+
+			// Reject the collapse if it would flip (or badly twist) any of the triangles around the position we're moving
+			bool flipsTriangle = false;
+			const vec3 &newPosition = getPosition(collapse.to);
+			for (GLuint loop = triangleListStart[collapse.from]; loop < triangleListStart[collapse.from + 1] && !flipsTriangle; ++loop)
+			{
+				const GLuint* triangle = &result[ size_t(triangleLists[loop]) * 3 ];
+				GLuint p[3] = { positionIds[triangle[0]], positionIds[triangle[1]], positionIds[triangle[2]] };
+				if (p[0] == collapse.to || p[1] == collapse.to || p[2] == collapse.to)
+				{
+					continue; // This triangle will be removed by the collapse
+				}
+
+				vec3 before[3] = { getPosition(p[0]), getPosition(p[1]), getPosition(p[2]) };
+				vec3 after[3]  = { before[0], before[1], before[2] };
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					if (p[corner] == collapse.from) { after[corner] = newPosition; }
+				}
+				vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				vec3 normalAfter  = glm::cross(after[1]  - after[0],  after[2]  - after[0]);
+				flipsTriangle = glm::dot(normalBefore, normalAfter) <= MIN_COS_TRIANGLE_ROTATION * glm::length(normalBefore) * glm::length(normalAfter);
+			}
+			if (flipsTriangle)
+			{
+				continue;
+			}
+
+			positionRemap[collapse.from] = collapse.to;
+			addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			maxError = std::max(maxError, collapse.error);
+			++collapseCount;
+
+			// Lock every position around the one we moved so that the triangles we just checked don't change again this pass
+			for (GLuint loop = triangleListStart[collapse.from]; loop < triangleListStart[collapse.from + 1]; ++loop)
+			{
+				const GLuint* triangle = &result[ size_t(triangleLists[loop]) * 3 ];
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					positionLocked[ positionIds[triangle[corner]] ] = true;
+				}
+			}
+		}
+
+		// Nothing more we can collapse? Then this is as simple as the mesh gets.
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		// Move each vertex at a collapsed position to the vertex at its new position with the most similar normal
+		for (GLuint loop = 0; loop < numVertices; ++loop)
+		{
+			GLuint newPositionId = positionRemap[ positionIds[loop] ];
+			vertexRemap[loop] = loop;
+			if (newPositionId != positionIds[loop])
+			{
+				float bestDot = -2.0f;
+				for (GLuint candidate = positionVertexStart[newPositionId]; candidate < positionVertexStart[newPositionId + 1]; ++candidate)
+				{
+					GLuint vertex = positionVertices[candidate];
+					float  dot    = useNormals ? glm::dot(normals[loop], normals[vertex]) : 0.0f;
+					if (dot > bestDot)
+					{
+						bestDot           = dot;
+						vertexRemap[loop] = vertex;
+					}
+				}
+			}
+		}
+
+		// Rebuild the triangles, dropping any which have collapsed down to a line
+		simplified.clear();
+		for (size_t loop = 0; loop < result.size(); loop += 3)
+		{
+			GLuint v[3] = { vertexRemap[result[loop]], vertexRemap[result[loop + 1]], vertexRemap[result[loop + 2]] };
+			GLuint p[3] = { positionIds[v[0]], positionIds[v[1]], positionIds[v[2]] };
+			if (p[0] != p[1] && p[1] != p[2] && p[0] != p[2])
+			{
+				simplified.insert(simplified.end(), v, v + 3);
+			}
+		}
+		result.swap(simplified);
+
+		// If most of the collapses we'd like to make are being rejected then each pass gets us very little closer to the target, so we
+		// give up once a pass removes less than 5% of the triangles we still needed to lose (e.g. the mesh is a soup of unconnected triangles)
+		if ( (numTriangles - result.size() / 3) < trianglesToRemove / 20 )
+		{
+			break;
+		}
+	}
+
+	if (resultError != nullptr) { *resultError = maxError; }
+	return result;
+}
+
+// Method to work out the bounding sphere and normal cone of a meshlet from its triangles
+void MeshOptimiser::computeMeshletBounds(Meshlet &meshlet, const GLuint* indices, const vector<vec3> &positions)
+{
+	const GLuint* meshletIndices = indices + meshlet.firstIndex;
+	const GLuint  indexCount     = meshlet.triangleCount * 3;
+
+	// Note: The centroid of the corners isn't the centre of the smallest sphere around them, but it's close enough and cheap to find.
+	//       Shared vertices get counted more than once, which just pulls the centre towards the middle of the meshlet.
+	vec3 centre(0.0f);
+	for (GLuint loop = 0; loop < indexCount; ++loop)
+	{
+		centre += positions[ meshletIndices[loop] ];
+	}
+	centre /= static_cast<float>( std::max(indexCount, 1u) );
+
+	float radius = 0.0f;
+	for (GLuint loop = 0; loop < indexCount; ++loop)
+	{
+		radius = std::max(radius, glm::length(positions[ meshletIndices[loop] ] - centre));
+	}
+
+	// The cone axis is the average direction of the triangles, and the cone has to be wide enough to hold every triangle's normal
+	vec3 axis(0.0f);
+	for (GLuint loop = 0; loop < indexCount; loop += 3)
+	{
+		axis += getUnitTriangleNormal(meshletIndices + loop, positions);
+	}
+	float axisLength = glm::length(axis);
+	axis = (axisLength > 0.0f) ? axis / axisLength : vec3(0.0f, 0.0f, 1.0f);
+
+	float minDot = 1.0f;
+	for (GLuint loop = 0; loop < indexCount; loop += 3)
+	{
+		vec3 normal = getUnitTriangleNormal(meshletIndices + loop, positions);
+		if (normal != vec3(0.0f))
+		{
+			minDot = std::min(minDot, glm::dot(axis, normal));
+		}
+	}
+
+	memcpy(meshlet.centre,   &centre[0], sizeof(meshlet.centre));
+	memcpy(meshlet.coneAxis, &axis[0],   sizeof(meshlet.coneAxis));
+	meshlet.radius     = radius;
+	meshlet.coneCutoff = (minDot <= 0.0f || axisLength == 0.0f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+// Method to get the unit normal of a triangle (or zero if it has no area)
+vec3 MeshOptimiser::getUnitTriangleNormal(const GLuint* triangle, const vector<vec3> &positions)
+{
+	const vec3 &v1 = positions[ triangle[0] ];
+	vec3  normal = glm::cross(positions[ triangle[1] ] - v1, positions[ triangle[2] ] - v1);
+	float length = glm::length(normal);
+	return (length > 0.0f) ? normal / length : vec3(0.0f);
+}
+
+// Method to split a list of triangles into meshlets of at most MAX_MESHLET_VERTICES vertices and MAX_MESHLET_TRIANGLES triangles
+vector<MeshOptimiser::Meshlet> MeshOptimiser::buildMeshlets(vector<GLuint> &indices, const vector<vec3> &positions)
+{
+	vector<Meshlet> meshlets;
+	const GLuint numTriangles = static_cast<GLuint>( indices.size() / 3 );
+	const GLuint numVertices  = static_cast<GLuint>( positions.size() );
+	if (numTriangles == 0 || numVertices == 0)
+	{
+		return meshlets;
+	}
+
+	// Build a list of the triangles at each position, where position p's triangles start at triangleListStart[p]
+	// Note: We find neighbouring triangles by position rather than by vertex so that meshlets can grow across seams where the normals differ
+	GLuint numPositions = 0;
+	vector<GLuint> positionIds = getPositionIds(positions, numPositions);
+	vector<GLuint> triangleListStart(numPositions + 1, 0);
+	for (GLuint loop = 0; loop < numTriangles * 3; ++loop)
+	{
+		++triangleListStart[ positionIds[ indices[loop] ] + 1 ];
+	}
+	for (GLuint loop = 0; loop < numPositions; ++loop)
+	{
+		triangleListStart[loop + 1] += triangleListStart[loop];
+	}
+	vector<GLuint> triangleLists(numTriangles * 3);
+	vector<GLuint> fillCount(numPositions, 0);
+	for (GLuint triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			GLuint positionId = positionIds[ indices[triangle * 3 + corner] ];
+			triangleLists[ triangleListStart[positionId] + fillCount[positionId]++ ] = triangle;
+		}
+	}
+
+	vector<vec3> triangleNormals(numTriangles);
+	for (GLuint triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		triangleNormals[triangle] = getUnitTriangleNormal(&indices[triangle * 3], positions);
+	}
+
+	// The meshlet each vertex was last added to, so we can tell how many new vertices a triangle would add to the current meshlet
+	const GLuint NO_MESHLET = 0xFFFFFFFF;
+	vector<GLuint> vertexMeshlet(numVertices, NO_MESHLET);
+	vector<bool>   triangleUsed(numTriangles, false);
+	vector<GLuint> meshletVertices;
+	meshletVertices.reserve(MAX_MESHLET_VERTICES);
+
+	vector<GLuint> newIndices;
+	newIndices.reserve(indices.size());
+
+	auto countNewVertices = [&](GLuint triangle, GLuint meshletNumber)
+	{
+		const GLuint* corners = &indices[triangle * 3];
+		GLuint newVertices = 0;
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			// Note: A triangle can use the same vertex twice, so we only count each new vertex once
+			bool repeated = (corner > 0 && corners[corner] == corners[0]) || (corner > 1 && corners[corner] == corners[1]);
+			if (vertexMeshlet[ corners[corner] ] != meshletNumber && !repeated)
+			{
+				++newVertices;
+			}
+		}
+		return newVertices;
+	};
+
+	GLuint nextSeed = 0;
+	while (true)
+	{
+		// Start each meshlet with the first unused triangle, so the meshlets follow the order the triangles were in
+		while (nextSeed < numTriangles && triangleUsed[nextSeed])
+		{
+			++nextSeed;
+		}
+		if (nextSeed == numTriangles)
+		{
+			break;
+		}
+
+		const GLuint meshletNumber = static_cast<GLuint>( meshlets.size() );
+		Meshlet meshlet    = {};
+		meshlet.firstIndex = static_cast<GLuint>( newIndices.size() );
+		meshletVertices.clear();
+		vec3   normalSum(0.0f);
+		GLuint triangle = nextSeed;
+
+		while (true)
+		{
+			// Add the triangle to the meshlet
+			triangleUsed[triangle] = true;
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				GLuint vertex = indices[triangle * 3 + corner];
+				newIndices.push_back(vertex);
+				if (vertexMeshlet[vertex] != meshletNumber)
+				{
+					vertexMeshlet[vertex] = meshletNumber;
+					meshletVertices.push_back(vertex);
+				}
+			}
+			normalSum += triangleNormals[triangle];
+			++meshlet.triangleCount;
+			if (meshlet.triangleCount == MAX_MESHLET_TRIANGLES)
+			{
+				break;
+			}
+
+			// Pick the next triangle from those which share a position with the meshlet - preferring triangles which add the fewest new vertices
+			// (to keep the meshlet compact) and then those facing closest to the meshlet's average normal (to keep its normal cone narrow).
+			// Note: We look around the triangle we just added first, and only search around every vertex of the meshlet if that finds nothing.
+			float  normalSumLength = glm::length(normalSum);
+			vec3   averageNormal   = (normalSumLength > 0.0f) ? normalSum / normalSumLength : vec3(0.0f);
+			GLuint bestTriangle    = NO_MESHLET;
+			float  bestScore       = std::numeric_limits<float>::max();
+			auto considerTrianglesAround = [&](GLuint vertex)
+			{
+				GLuint positionId = positionIds[vertex];
+				for (GLuint entry = triangleListStart[positionId]; entry < triangleListStart[positionId + 1]; ++entry)
+				{
+					GLuint candidate = triangleLists[entry];
+					if (triangleUsed[candidate])
+					{
+						continue;
+					}
+					GLuint newVertices = countNewVertices(candidate, meshletNumber);
+					float  facing      = glm::dot(averageNormal, triangleNormals[candidate]);
+					if (meshletVertices.size() + newVertices > MAX_MESHLET_VERTICES || facing < MESHLET_SPLIT_NORMAL_DOT)
+					{
+						continue;
+					}
+					float score = static_cast<float>(newVertices) + (1.0f - facing);
+					if (score < bestScore)
+					{
+						bestScore    = score;
+						bestTriangle = candidate;
+					}
+				}
+			};
+
+			const GLuint* lastTriangle = &indices[triangle * 3];
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				considerTrianglesAround(lastTriangle[corner]);
+			}
+			if (bestTriangle == NO_MESHLET)
+			{
+				for (GLuint vertex : meshletVertices)
+				{
+					considerTrianglesAround(vertex);
+				}
+			}
+			if (bestTriangle == NO_MESHLET)
+			{
+				break;
+			}
+			triangle = bestTriangle;
+		}
+
+		meshlet.vertexCount = static_cast<GLuint>( meshletVertices.size() );
+		meshlets.push_back(meshlet);
+	}
+
+	// Growing meshlets by position rather than by cache use loses some of the vertex cache optimisation, so we get most of it back by reordering
+	// the triangles within each meshlet. Each meshlet has few enough vertices that we renumber them locally first - so this stays quick.
+	vector<GLuint> localIndices;
+	vector<GLuint> localToGlobal;
+	for (Meshlet &meshlet : meshlets)
+	{
+		GLuint* meshletIndices = &newIndices[meshlet.firstIndex];
+		const GLuint meshletIndexCount = meshlet.triangleCount * 3;
+		localIndices.resize(meshletIndexCount);
+		localToGlobal.clear();
+		for (GLuint loop = 0; loop < meshletIndexCount; ++loop)
+		{
+			GLuint vertex = meshletIndices[loop];
+			auto   found  = std::find(localToGlobal.begin(), localToGlobal.end(), vertex);
+			localIndices[loop] = static_cast<GLuint>( found - localToGlobal.begin() );
+			if (found == localToGlobal.end())
+			{
+				localToGlobal.push_back(vertex);
+			}
+		}
+
+		optimiseVertexCache(localIndices, static_cast<GLuint>( localToGlobal.size() ));
+		for (GLuint loop = 0; loop < meshletIndexCount; ++loop)
+		{
+			meshletIndices[loop] = localToGlobal[ localIndices[loop] ];
+		}
+		computeMeshletBounds(meshlet, newIndices.data(), positions);
+	}
+
+	// Note: Any leftover indices (i.e. a partial triangle at the end of the list) are dropped, just as they would be when drawing
+	indices.swap(newIndices);
+	return meshlets;
+}
+
+// Method to find out whether all of a meshlet's triangles face away from the camera.
+// Note: Every direction from the camera to a point in the meshlet's bounding sphere must lie within the cone of directions which see the
+//       back of every triangle - this is the bounding sphere version of the cone test used with mesh shaders.
+bool MeshOptimiser::isMeshletBackFacing(const Meshlet &meshlet, const vec3 &cameraPosition)
+{
+	vec3 centre(meshlet.centre[0], meshlet.centre[1], meshlet.centre[2]);
+	vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+	vec3 cameraToCentre = centre - cameraPosition;
+	return glm::dot(cameraToCentre, axis) >= meshlet.coneCutoff * glm::length(cameraToCentre) + meshlet.radius;
+}
+
+// Helper function to get how many threads parallelForRanges will split a range of count items across
+static size_t getParallelThreadCount(size_t count, size_t minCountPerThread)
+{
+	size_t numThreads = std::max<size_t>(1, count / std::max<size_t>(1, minCountPerThread));
+	return std::min<size_t>(numThreads, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Helper function to split the range [0, count) into one contiguous block per thread and call function(begin, end) on each block in parallel.
+// Note: The first block runs on this thread, and ranges with fewer than minCountPerThread items per thread use fewer threads (down to just this one).
+template <typename Function>
+static void parallelForRanges(size_t count, size_t minCountPerThread, Function function)
+{
+	size_t numThreads = getParallelThreadCount(count, minCountPerThread);
+
+	vector<std::thread> workers;
+	for (size_t loop = 1; loop < numThreads; ++loop)
+	{
+		workers.emplace_back(function, count * loop / numThreads, count * (loop + 1) / numThreads);
+	}
+	function(size_t(0), count / numThreads);
+	for (std::thread &worker : workers) { worker.join(); }
+}
+
+// Helper function to approximate acos to within about 0.0001 radians, which is plenty for weighting normals.
+// Note: This is formula 4.4.45 from Abramowitz & Stegun's "Handbook of Mathematical Functions", reflected for negative values. It only needs a
+//       square root, so (unlike std::acos) we can also do it four at a time with SSE - and we use the same steps in both so they give the same results.
+static float approximateAcos(float x)
+{
+	float absX   = std::abs(x);
+	float result = std::sqrt(1.0f - absX) * (1.5707288f + absX * (-0.2121144f + absX * (0.0742610f + absX * -0.0187293f)));
+	return (x < 0.0f) ? 3.14159265f - result : result;
+}
+
+#ifdef MESH_OPTIMISER_USE_SSE
+static __m128 approximateAcos(__m128 x)
+{
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 absX   = _mm_andnot_ps(signMask, x);
+	__m128 poly   = _mm_add_ps(_mm_set1_ps(0.0742610f), _mm_mul_ps(absX, _mm_set1_ps(-0.0187293f)));
+	poly          = _mm_add_ps(_mm_set1_ps(-0.2121144f), _mm_mul_ps(absX, poly));
+	poly          = _mm_add_ps(_mm_set1_ps(1.5707288f), _mm_mul_ps(absX, poly));
+	__m128 result = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), absX)), poly);
+
+	__m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+	return _mm_or_ps(_mm_and_ps(negative, _mm_sub_ps(_mm_set1_ps(3.14159265f), result)), _mm_andnot_ps(negative, result));
+}
+#endif
+
+// The unit normal of a triangle and how much it contributes to the normal at each of its corners (its area times its angle at that corner)
+struct SmoothNormalTriangle
+{
+	vec3  unitNormal;
+	float cornerWeights[3];
+};
+
+// Helper function to work out the unit normal and corner weights of a triangle from its edges v0->v1, v0->v2 and v1->v2.
+// Note: A degenerate triangle gets a zero normal and zero weights, so it never affects the normals around it.
+static void getSmoothNormalTriangle(const vec3 &edge01, const vec3 &edge02, const vec3 &edge12, SmoothNormalTriangle &triangle)
+{
+	vec3  normal       = glm::cross(edge01, edge02);
+	float normalLength = std::sqrt( glm::dot(normal, normal) );
+	float length01     = std::sqrt( glm::dot(edge01, edge01) );
+	float length02     = std::sqrt( glm::dot(edge02, edge02) );
+	float length12     = std::sqrt( glm::dot(edge12, edge12) );
+
+	// The cosine of the angle at each corner, from the two edges which meet there
+	const float minimumDenominator = std::numeric_limits<float>::min();
+	float cos0 = glm::clamp( glm::dot(edge01, edge02)  / std::max(length01 * length02, minimumDenominator), -1.0f, 1.0f);
+	float cos1 = glm::clamp(-glm::dot(edge01, edge12)  / std::max(length01 * length12, minimumDenominator), -1.0f, 1.0f);
+	float cos2 = glm::clamp( glm::dot(edge02, edge12)  / std::max(length02 * length12, minimumDenominator), -1.0f, 1.0f);
+
+	// Note: The length of the cross product is twice the triangle's area, but only the relative weights matter
+	triangle.unitNormal       = normal * (1.0f / std::max(normalLength, minimumDenominator));
+	triangle.cornerWeights[0] = normalLength * approximateAcos(cos0);
+	triangle.cornerWeights[1] = normalLength * approximateAcos(cos1);
+	triangle.cornerWeights[2] = normalLength * approximateAcos(cos2);
+}
+
+// Method to generate a smooth normal for every corner of every triangle.
+// We do this in two passes so that no two threads ever write to the same place (and so we never need atomics):
+//    1. Split the triangles between the threads, and work out each triangle's unit normal and the weight of each of its corners.
+//    2. Split the positions between the threads, and for each position gather the normals of the triangles around it (found through a table of the
+//       corners at each position) into the normals of its own corners.
+// Also: Summing each position's triangles in the same order every time means the results don't depend on how many threads we use.
+void MeshOptimiser::generateSmoothNormals(const vector<GLuint> &indices, const vector<vec3> &positions, vector<vec3> &cornerNormals, float creaseAngleDegs)
+{
+	const size_t numTriangles = indices.size() / 3;
+	const size_t numCorners   = numTriangles * 3;
+	const size_t numPositions = positions.size();
+	cornerNormals.resize(numCorners); // Note: Every corner is written in pass 2, as every corner is at least at its own position
+
+	// ----- Pass 1: Triangle normals and corner weights -----
+	// Note: We use a plain array rather than a vector so the (large) array isn't zeroed first, as every triangle gets written anyway
+	std::unique_ptr<SmoothNormalTriangle[]> triangles(new SmoothNormalTriangle[numTriangles]);
+	parallelForRanges(numTriangles, PARALLEL_NORMALS_MIN_TRIANGLES, [&](size_t begin, size_t end)
+	{
+		size_t triangleNum = begin;
+
+#ifdef MESH_OPTIMISER_USE_SSE
+		// Four triangles at a time with each of x, y and z in its own register
+		for (; triangleNum + 4 <= end; triangleNum += 4)
+		{
+			const GLuint* triangle = &indices[triangleNum * 3];
+			const vec3* v0[4] = { &positions[triangle[0]], &positions[triangle[3]], &positions[triangle[6]], &positions[triangle[9]]  };
+			const vec3* v1[4] = { &positions[triangle[1]], &positions[triangle[4]], &positions[triangle[7]], &positions[triangle[10]] };
+			const vec3* v2[4] = { &positions[triangle[2]], &positions[triangle[5]], &positions[triangle[8]], &positions[triangle[11]] };
+
+			__m128 v0x = _mm_setr_ps(v0[0]->x, v0[1]->x, v0[2]->x, v0[3]->x), v0y = _mm_setr_ps(v0[0]->y, v0[1]->y, v0[2]->y, v0[3]->y), v0z = _mm_setr_ps(v0[0]->z, v0[1]->z, v0[2]->z, v0[3]->z);
+			__m128 v1x = _mm_setr_ps(v1[0]->x, v1[1]->x, v1[2]->x, v1[3]->x), v1y = _mm_setr_ps(v1[0]->y, v1[1]->y, v1[2]->y, v1[3]->y), v1z = _mm_setr_ps(v1[0]->z, v1[1]->z, v1[2]->z, v1[3]->z);
+			__m128 v2x = _mm_setr_ps(v2[0]->x, v2[1]->x, v2[2]->x, v2[3]->x), v2y = _mm_setr_ps(v2[0]->y, v2[1]->y, v2[2]->y, v2[3]->y), v2z = _mm_setr_ps(v2[0]->z, v2[1]->z, v2[2]->z, v2[3]->z);
+
+			__m128 e01x = _mm_sub_ps(v1x, v0x), e01y = _mm_sub_ps(v1y, v0y), e01z = _mm_sub_ps(v1z, v0z);
+			__m128 e02x = _mm_sub_ps(v2x, v0x), e02y = _mm_sub_ps(v2y, v0y), e02z = _mm_sub_ps(v2z, v0z);
+			__m128 e12x = _mm_sub_ps(v2x, v1x), e12y = _mm_sub_ps(v2y, v1y), e12z = _mm_sub_ps(v2z, v1z);
+
+			auto dot = [](__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+			{
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+			};
+
+			// The cross product of the two edges from v0
+			__m128 nx = _mm_sub_ps(_mm_mul_ps(e01y, e02z), _mm_mul_ps(e01z, e02y));
+			__m128 ny = _mm_sub_ps(_mm_mul_ps(e01z, e02x), _mm_mul_ps(e01x, e02z));
+			__m128 nz = _mm_sub_ps(_mm_mul_ps(e01x, e02y), _mm_mul_ps(e01y, e02x));
+
+			__m128 normalLength = _mm_sqrt_ps( dot(nx, ny, nz, nx, ny, nz) );
+			__m128 length01     = _mm_sqrt_ps( dot(e01x, e01y, e01z, e01x, e01y, e01z) );
+			__m128 length02     = _mm_sqrt_ps( dot(e02x, e02y, e02z, e02x, e02y, e02z) );
+			__m128 length12     = _mm_sqrt_ps( dot(e12x, e12y, e12z, e12x, e12y, e12z) );
+
+			const __m128 minimumDenominator = _mm_set1_ps( std::numeric_limits<float>::min() );
+			const __m128 minusOne = _mm_set1_ps(-1.0f), one = _mm_set1_ps(1.0f);
+			auto clampedCos = [&](__m128 dotProduct, __m128 lengthProduct)
+			{
+				return _mm_min_ps(_mm_max_ps(_mm_div_ps(dotProduct, _mm_max_ps(lengthProduct, minimumDenominator)), minusOne), one);
+			};
+			__m128 cos0 = clampedCos(dot(e01x, e01y, e01z, e02x, e02y, e02z), _mm_mul_ps(length01, length02));
+			__m128 cos1 = clampedCos(_mm_sub_ps(_mm_setzero_ps(), dot(e01x, e01y, e01z, e12x, e12y, e12z)), _mm_mul_ps(length01, length12));
+			__m128 cos2 = clampedCos(dot(e02x, e02y, e02z, e12x, e12y, e12z), _mm_mul_ps(length02, length12));
+
+			__m128 inverseLength = _mm_div_ps(one, _mm_max_ps(normalLength, minimumDenominator));
+			alignas(16) float results[6][4];
+			_mm_store_ps(results[0], _mm_mul_ps(nx, inverseLength));
+			_mm_store_ps(results[1], _mm_mul_ps(ny, inverseLength));
+			_mm_store_ps(results[2], _mm_mul_ps(nz, inverseLength));
+			_mm_store_ps(results[3], _mm_mul_ps(normalLength, approximateAcos(cos0)));
+			_mm_store_ps(results[4], _mm_mul_ps(normalLength, approximateAcos(cos1)));
+			_mm_store_ps(results[5], _mm_mul_ps(normalLength, approximateAcos(cos2)));
+
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				SmoothNormalTriangle &result = triangles[triangleNum + lane];
+				result.unitNormal       = vec3(results[0][lane], results[1][lane], results[2][lane]);
+				result.cornerWeights[0] = results[3][lane];
+				result.cornerWeights[1] = results[4][lane];
+				result.cornerWeights[2] = results[5][lane];
+			}
+		}
+#endif
+
+		// Any triangles left over one at a time
+		for (; triangleNum < end; ++triangleNum)
+		{
+			const GLuint* triangle = &indices[triangleNum * 3];
+			const vec3 &v0 = positions[triangle[0]], &v1 = positions[triangle[1]], &v2 = positions[triangle[2]];
+			getSmoothNormalTriangle(v1 - v0, v2 - v0, v2 - v1, triangles[triangleNum]);
+		}
+	});
+
+	// ----- Build the table of the corners at each position -----
+	// Note: This is a counting sort of the corners by position, so each position's corners are in the order they appear in the indices. Each
+	//       block of corners is counted into its own histogram, which we turn into the place each block starts writing each position's corners -
+	//       so every corner is only read twice in all, and no two threads ever write to the same count or the same place in the table.
+	// Also: Every histogram has a count for each position, so we cap the number of blocks to keep all of them together within twice the size of
+	//       the table itself. A mesh with few corners per position (or a machine with many cores) uses fewer blocks than threads rather than
+	//       needing far more memory for the counts than for the corners.
+	const size_t   minCornersPerBlock    = PARALLEL_NORMALS_MIN_TRIANGLES * 3;
+	const size_t   minPositionsPerThread = PARALLEL_NORMALS_MIN_TRIANGLES / 2;
+	const size_t   maxBlockCountsSize    = numCorners * 2;
+	const size_t   numBlocks             = std::min( getParallelThreadCount(numCorners, minCornersPerBlock), std::max<size_t>(1, maxBlockCountsSize / std::max<size_t>(1, numPositions)) );
+	auto           blockBegin            = [&](size_t block) { return numCorners * block / numBlocks; };
+	vector<GLuint> blockCounts(numBlocks * numPositions, 0);
+	parallelForRanges(numBlocks, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t block = begin; block < end; ++block)
+		{
+			GLuint* counts = blockCounts.data() + block * numPositions;
+			for (size_t corner = blockBegin(block); corner < blockBegin(block + 1); ++corner)
+			{
+				++counts[ indices[corner] ];
+			}
+		}
+	});
+
+	// Add up each position's corners across the blocks, then make that into where each position's corners start
+	vector<GLuint> positionCornerStart(numPositions + 1, 0);
+	parallelForRanges(numPositions, minPositionsPerThread, [&](size_t begin, size_t end)
+	{
+		for (size_t position = begin; position < end; ++position)
+		{
+			for (size_t block = 0; block < numBlocks; ++block)
+			{
+				positionCornerStart[position + 1] += blockCounts[block * numPositions + position];
+			}
+		}
+	});
+	for (size_t loop = 0; loop < numPositions; ++loop)
+	{
+		positionCornerStart[loop + 1] += positionCornerStart[loop];
+	}
+
+	// Turn each block's counts into where it writes its first corner at each position - straight after the earlier blocks' corners there
+	parallelForRanges(numPositions, minPositionsPerThread, [&](size_t begin, size_t end)
+	{
+		for (size_t position = begin; position < end; ++position)
+		{
+			GLuint cursor = positionCornerStart[position];
+			for (size_t block = 0; block < numBlocks; ++block)
+			{
+				GLuint &count = blockCounts[block * numPositions + position];
+				GLuint blockCornerCount = count;
+				count   = cursor;
+				cursor += blockCornerCount;
+			}
+		}
+	});
+
+	std::unique_ptr<GLuint[]> positionCorners(new GLuint[numCorners]);
+	parallelForRanges(numBlocks, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t block = begin; block < end; ++block)
+		{
+			GLuint* cursors = blockCounts.data() + block * numPositions;
+			for (size_t corner = blockBegin(block); corner < blockBegin(block + 1); ++corner)
+			{
+				positionCorners[ cursors[ indices[corner] ]++ ] = static_cast<GLuint>(corner);
+			}
+		}
+	});
+
+	// ----- Pass 2: Gather the triangle normals around each position into its corners -----
+	const bool  smoothEverything = (creaseAngleDegs >= NO_CREASE_ANGLE_DEGS);
+	const float creaseCos        = std::cos( glm::radians( glm::clamp(creaseAngleDegs, 0.0f, NO_CREASE_ANGLE_DEGS) ) );
+	parallelForRanges(numPositions, minPositionsPerThread, [&](size_t begin, size_t end)
+	{
+		for (size_t position = begin; position < end; ++position)
+		{
+			const GLuint* cornersBegin = positionCorners.get() + positionCornerStart[position];
+			const GLuint* cornersEnd   = positionCorners.get() + positionCornerStart[position + 1];
+
+			// The normal with no creases - every corner at this position gets it if we're smoothing everything, or uses it as a fallback otherwise
+			vec3 smoothSum(0.0f);
+			for (const GLuint* corner = cornersBegin; corner < cornersEnd; ++corner)
+			{
+				const SmoothNormalTriangle &triangle = triangles[*corner / 3];
+				smoothSum += triangle.unitNormal * triangle.cornerWeights[*corner % 3];
+			}
+			float smoothLength = glm::length(smoothSum);
+			vec3  smoothNormal = (smoothLength > 0.0f) ? smoothSum / smoothLength : vec3(0.0f, 1.0f, 0.0f);
+
+			for (const GLuint* corner = cornersBegin; corner < cornersEnd; ++corner)
+			{
+				if (smoothEverything)
+				{
+					cornerNormals[*corner] = smoothNormal;
+					continue;
+				}
+
+				// Only take in the triangles which meet this corner's triangle at less than the crease angle, and always its own triangle (rounding could leave
+				// a triangle's normal dotted with itself just under a crease cosine of 1)
+				const vec3 &cornerTriangleNormal = triangles[*corner / 3].unitNormal;
+				vec3 sum(0.0f);
+				for (const GLuint* other = cornersBegin; other < cornersEnd; ++other)
+				{
+					const SmoothNormalTriangle &triangle = triangles[*other / 3];
+					if (*other / 3 == *corner / 3 || glm::dot(cornerTriangleNormal, triangle.unitNormal) >= creaseCos)
+					{
+						sum += triangle.unitNormal * triangle.cornerWeights[*other % 3];
+					}
+				}
+				float length = glm::length(sum);
+				cornerNormals[*corner] = (length > 0.0f) ? sum / length : smoothNormal;
+			}
+		}
+	});
+}
@@ -1,34 +1,56 @@
 #include "Model.h"
+#include "Frustum.h"
+#include "glm/gtc/matrix_transform.hpp" // Needed for scale
+
+#include <charconv>   // Needed for from_chars
+#include <chrono>     // Needed to time how long loading takes
+#include <thread>     // Needed to parse model files in parallel
+#include <filesystem> // Needed to key the mesh cache on the model file's size and modification time
+#include <unordered_map>
+#include <cmath>      // Needed for acos when measuring quantisation error
+#include <limits>     // Needed for numeric_limits
+
+// Use SSE to transform vertices four at a time where it's available - it's part of the baseline for every x86-64 compiler
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define MODEL_USE_SSE
+	#include <xmmintrin.h>
+#endif
 
 // Private method to initialise or re-initialise a model
 void Model::initModel()
 {
 	// Free model vector memory if required
-	if (vertices      != 0) { delete vertices;      }
-	if (normals       != 0) { delete normals;       }
-	if (normalIndices != 0) { delete normalIndices; }
-	if (texCoords     != 0) { delete texCoords;     }
-	if (faces         != 0) { delete faces;         }
+	if (vertices    != 0) { delete vertices;    }
+	if (normals     != 0) { delete normals;     }
+	if (texCoords   != 0) { delete texCoords;   }
+	if (faceCorners != 0) { delete faceCorners; }
 
 	// Free model data memory if required
-	if (vertexData   != 0)  { delete vertexData;    }
-	if (normalData   != 0)  { delete normalData;    }
-	if (texCoordData != 0)  { delete texCoordData;  }
-	if (faceData     != 0)  { delete faceData;      }
+	freeDataArrays();
+	interleavedData.clear();
+	quantisedData.clear();
+	lods.clear();
+	meshlets.clear();
+	submeshes.clear();
+	materialLibraryFilenames.clear();
+
+	// Every model has the default material, even if it doesn't use any others
+	materials.assign(1, Material());
 
 	// Create new vectors
-	vertices      = new vector<vec3>(); // Vector of vertex data
-	normals       = new vector<vec3>(); // Vector of normal data
-	normalIndices = new vector<vec3>(); // Vector of normal indices to deal with f v1//n1 v2//n2 v3//n3 data
-	texCoords     = new vector<vec3>(); // Vector of texture coordinates
-	faces         = new vector<vec3>(); // Vector of faces, consists of 3 vertex indices
+	vertices    = new vector<vec3>();    // Vector of vertex data
+	normals     = new vector<vec3>();    // Vector of normal data
+	texCoords   = new vector<vec2>();    // Vector of texture coordinates
+	faceCorners = new vector<WeldKey>(); // Vector of face corners, every 3 of which make a triangle
 
-	// Our vectors of attributes are initially empty
+	// Our vectors of attributes are initially empty, and we assume we'll need 32-bit indices until we know otherwise
+	faceIndexType    = GL_UNSIGNED_INT;
 	numVertices      = 0;
 	numNormals       = 0;
 	numNormalIndices = 0;
 	numTexCoords     = 0;
 	numFaces         = 0;
+	parseTimeMs      = 0.0;
 
 	// Model data pointers initially point at nothing
 	vertexData   = 0;
@@ -37,11 +59,38 @@ void Model::initModel()
 	faceData     = 0;
 }
 
+// Private method to free our data arrays
+// Note: If the data arrays point into a mapped mesh cache file then we just unmap the file instead.
+void Model::freeDataArrays()
+{
+	if (dataIsMapped)
+	{
+		meshCacheFile.close();
+		dataIsMapped = false;
+	}
+	else
+	{
+		if (vertexData   != 0)  { delete[] vertexData;   }
+		if (normalData   != 0)  { delete[] normalData;   }
+		if (texCoordData != 0)  { delete[] texCoordData; }
+		if (faceData     != 0)  { delete[] faceData;     }
+	}
+
+	vertexData   = 0;
+	normalData   = 0;
+	texCoordData = 0;
+	faceData     = 0;
+}
+
 // Simple helper functions to determine information about our model
-bool Model::hasVertices()      { return numVertices      > 0; }
-bool Model::hasFaces()         { return numFaces         > 0; }
-bool Model::hasNormals()       { return numNormals       > 0; }
-bool Model::hasNormalIndices() { return numNormalIndices > 0; }
+bool Model::hasVertices() const      { return numVertices      > 0; }
+bool Model::hasFaces() const         { return numFaces         > 0; }
+bool Model::hasNormals() const       { return numNormals       > 0; }
+bool Model::hasNormalIndices() const { return numNormalIndices > 0; }
+bool Model::hasTexCoords() const     { return numTexCoords     > 0; }
+
+// Private method to find out whether every face corner has a normal we can use - if not then we generate normals for the whole model
+bool Model::everyFaceHasNormals() const { return hasNormals() && hasFaces() && numNormalIndices == numFaces; }
 
 // Constructor
 Model::Model(DrawingMethod theDrawingMethod)
@@ -58,74 +107,17 @@ Model::Model(string filename, DrawingMethod theDrawingMethod)
 	load(filename);
 }
 
-// Copy constructor to create deep copies of model objects
-// Note: We only deep copy the vertexData and normalData arrays, not all the vectors!
-// Usage: Model myNewModel(someExistingModel); // Easy as!
-Model::Model(Model &source)
-{
-	initModel();
-
-	numVertices      = source.numVertices;
-	numNormals       = source.numNormals;
-	numNormalIndices = source.numNormalIndices;
-	numTexCoords     = source.numTexCoords;
-	numFaces         = source.numFaces;
-	drawingMethod    = source.drawingMethod;
-
-    int tvertDataSize = source.getVertexDataSizeBytes();
-    int tnumVertices = tvertDataSize / (3 * sizeof(GLfloat));
-    cout << "vertexData size is: " << tvertDataSize << endl;
-    cout << "num vertices is: " << tnumVertices << endl;
-
-    int tnormDataSize = source.getNormalDataSizeBytes();
-    int tnumNormals = tnormDataSize / (3 * sizeof(GLfloat));
-    cout << "vertexData size is: " << tnormDataSize << endl;
-    cout << "num normals is: " << tnumNormals << endl;
-
-
-	// If we have vertex data then allocate space for it and copy the data from the source model
-	if (numVertices > 0)
-	{
-		vertexData = new float[numVertices * 3];
-		memcpy(vertexData, source.getVertexData(), source.getVertexDataSizeBytes() );
-	}
-	else
-	{
-		cout << "Model created using copy constructor has 0 vertices!" << endl;
-		exit(-1);
-	}
-
-	// If we have normal data then allocate space for it and copy the data from the source model
-	if (numNormals > 0)
-	{
-		normalData = new float[numNormals * 3];
-		memcpy(normalData, source.getNormalData(), source.getNormalDataSizeBytes() );
-	}
-	else
-	{
-		cout << "Model created using copy constructor has 0 normals!" << endl;
-		exit(-1);
-	}
-
-	cout << "Model successfully created through copy constructor." << endl;
-}
-
-
 // Destructor - frees our allocated pointer memory
 Model::~Model()
 {
 	// Because vectors are quirky we have to clear the vector, shrink it and THEN delete it to free the memory used.
-	if (vertices      != 0) { vertices->clear();      vertices->shrink_to_fit();      delete vertices;      }
-	if (normals       != 0) { normals->clear();       normals->shrink_to_fit();       delete normals;       }
-	if (normalIndices != 0) { normalIndices->clear(); normalIndices->shrink_to_fit(); delete normalIndices; }
-	if (texCoords     != 0) { texCoords->clear();     texCoords->shrink_to_fit();     delete texCoords;     }
-	if (faces         != 0) { faces->clear();         faces->shrink_to_fit();         delete faces;         }
+	if (vertices    != 0) { vertices->clear();    vertices->shrink_to_fit();    delete vertices;    }
+	if (normals     != 0) { normals->clear();     normals->shrink_to_fit();     delete normals;     }
+	if (texCoords   != 0) { texCoords->clear();   texCoords->shrink_to_fit();   delete texCoords;   }
+	if (faceCorners != 0) { faceCorners->clear(); faceCorners->shrink_to_fit(); delete faceCorners; }
 
 	// Free model data memory if required
-	if (vertexData   != 0)  { delete[] vertexData;   }
-	if (normalData   != 0)  { delete[] normalData;   }
-	if (texCoordData != 0)  { delete[] texCoordData; }
-	if (faceData     != 0)  { delete[] faceData;     }
+	freeDataArrays();
 }
 
 // Method to load a model
@@ -134,8 +126,17 @@ void Model::load(string filename)
 	// Re-initialise our model
 	initModel();
 
-	// Load the model file
+	// If we have an up-to-date binary mesh cache for this model then we can skip parsing entirely
+	if ( useMeshCache && loadMeshCache(filename) )
+	{
+		return;
+	}
+
+	// Load the model file, timing how long the parse takes
+	auto parseStartTime = std::chrono::steady_clock::now();
 	bool modelLoadedCleanly = readModelFile(filename);
+	std::chrono::duration<double, std::milli> parseDuration = std::chrono::steady_clock::now() - parseStartTime;
+	parseTimeMs = parseDuration.count();
 
 	if (modelLoadedCleanly)
 	{
@@ -152,436 +153,1650 @@ void Model::load(string filename)
 	}
 	else
 	{
-		cout << "Model has no vertices - exiting." << endl;
-		exit(-1);
+		cout << "Model has no vertices - it can't be used." << endl;
+		return;
 	}
 
-	if ( hasFaces() )         { cout << "Face count: " << getNumFaces() << endl;                 }
-	if ( hasNormals() )	      { cout << "Normal count: " << getNumNormals() << endl;             }
-	if ( hasNormalIndices() ) {	cout << "Normal index count: " << getNumNormalIndices() << endl; }
+	if ( hasFaces() )         { cout << "Face count: " << getNumFaces() << endl;                      }
+	if ( hasNormals() )	      { cout << "Normal count: " << getNumNormals() << endl;                  }
+	if ( hasNormalIndices() ) {	cout << "Normal index count: " << getNumNormalIndices() << endl;      }
+	if ( hasTexCoords() )     { cout << "Texture coordinate count: " << getNumTexCoords() << endl;    }
+	if (materials.size() > 1) { cout << "Material count: " << getMaterialCount() << endl;             }
+	cout << "Parse time: " << parseDuration.count() << "ms" << endl;
 
 	// Transfer the loaded data in our vectors to the data arrays
 	setupData();
-}
 
+	// Only cache models which loaded without problems so that a fixed source file always gets re-parsed
+	if (useMeshCache && modelLoadedCleanly)
+	{
+		saveMeshCache(filename);
+	}
+}
 
-// Method to read through the model file adding all vertices, faces and normals to our
-// vertices, faces and normals vectors.
-// Note: This does NOT transfer the data into our vertexData, faceData or normalData arrays!
-//       That must be done as a separate step by calling setupData() after building up the
-//       vectors with this method!
-// Also: This method does not decrement the face number of normal index by 1 (because .OBJ
-//       files start their counts at 1) to put them in a range starting from 0, that job
-//       is done in the setupData() method performed after calling this method!
-bool Model::readModelFile(string filename)
+// Private method to fill in the key part of a mesh cache header for a model file
+bool Model::getMeshCacheKey(string filename, MeshCacheHeader &header)
 {
-	bool loadedCleanly = true;
+	std::error_code error;
+	std::filesystem::path sourcePath(filename);
+
+	uintmax_t sourceSize = std::filesystem::file_size(sourcePath, error);
+	if (error) { return false; }
 
-	// Open the model file to read from
-	ifstream file( filename.c_str() );
+	std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(sourcePath, error);
+	if (error) { return false; }
 
-	if (!file.good() )
+	// FNV-1a hash of the canonical source path so that two different files never share a key
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(sourcePath, error);
+	string pathString = error ? filename : canonicalPath.generic_string();
+	uint64_t pathHash = 14695981039346656037ull;
+	for (unsigned char c : pathString)
 	{
-		std::cerr << "Failed to open model file: " << filename << endl;
-		exit(-1);
+		pathHash ^= c;
+		pathHash *= 1099511628211ull;
 	}
 
-	// Read the file line by line, extracting data into the correct arrays
-	string tempLine;
-	int lineCount = 0;
-	while ( file.good() )
-	{
-		getline(file, tempLine);        // Read a line from the file
+	memset(&header, 0, sizeof(MeshCacheHeader));
+	memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+	header.version            = MESH_CACHE_VERSION;
+	header.drawingMethod      = static_cast<uint32_t>(drawingMethod);
+	header.sourcePathHash     = pathHash;
+	header.sourceSizeBytes    = static_cast<uint64_t>(sourceSize);
+	header.sourceModifiedTime = static_cast<int64_t>( modifiedTime.time_since_epoch().count() );
 
-		lineCount++;
+	// The crease angle changes the normals we generate for models which don't have any (we can't tell if that's this model without parsing it)
+	header.smoothNormalCreaseAngleDegs = smoothNormalCreaseAngleDegs;
 
-		// If the line isn't empty, process it...
-		if (tempLine.length() > 1)
+	// Optimising the vertex order changes the face data, so the cache is only valid for the same optimisation settings
+	if (drawingMethod == DRAWING_AS_ELEMENTS && optimiseVertexOrder)
+	{
+		header.optimisationFlags |= MESH_CACHE_VERTEX_ORDER_OPTIMISED;
+		if (optimiseOverdraw)
 		{
-			istringstream iss(tempLine);    // Convert the string into a stringstream for easy separation
-
-			vector<string> tokens;          // Create a vector of strings to hold the separate elements of the line
-
-			// Actually perform the separation of elements and place them in the tokens vector
-			copy( istream_iterator<string>(iss), istream_iterator<string>(), back_inserter< vector<string> >(tokens) );
-
-			// Start at the beginning of the vector of tokens
-			vector<string>::iterator iter = tokens.begin();
-
-			// If the first token is "v", then we're dealing with vertex data
-			if (*iter == "v")
-			{
-				// As long as there's 4 tokens on the line...
-				if (tokens.size() == 4)
-				{
-					// ...get them as floats ...
-					iter++;
-					float x = atof( (*iter).c_str() );
+			header.optimisationFlags    |= MESH_CACHE_OVERDRAW_OPTIMISED;
+			header.overdrawAcmrThreshold = overdrawAcmrThreshold;
+		}
+	}
 
-					iter++;
-					float y = atof( (*iter).c_str() );
+	// ...and likewise for the levels of detail we generate
+	if (drawingMethod == DRAWING_AS_ELEMENTS && generateLods)
+	{
+		uint32_t lodHash = 2166136261u;
+		for (float ratio : lodTriangleRatios)
+		{
+			uint32_t ratioBits;
+			memcpy(&ratioBits, &ratio, sizeof(ratioBits));
+			lodHash = (lodHash ^ ratioBits) * 16777619u;
+		}
+		header.lodSettingsHash = lodHash;
+	}
+	if (drawingMethod == DRAWING_AS_ELEMENTS && buildMeshlets)
+	{
+		header.optimisationFlags |= MESH_CACHE_MESHLETS_BUILT;
+	}
+	return true;
+}
 
-					iter++;
-					float z = atof( (*iter).c_str() );
+// Private method to hash the paths, sizes and modification times of the material libraries a model uses.
+// Note: A library we can't find still goes into the hash (as a size and time of zero), so we notice if it turns up later.
+uint64_t Model::getMaterialLibrariesHash(const vector<string> &libraryFilenames)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto hashBytes = [&hash](const void* data, size_t sizeBytes)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t loop = 0; loop < sizeBytes; ++loop)
+		{
+			hash ^= bytes[loop];
+			hash *= 1099511628211ull;
+		}
+	};
 
-					// ... and push them into the vertices vector ...
-					vertices->push_back( vec3(x, y, z) );
+	for (const string &libraryFilename : libraryFilenames)
+	{
+		std::error_code sizeError, timeError;
+		uint64_t sizeBytes    = static_cast<uint64_t>( std::filesystem::file_size(libraryFilename, sizeError) );
+		int64_t  modifiedTime = static_cast<int64_t>( std::filesystem::last_write_time(libraryFilename, timeError).time_since_epoch().count() );
+		if (sizeError) { sizeBytes    = 0; }
+		if (timeError) { modifiedTime = 0; }
+
+		hashBytes(libraryFilename.data(), libraryFilename.size() + 1); // Note: Including the terminating zero, so "ab" + "c" doesn't hash the same as "a" + "bc"
+		hashBytes(&sizeBytes,    sizeof(sizeBytes));
+		hashBytes(&modifiedTime, sizeof(modifiedTime));
+	}
+	return hash;
+}
 
-					// .. then increase our vertex count.
-					numVertices++;
-				}
-				else // If we got vertex data without 3 components - whine!
-				{
-					loadedCleanly = false;
-					cout << "Found vertex data with wrong component count at line number: " << lineCount << " - Skipping!" << endl;
-				}
+// Private method to pack our materials and the filenames of our material libraries into a block of mesh cache data
+vector<char> Model::packMaterialData()
+{
+	vector<char> data;
+	auto append = [&data](const void* bytes, size_t sizeBytes) { data.insert(data.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + sizeBytes); };
 
-			} // End of vertex line parsing
+	for (const Material &material : materials)
+	{
+		CachedMaterial cached;
+		memcpy(cached.ambientColour,  &material.ambientColour[0],  sizeof(cached.ambientColour));
+		memcpy(cached.diffuseColour,  &material.diffuseColour[0],  sizeof(cached.diffuseColour));
+		memcpy(cached.specularColour, &material.specularColour[0], sizeof(cached.specularColour));
+		cached.specularPower         = material.specularPower;
+		cached.opacity               = material.opacity;
+		cached.nameLength            = static_cast<uint32_t>( material.name.size() );
+		cached.textureFilenameLength = static_cast<uint32_t>( material.diffuseTextureFilename.size() );
+		append(&cached, sizeof(CachedMaterial));
+		append(material.name.data(), material.name.size());
+		append(material.diffuseTextureFilename.data(), material.diffuseTextureFilename.size());
+	}
+	for (const string &libraryFilename : materialLibraryFilenames)
+	{
+		uint32_t length = static_cast<uint32_t>( libraryFilename.size() );
+		append(&length, sizeof(length));
+		append(libraryFilename.data(), libraryFilename.size());
+	}
+	return data;
+}
 
-			// If the first token is "vn", then we're dealing with normal data
-			if (*iter == "vn")
-			{
-				// As long as there's 4 tokens on the line...
-				if (tokens.size() == 4)
-				{
-					// ...get them as floats ...
-					iter++;
-					float normalX = atof( (*iter).c_str() );
+// Private method to unpack materials and material library filenames from a block of mesh cache data. Returns false if the data is malformed.
+bool Model::unpackMaterialData(const char* data, size_t sizeBytes, GLuint numMaterials, GLuint numLibraries, vector<Material> &materialsOut, vector<string> &librariesOut)
+{
+	size_t position = 0;
+	auto read = [&](void* destination, size_t readBytes)
+	{
+		if (readBytes > sizeBytes - position) { return false; }
+		memcpy(destination, data + position, readBytes);
+		position += readBytes;
+		return true;
+	};
+	auto readString = [&](string &destination, size_t length)
+	{
+		if (length > sizeBytes - position) { return false; }
+		destination.assign(data + position, length);
+		position += length;
+		return true;
+	};
+
+	materialsOut.resize(numMaterials);
+	for (Material &material : materialsOut)
+	{
+		CachedMaterial cached;
+		if ( !read(&cached, sizeof(CachedMaterial)) || !readString(material.name, cached.nameLength) || !readString(material.diffuseTextureFilename, cached.textureFilenameLength) )
+		{
+			return false;
+		}
+		material.ambientColour  = vec3(cached.ambientColour[0],  cached.ambientColour[1],  cached.ambientColour[2]);
+		material.diffuseColour  = vec3(cached.diffuseColour[0],  cached.diffuseColour[1],  cached.diffuseColour[2]);
+		material.specularColour = vec3(cached.specularColour[0], cached.specularColour[1], cached.specularColour[2]);
+		material.specularPower  = cached.specularPower;
+		material.opacity        = cached.opacity;
+	}
 
-					iter++;
-					float normalY = atof( (*iter).c_str() );
+	librariesOut.resize(numLibraries);
+	for (string &libraryFilename : librariesOut)
+	{
+		uint32_t length;
+		if ( !read(&length, sizeof(length)) || !readString(libraryFilename, length) )
+		{
+			return false;
+		}
+	}
+	return position == sizeBytes;
+}
 
-					iter++;
-					float normalZ = atof( (*iter).c_str() );
+// Method to load our data arrays straight from the binary mesh cache for a model file.
+// Note: The cache file is memory-mapped and our data arrays point directly into the mapping, so there's no parsing and no
+//       copying - the pages get read in as they're used (i.e. when the data is handed to glBufferData).
+// Also: The mapping is private, so modifying the data arrays (e.g. by scaling the model) never changes the cache file.
+bool Model::loadMeshCache(string filename)
+{
+	MeshCacheHeader expected;
+	if ( !getMeshCacheKey(filename, expected) )
+	{
+		return false;
+	}
 
-					// ... and push them into the normals vector ...
-					normals->push_back( vec3(normalX, normalY, normalZ) );
+	MappedFile cacheFile( getMeshCacheFilename(filename) );
+	if ( !cacheFile.isOpen() || cacheFile.size() < sizeof(MeshCacheHeader) )
+	{
+		return false;
+	}
 
-					// .. then increase our normal count.
-					numNormals++;
-				}
-				else // If we got vertex data without 3 components - whine!
-				{
-					loadedCleanly = false;
-					cout << "Found normal data with wrong component count at line number: " << lineCount << " - Skipping!" << endl;
-				}
+	// The header must match our key exactly and describe streams that actually fit in the file
+	MeshCacheHeader header;
+	memcpy(&header, cacheFile.data(), sizeof(MeshCacheHeader));
+	bool keyMatches = memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 &&
+		header.version                     == expected.version                     &&
+		header.drawingMethod               == expected.drawingMethod               &&
+		header.optimisationFlags           == expected.optimisationFlags           &&
+		header.overdrawAcmrThreshold       == expected.overdrawAcmrThreshold       &&
+		header.smoothNormalCreaseAngleDegs == expected.smoothNormalCreaseAngleDegs &&
+		header.lodSettingsHash             == expected.lodSettingsHash             &&
+		header.sourcePathHash              == expected.sourcePathHash              &&
+		header.sourceSizeBytes             == expected.sourceSizeBytes             &&
+		header.sourceModifiedTime          == expected.sourceModifiedTime          &&
+		header.fileSizeBytes               == cacheFile.size();
+
+	auto faceIndicesInCache = [](const MeshCacheHeader &h) { return (h.drawingMethod == DRAWING_AS_ELEMENTS) ? h.numFaceIndices : 0u; };
+	auto streamFits = [&](uint64_t offset, uint64_t sizeBytes)
+	{
+		return (sizeBytes == 0) || (offset % MESH_CACHE_ALIGNMENT == 0 && offset >= sizeof(MeshCacheHeader) && offset + sizeBytes <= cacheFile.size());
+	};
+	if ( !keyMatches ||
+	     header.numVertices == 0 ||
+	     !streamFits(header.vertexDataOffset, uint64_t(header.numVertices) * 3 * sizeof(GLfloat)) ||
+	     !streamFits(header.normalDataOffset, uint64_t(header.numNormals)  * 3 * sizeof(GLfloat)) ||
+	     !streamFits(header.texCoordDataOffset, uint64_t(header.numTexCoords) * 2 * sizeof(GLfloat)) ||
+	     (header.faceIndexType != GL_UNSIGNED_SHORT && header.faceIndexType != GL_UNSIGNED_INT) ||
+	     !streamFits(header.faceDataOffset,   uint64_t(faceIndicesInCache(header)) * (header.faceIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint))) ||
+	     !streamFits(header.lodDataOffset,    uint64_t(header.numLods) * sizeof(LodLevel)) ||
+	     !streamFits(header.meshletDataOffset, uint64_t(header.numMeshlets) * sizeof(MeshOptimiser::Meshlet)) ||
+	     !streamFits(header.submeshDataOffset, uint64_t(header.numSubmeshes) * sizeof(Submesh)) ||
+	     !streamFits(header.materialDataOffset, header.materialDataSizeBytes) )
+	{
+		cout << "Mesh cache for " << filename << " is stale or invalid - re-parsing model." << endl;
+		return false;
+	}
 
-			} // End of vertex line parsing
+	// Copy out the level of detail table, making sure every level lies within the face data
+	vector<LodLevel> cachedLods(header.numLods);
+	if (header.numLods > 0)
+	{
+		memcpy(cachedLods.data(), cacheFile.data() + header.lodDataOffset, header.numLods * sizeof(LodLevel));
+	}
+	for (const LodLevel &lod : cachedLods)
+	{
+		if (uint64_t(lod.firstIndex) + lod.indexCount > faceIndicesInCache(header))
+		{
+			cout << "Mesh cache for " << filename << " has invalid levels of detail - re-parsing model." << endl;
+			return false;
+		}
+	}
 
+	// ...and likewise the meshlet table, making sure every meshlet lies within the full detail indices
+	vector<MeshOptimiser::Meshlet> cachedMeshlets(header.numMeshlets);
+	if (header.numMeshlets > 0)
+	{
+		memcpy(cachedMeshlets.data(), cacheFile.data() + header.meshletDataOffset, header.numMeshlets * sizeof(MeshOptimiser::Meshlet));
+	}
+	uint64_t fullDetailIndexCount = cachedLods.empty() ? faceIndicesInCache(header) : cachedLods[0].indexCount;
+	for (const MeshOptimiser::Meshlet &meshlet : cachedMeshlets)
+	{
+		if (uint64_t(meshlet.firstIndex) + uint64_t(meshlet.triangleCount) * 3 > fullDetailIndexCount)
+		{
+			cout << "Mesh cache for " << filename << " has invalid meshlets - re-parsing model." << endl;
+			return false;
+		}
+	}
 
-			// If the first token is "f", then we're dealing with faces
-			if (*iter == "f")
-			{
-				// Check if there's a double-slash in the line
-				size_t pos = tempLine.find("//");
+	// The materials must unpack cleanly, and the material libraries they came from mustn't have changed since the cache was written
+	vector<Material> cachedMaterials;
+	vector<string>   cachedLibraries;
+	if ( header.numMaterials == 0 ||
+	     !unpackMaterialData(cacheFile.data() + header.materialDataOffset, header.materialDataSizeBytes, header.numMaterials, header.numMaterialLibraries, cachedMaterials, cachedLibraries) ||
+	     getMaterialLibrariesHash(cachedLibraries) != header.materialLibrariesHash )
+	{
+		cout << "Mesh cache for " << filename << " has stale or invalid materials - re-parsing model." << endl;
+		return false;
+	}
 
-				// As long as there's four tokens on the line and they don't contain a "//"...
-				if ( (tokens.size() == 4) && (pos == string::npos) )
-				{
-					// ...get the face vertices as unsigned ints ...
-					iter++;
-					GLuint v1  = atoi( (*iter).c_str() );
+	// ...and every level of detail must have the same number of submeshes, each using a material we have and lying within the data it draws from
+	vector<Submesh> cachedSubmeshes(header.numSubmeshes);
+	if (header.numSubmeshes > 0)
+	{
+		memcpy(cachedSubmeshes.data(), cacheFile.data() + header.submeshDataOffset, header.numSubmeshes * sizeof(Submesh));
+	}
+	uint64_t submeshDataCount = (header.drawingMethod == DRAWING_AS_ELEMENTS) ? faceIndicesInCache(header) : header.numVertices;
+	bool submeshesValid = header.numSubmeshes > 0 && header.numSubmeshes % std::max<size_t>(cachedLods.size(), 1) == 0;
+	for (const Submesh &submesh : cachedSubmeshes)
+	{
+		submeshesValid = submeshesValid && submesh.materialIndex < header.numMaterials &&
+		                 uint64_t(submesh.firstIndex) + submesh.indexCount <= submeshDataCount &&
+		                 uint64_t(submesh.firstMeshlet) + submesh.meshletCount <= header.numMeshlets;
+	}
+	if (!submeshesValid)
+	{
+		cout << "Mesh cache for " << filename << " has invalid submeshes - re-parsing model." << endl;
+		return false;
+	}
 
-					iter++;
-					GLuint v2 = atoi( (*iter).c_str() );
+	// Point our data arrays into the mapped file
+	char* base = cacheFile.data();
+	numVertices  = header.numVertices;
+	numNormals   = header.numNormals;
+	numTexCoords = header.numTexCoords;
+	numFaces     = header.numFaces;
+	vertexData   = reinterpret_cast<GLfloat*>(base + header.vertexDataOffset);
+	normalData   = (numNormals   > 0) ? reinterpret_cast<GLfloat*>(base + header.normalDataOffset)   : nullptr;
+	texCoordData = (numTexCoords > 0) ? reinterpret_cast<GLfloat*>(base + header.texCoordDataOffset) : nullptr;
+	faceData     = (faceIndicesInCache(header) > 0) ? reinterpret_cast<GLubyte*>(base + header.faceDataOffset) : nullptr;
+	faceIndexType = header.faceIndexType;
+	lods          = std::move(cachedLods);
+	boundsMin            = vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	boundsMax            = vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	boundingSphereCentre = vec3(header.boundingSphereCentre[0], header.boundingSphereCentre[1], header.boundingSphereCentre[2]);
+	boundingSphereRadius = header.boundingSphereRadius;
+	meshlets      = std::move(cachedMeshlets);
+	materials     = std::move(cachedMaterials);
+	submeshes     = std::move(cachedSubmeshes);
+	materialLibraryFilenames = std::move(cachedLibraries);
+
+	meshCacheFile = std::move(cacheFile);
+	dataIsMapped  = true;
+
+	cout << "\n----- Model: " << filename << " loaded from mesh cache ----- " << endl;
+	cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
+	cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
+	return true;
+}
 
-					iter++;
-					GLuint v3 = atoi( (*iter).c_str() );
+// Method to write our data arrays to a binary mesh cache file for a model file
+// Note: We write to a temporary file and then rename it over the cache so that a partly-written cache can never be loaded.
+bool Model::saveMeshCache(string filename)
+{
+	MeshCacheHeader header;
+	if ( !getMeshCacheKey(filename, header) || !hasVertices() )
+	{
+		return false;
+	}
 
-					// ... and push them into the faces vector ...
-					faces->push_back( vec3(v1, v2, v3) );
+	// Lay out the streams one after the other, each starting on an aligned boundary
+	auto align = [](uint64_t offset) { return (offset + MESH_CACHE_ALIGNMENT - 1) & ~uint64_t(MESH_CACHE_ALIGNMENT - 1); };
+	// Note: We always store the face count, but the face data is only needed when drawing as elements
+	GLuint faceIndicesToWrite = (drawingMethod == DRAWING_AS_ELEMENTS && faceData != nullptr) ? getTotalFaceIndexCount() : 0;
+	GLuint normalsToWrite   = (normalData   != nullptr) ? numNormals   : 0;
+	GLuint texCoordsToWrite = (texCoordData != nullptr) ? numTexCoords : 0;
+	vector<char> materialData = packMaterialData();
+
+	header.numVertices        = numVertices;
+	header.numNormals         = normalsToWrite;
+	header.numTexCoords       = texCoordsToWrite;
+	header.numFaces           = numFaces;
+	header.numFaceIndices     = faceIndicesToWrite;
+	header.numLods            = static_cast<uint32_t>( lods.size() );
+	header.numMeshlets        = static_cast<uint32_t>( meshlets.size() );
+	header.numMaterials       = static_cast<uint32_t>( materials.size() );
+	header.numSubmeshes       = static_cast<uint32_t>( submeshes.size() );
+	header.numMaterialLibraries  = static_cast<uint32_t>( materialLibraryFilenames.size() );
+	header.materialLibrariesHash = getMaterialLibrariesHash(materialLibraryFilenames);
+	header.materialDataSizeBytes = materialData.size();
+	header.faceIndexType      = faceIndexType;
+	header.vertexDataOffset   = align(sizeof(MeshCacheHeader));
+	header.normalDataOffset   = align(header.vertexDataOffset   + uint64_t(numVertices)      * 3 * sizeof(GLfloat));
+	header.texCoordDataOffset = align(header.normalDataOffset   + uint64_t(normalsToWrite)   * 3 * sizeof(GLfloat));
+	header.faceDataOffset     = align(header.texCoordDataOffset + uint64_t(texCoordsToWrite) * 2 * sizeof(GLfloat));
+	header.lodDataOffset    = align(header.faceDataOffset   + uint64_t(faceIndicesToWrite) * getFaceIndexSizeBytes());
+	header.meshletDataOffset = align(header.lodDataOffset + uint64_t(lods.size()) * sizeof(LodLevel));
+	header.submeshDataOffset  = align(header.meshletDataOffset + uint64_t(meshlets.size()) * sizeof(MeshOptimiser::Meshlet));
+	header.materialDataOffset = align(header.submeshDataOffset + uint64_t(submeshes.size()) * sizeof(Submesh));
+	header.fileSizeBytes      = header.materialDataOffset + materialData.size();
+
+	// Store the bounds of the model so they're available without touching the vertex data
+	memcpy(header.boundsMin,            &boundsMin[0],            sizeof(header.boundsMin));
+	memcpy(header.boundsMax,            &boundsMax[0],            sizeof(header.boundsMax));
+	memcpy(header.boundingSphereCentre, &boundingSphereCentre[0], sizeof(header.boundingSphereCentre));
+	header.boundingSphereRadius = boundingSphereRadius;
+
+	string cacheFilename = getMeshCacheFilename(filename);
+	string tempFilename  = cacheFilename + ".tmp";
+	std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+	if ( !file.good() )
+	{
+		cout << "Could not write mesh cache file: " << cacheFilename << endl;
+		return false;
+	}
 
-					// .. then increase our face count.
-					numFaces++;
-				}
-				else if ( (tokens.size() == 4) && (pos != string::npos) ) // 4 tokens and found vertex//normal notation?
-				{
-					string token, faceToken, normalToken;
+	// Write each stream at its offset, padding with zeros up to it
+	auto writeAt = [&](uint64_t offset, const void* data, uint64_t sizeBytes)
+	{
+		static const char zeros[MESH_CACHE_ALIGNMENT] = {};
+		file.write(zeros, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+		file.write(static_cast<const char*>(data), static_cast<std::streamsize>(sizeBytes));
+	};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+	writeAt(header.vertexDataOffset, vertexData, uint64_t(numVertices)    * 3 * sizeof(GLfloat));
+	writeAt(header.normalDataOffset, normalData, uint64_t(normalsToWrite) * 3 * sizeof(GLfloat));
+	writeAt(header.texCoordDataOffset, texCoordData, uint64_t(texCoordsToWrite) * 2 * sizeof(GLfloat));
+	writeAt(header.faceDataOffset,   faceData,   uint64_t(faceIndicesToWrite) * getFaceIndexSizeBytes());
+	writeAt(header.lodDataOffset,    lods.data(), uint64_t(lods.size())       * sizeof(LodLevel));
+	writeAt(header.meshletDataOffset, meshlets.data(), uint64_t(meshlets.size()) * sizeof(MeshOptimiser::Meshlet));
+	writeAt(header.submeshDataOffset, submeshes.data(), uint64_t(submeshes.size()) * sizeof(Submesh));
+	writeAt(header.materialDataOffset, materialData.data(), materialData.size());
+	file.close();
 
-					// Get the 1st of three tokens as a string
-					iter++;
-					token = *iter;
+	std::error_code error;
+	if ( !file.fail() )
+	{
+		std::filesystem::rename(tempFilename, cacheFilename, error);
+	}
+	if ( file.fail() || error )
+	{
+		cout << "Could not write mesh cache file: " << cacheFilename << endl;
+		std::filesystem::remove(tempFilename, error);
+		return false;
+	}
 
-					// Find where the double-slash starts in that token
-					size_t faceEndPos = token.find("//");
+	cout << "Wrote mesh cache file: " << cacheFilename << " (" << header.fileSizeBytes << " bytes)" << endl;
+	return true;
+}
 
-					// Put sub-string from the start to the beginning of the double-slash into our subToken string
-					string faceToken1 = token.substr(0, faceEndPos);
-					//cout << "Got faceToken: " << faceToken1 << endl;
 
-					// Mark the start of our next subtoken
-					size_t nextTokenStartPos = faceEndPos + 2;
+// ----- .OBJ tokenising helpers -----
+// Note: These work on string_views into the memory-mapped model file so we never copy a line or a token anywhere.
 
-					// Copy from first character after the "//" to the end
-					string normalToken1 = token.substr(nextTokenStartPos);
+// Whitespace as far as splitting an .OBJ line into tokens goes (newlines have already been used to split the lines)
+static inline bool isObjWhitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
 
-					// Get the 2nd of three tokens as a string
-					iter++;
-					token = *iter;
+// Find the next whitespace separated token in [p, end) - returns where to carry on looking from, and gives back an empty token if there are no more
+static const char* nextObjToken(const char* p, const char* end, string_view &token)
+{
+	// Skip leading whitespace
+	while (p < end && isObjWhitespace(*p)) { ++p; }
 
-					// Find where the double-slash starts in that token
-					faceEndPos = token.find("//");
+	// Find the end of the token
+	const char* tokenStart = p;
+	while (p < end && !isObjWhitespace(*p)) { ++p; }
 
-					// Put sub-string from the start to the beginning of the double-slash into our subToken string
-					string faceToken2 = token.substr(0, faceEndPos);
+	token = string_view(tokenStart, static_cast<size_t>(p - tokenStart));
+	return p;
+}
 
-					// Mark the start of our next subtoken
-					nextTokenStartPos = faceEndPos + 2;
+// Split a line into whitespace separated tokens, storing up to maxTokens of them.
+// Returns the TOTAL number of tokens on the line, which may be more than we stored.
+static size_t tokeniseLine(string_view line, string_view* tokens, size_t maxTokens)
+{
+	size_t tokenCount = 0;
+	const char* p   = line.data();
+	const char* end = p + line.size();
+	string_view token;
+	while (true)
+	{
+		p = nextObjToken(p, end, token);
+		if ( token.empty() ) { break; }
 
-					// Copy from first character after the "//" to the end
-					string normalToken2 = token.substr(nextTokenStartPos);
+		if (tokenCount < maxTokens)
+		{
+			tokens[tokenCount] = token;
+		}
+		++tokenCount;
+	}
+	return tokenCount;
+}
 
-					// Get the 3rd of three tokens as a string
-					iter++;
-					token = *iter;
+// Parse a token as a float - like atof, we take the longest valid prefix and give back 0 if there isn't one
+static float parseObjFloat(string_view token)
+{
+	const char* first = token.data();
+	const char* last  = first + token.size();
 
-					// Find where the double-slash starts in that token
-					faceEndPos = token.find("//");
+	// Note: from_chars doesn't accept a leading plus sign, but atof does
+	if (first < last && *first == '+') { ++first; }
 
-					// Put sub-string from the start to the beginning of the double-slash into our subToken string
-					string faceToken3 = token.substr(0, faceEndPos);
+	// Note: We parse as a double and THEN narrow to float so we get exactly what atof would have given us
+	double value = 0.0;
+	std::from_chars(first, last, value);
+	return static_cast<float>(value);
+}
 
-					// Mark the start of our next subtoken
-					nextTokenStartPos = faceEndPos + 2;
+// Parse a face corner token ("v", "v/vt", "v//vn" or "v/vt/vn") in a single pass into its position, texture coordinate and normal indices.
+// Note: Like atoi, each index is an optional sign and then digits up to the first non-digit. Any index which isn't there is 0 (which .OBJ
+//       files never use, as their indices start at 1).
+static void parseFaceToken(string_view token, int &position, int &texCoord, int &normal)
+{
+	const char* p   = token.data();
+	const char* end = p + token.size();
 
-					// Copy from first character after the "//" to the end
-					string normalToken3 = token.substr(nextTokenStartPos);
+	int* indices[3] = { &position, &texCoord, &normal };
+	for (int part = 0; part < 3; ++part)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negative = (*p == '-');
+			++p;
+		}
 
-					// Finally, add the normal index to the normal indices vector and increment the count
-					normalIndices->push_back( vec3( atoi( normalToken1.c_str() ), atoi( normalToken2.c_str() ), atoi(normalToken3.c_str() ) ) );
-					numNormalIndices++;
+		int value = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			value = value * 10 + (*p - '0');
+			++p;
+		}
+		*indices[part] = negative ? -value : value;
 
-					// And add the face vertex number to the faces vector and increment the count
-					faces->push_back( vec3( atoi( faceToken1.c_str() ), atoi( faceToken2.c_str() ), atoi( faceToken3.c_str() ) ) );
-					numFaces++;
-				}
-				else // If we got face data without 3 components - whine!
-				{
-					loadedCleanly = false;
-					cout << "Found face data with wrong component count at line number: " << lineCount << " - Skipping!" << endl;
+		// Skip anything else up to the slash before the next part (if there is one)
+		while (p < end && *p != '/') { ++p; }
+		if (p == end)
+		{
+			for (++part; part < 3; ++part) { *indices[part] = 0; }
+			break;
+		}
+		++p;
+	}
+}
 
-				}
+// Convert an index from a face corner token into a zero-based index.
+// Note: .OBJ indices start at 1 so we subtract 1 from positive indices. Negative indices count back from the latest element read so far (-1 is
+//       the last one), but we only know how many elements there were in THIS chunk - so we give back the index relative to the start of the chunk
+//       and set isRelative, and readModelFile() adds on the number of elements in all the previous chunks once it knows it.
+// Also: A zero (i.e. missing) index gives back missingIndex.
+static GLuint getObjIndex(int index, size_t countInChunk, GLuint missingIndex, bool &isRelative)
+{
+	isRelative = (index < 0);
+	if (index > 0)
+	{
+		return static_cast<GLuint>(index - 1);
+	}
+	if (index < 0)
+	{
+		// Note: This wraps around if the index points back before the start of the chunk, and wraps back again when the chunk's offset is added
+		return static_cast<GLuint>( int64_t(countInChunk) + index );
+	}
+	return missingIndex;
+}
 
-			} // End of face line parsing
+// Method to parse the lines in the range [begin, end) of a memory-mapped .OBJ file into a chunk's own vectors.
+// Note: This is called from multiple worker threads at once, so it must only touch the chunk it's given!
+// Also: Line numbers in the chunk's warnings are relative to the start of the chunk - readModelFile() adds on
+//       the number of lines in all previous chunks when it reports them.
+// Further: Faces go straight into the chunk's list of face corners (as zero-based indices), split into triangles as they're read - so
+//          there's no separate pass over the faces afterwards to triangulate them or to match them up with their normals.
+void Model::parseObjChunk(const char* begin, const char* end, ObjChunk &chunk)
+{
+	const char* p = begin;
 
-		} // End of line parsing section
+	// Each vertex line we care about has at most 4 tokens (plus an optional w, or r/g/b colour, which we skip) - any more than that and we only need
+	// to know how many there were. Faces can have any number of corners, so we walk through their tokens ourselves.
+	constexpr size_t MAX_TOKENS = 4;
+	string_view tokens[MAX_TOKENS];
 
-	} // End of file parsing section
+	// Method to add a face corner, remembering which of its indices (if any) are relative to the start of the chunk
+	// Note: The relative attribute bits are 1 for the position, 2 for the normal and 4 for the texture coordinate, in WeldKey order.
+	auto addCorner = [&chunk](const WeldKey &corner, GLuint relativeAttributes)
+	{
+		for (size_t attribute = 0; relativeAttributes != 0; ++attribute, relativeAttributes >>= 1)
+		{
+			if (relativeAttributes & 1u)
+			{
+				chunk.relativeIndices.push_back(chunk.faceCorners.size() * 3 + attribute);
+			}
+		}
+		chunk.faceCorners.push_back(corner);
+	};
 
-	// Close the file
-	file.close();
+	while (p < end)
+	{
+		// Find the end of this line and step over it ready for the next one
+		const char* lineEnd = static_cast<const char*>( memchr(p, '\n', static_cast<size_t>(end - p)) );
+		if (lineEnd == nullptr) { lineEnd = end; }
+		string_view line(p, static_cast<size_t>(lineEnd - p));
+		p = (lineEnd < end) ? lineEnd + 1 : end;
 
-	// Return our boolean flag to say whether we loaded the model cleanly or not
-	return loadedCleanly;
-}
+		chunk.lineCount++;
 
-// Returns true if v1 can be considered equal to v2
-bool Model::is_near(float v1, float v2, float threshold) { return fabs(v1 - v2) <= threshold; }
-
-// TODO: THIS CAN BE DELETED - IT'S NOT EVEN USED!------------------------------------------------------------------------------------------------------
-// Searches through all already-exported vertices for a similar one.
-// Similar = same position + same UVs + same normal
-int Model::getSimilarVertexIndex(vec3 &in_vertex, vec3 &in_normal, float threshold)
-{
-    int foundMatch = -1;
-
-    // Lame linear search
-    for ( unsigned int i = 0; i < numVertices * 3; i += 3 )
-    {
-        if (is_near( in_vertex.x , vertexData[i],   threshold) &&
-            is_near( in_vertex.y , vertexData[i+1], threshold) &&
-            is_near( in_vertex.z , vertexData[i+2], threshold) &&
-            is_near( in_normal.x , normalData[i],   threshold) &&
-            is_near( in_normal.y , normalData[i+1], threshold) &&
-            is_near( in_normal.z , normalData[i+2], threshold)
-        )
-        {
-            foundMatch = i;
-        }
-    }
-    return foundMatch;
-}
+		// If the line isn't empty, process it...
+		if (line.length() <= 1) { continue; }
 
-// Method to setup our plain arrays of floats for OpenGL to work with
-// NOTE: If drawing as arrays, we CANNOT have array size mismatches!
-void Model::setupData()
-{
-	if (drawingMethod == DRAWING_AS_ARRAYS)
-	{
-		cout << "Setting up model data to draw as: Arrays." << endl;
+		// Find the first token on the line, which tells us what the line holds
+		string_view firstToken;
+		const char* tokenEnd = nextObjToken(line.data(), lineEnd, firstToken);
+		if ( firstToken.empty() ) { continue; }
 
-		if ( ( hasVertices() ) && ( hasFaces() ) && ( !hasNormals() ) )
+		// If the first token is "f", then we're dealing with faces
+		// Note: A face can have any number of corners, so we parse each one as we find its token rather than splitting up the whole line first
+		if (firstToken == "f")
 		{
-			cout << "Model has vertices and faces, but no normals. Normals will be generated." << endl;
+			// Walk through the corners of the face, adding a triangle made of the first corner, the previous corner and this corner for
+			// every corner after the second - i.e. we split the face into a fan of triangles around its first corner
+			WeldKey     firstCorner      = {};
+			WeldKey     previousCorner   = {};
+			GLuint      firstRelative    = 0;
+			GLuint      previousRelative = 0;
+			GLuint      cornerNum        = 0;
+			string_view token;
+			while (true)
+			{
+				tokenEnd = nextObjToken(tokenEnd, lineEnd, token);
+				if ( token.empty() ) { break; }
 
-			// Allocate enough space for our vertexData and normalData arrays
-			vertexData = new float[numFaces * 3 * 3];
-			normalData = new float[numFaces * 3 * 3];
+				int positionIndex, texCoordIndex, normalIndex;
+				parseFaceToken(token, positionIndex, texCoordIndex, normalIndex);
 
-			// Create the vertexData and normalData arrays from the vector of faces
-			// Note: We generate the face normals ourselves
-			int vertexCount = 0;
-			int normalCount = 0;
-			for (vector<vec3>::iterator faceIter = faces->begin(); faceIter != faces->end(); faceIter++)
-			{
-				// Get the numbers of the three vertices that this face is comprised of
-				GLuint firstVertexNum  = (GLuint)(*faceIter).x;
-				GLuint secondVertexNum = (GLuint)(*faceIter).y;
-				GLuint thirdVertexNum  = (GLuint)(*faceIter).z;
-
-				// Now that we have the vertex numbers, we need to get the actual vertices
-				// Note: We subtract 1 from the number of the vertex because faces start at
-				//       face number 1 in the .oBJ format, while in our code the first vertex
-				//       will be at location zero (i.e. vertices.begin() )
-				vector<vec3>::iterator vertIter = vertices->begin();
-
-				vec3 faceVert1 = vec3( (*(vertIter + firstVertexNum  - 1) ) );
-				vec3 faceVert2 = vec3( (*(vertIter + secondVertexNum - 1) ) );
-				vec3 faceVert3 = vec3( (*(vertIter + thirdVertexNum  - 1) ) );
-
-				// Now that we have the 3 vertices, we need to calculate the normal of the face
-				// formed by these vertices
-
-				// Convert this vertex data into a pure form
-				vec3 v1 = vec3( faceVert2 - faceVert1 );
-				vec3 v2 = vec3( faceVert3 - faceVert1 );
-
-				// Generate the normal as the cross product and normalize it
-				vec3 normal = vec3( glm::cross(v1, v2) );
-				vec3 normalizedNormal = glm::normalize(normal);
-
-				// Put the vertex data into our vertexData array
-				vertexData[vertexCount++] = faceVert1.x;
-				vertexData[vertexCount++] = faceVert1.y;
-				vertexData[vertexCount++] = faceVert1.z;
-				vertexData[vertexCount++] = faceVert2.x;
-				vertexData[vertexCount++] = faceVert2.y;
-				vertexData[vertexCount++] = faceVert2.z;
-				vertexData[vertexCount++] = faceVert3.x;
-				vertexData[vertexCount++] = faceVert3.y;
-				vertexData[vertexCount++] = faceVert3.z;
-
-				// Put the normal data into our normalData array
-				// Note: we put the same normal into the normalData array for each of the
-				// 3 vertices comprising the face! That's as much as we can do without per-vertex normals!
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-
-			} // End of loop iterating over the model faces
+				bool positionIsRelative, normalIsRelative, texCoordIsRelative;
+				WeldKey corner;
+				corner.position = getObjIndex(positionIndex, chunk.vertices.size(),  MISSING_INDEX, positionIsRelative);
+				corner.normal   = getObjIndex(normalIndex,   chunk.normals.size(),   MISSING_INDEX, normalIsRelative);
+				corner.texCoord = getObjIndex(texCoordIndex, chunk.texCoords.size(), MISSING_INDEX, texCoordIsRelative);
+				GLuint relative = (positionIsRelative ? 1u : 0u) | (normalIsRelative ? 2u : 0u) | (texCoordIsRelative ? 4u : 0u);
 
-			numVertices = vertexCount / 3;
-			numNormals  = normalCount / 3;
+				if (cornerNum == 0)
+				{
+					firstCorner   = corner;
+					firstRelative = relative;
+				}
+				else if (cornerNum >= 2)
+				{
+					if ( (firstRelative | previousRelative | relative) == 0 )
+					{
+						// The usual case - nothing to fix up later, so just add the triangle
+						chunk.faceCorners.insert(chunk.faceCorners.end(), { firstCorner, previousCorner, corner });
+					}
+					else
+					{
+						addCorner(firstCorner,    firstRelative);
+						addCorner(previousCorner, previousRelative);
+						addCorner(corner,         relative);
+					}
+				}
+				previousCorner   = corner;
+				previousRelative = relative;
+				++cornerNum;
+			}
 
-			cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
-			cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
-		}
-		// If we have vertices and faces and normals
-        else if ( ( hasVertices() ) && ( hasFaces() ) && ( hasNormals() ) && ( hasNormalIndices() ) )
-		{
-			cout << "Model has vertices, faces, normals & normal indices. Transferring data." << endl;
+			// Not even a triangle? Whine!
+			if (cornerNum < 3)
+			{
+				chunk.warnings.push_back( { chunk.lineCount, "face" } );
+			}
+			else if (cornerNum > 3)
+			{
+				chunk.polygonsSplit++;
+			}
+			continue;
 
-			// Allocate enough space for our vertexData and normalData arrays
-			vertexData = new float[numFaces * 3 * 3];
-			normalData = new float[numFaces * 3 * 3];
+		} // End of face line parsing
 
-			// Create the vertexData and normalData arrays from the vector of faces
-			// Note: We generate the face normals ourselves
-			int vertexCount = 0;
-			int normalCount = 0;
-			for (vector<vec3>::iterator faceIter = faces->begin(); faceIter != faces->end(); faceIter++)
-			{
-				// Get the numbers of the three vertices that this face is comprised of
-				GLuint firstVertexNum  = (GLuint)(*faceIter).x;
-				GLuint secondVertexNum = (GLuint)(*faceIter).y;
-				GLuint thirdVertexNum  = (GLuint)(*faceIter).z;
-
-				// Now that we have the vertex numbers, we need to get the actual vertices
-				// Note: We subtract 1 from the number of the vertex because faces start at
-				//       face number 1 in the .oBJ format, while in our code the first vertex
-				//       will be at location zero (i.e. vertices->begin() )
-				vector<vec3>::iterator vertIter = vertices->begin();
-
-				vec3 faceVert1 = vec3( (*(vertIter + firstVertexNum  - 1) ) );
-				vec3 faceVert2 = vec3( (*(vertIter + secondVertexNum - 1) ) );
-				vec3 faceVert3 = vec3( (*(vertIter + thirdVertexNum  - 1) ) );
-
-				// Put the vertex data into our vertexData array
-				vertexData[vertexCount++] = faceVert1.x;
-				vertexData[vertexCount++] = faceVert1.y;
-				vertexData[vertexCount++] = faceVert1.z;
-				vertexData[vertexCount++] = faceVert2.x;
-				vertexData[vertexCount++] = faceVert2.y;
-				vertexData[vertexCount++] = faceVert2.z;
-				vertexData[vertexCount++] = faceVert3.x;
-				vertexData[vertexCount++] = faceVert3.y;
-				vertexData[vertexCount++] = faceVert3.z;
-			}
-
-            // We have to take a separate pass through the normalIndices to construct the normalData array
-			for (vector<vec3>::iterator normalIndexIter = normalIndices->begin(); normalIndexIter != normalIndices->end(); normalIndexIter++)
-			{
-			    // Get the numbers of the three normals that this face uses
-				GLuint firstNormalNum  = (GLuint)(*normalIndexIter).x;
-				GLuint secondNormalNum = (GLuint)(*normalIndexIter).y;
-				GLuint thirdNormalNum  = (GLuint)(*normalIndexIter).z;
-
-                // Now that we have the normal index numbers, we need to get the actual normals
-				// Note: We subtract 1 from the number of the normal because normals start at
-				//       number 1 in the .obJ format, while in our code the first vertex
-				//       will be at location zero (i.e. normals->begin() )
-				vector<vec3>::iterator normalIter = normals->begin();
-
-				vec3 normal1 = vec3( (*(normalIter + firstNormalNum  - 1) ) );
-				vec3 normal2 = vec3( (*(normalIter + secondNormalNum - 1) ) );
-				vec3 normal3 = vec3( (*(normalIter + thirdNormalNum  - 1) ) );
-
-				// Put the normal data into our normalData array
-				normalData[normalCount++] = normal1.x;
-				normalData[normalCount++] = normal1.y;
-				normalData[normalCount++] = normal1.z;
-
-				normalData[normalCount++] = normal2.x;
-				normalData[normalCount++] = normal2.y;
-				normalData[normalCount++] = normal2.z;
-
-				normalData[normalCount++] = normal3.x;
-				normalData[normalCount++] = normal3.y;
-				normalData[normalCount++] = normal3.z;
-
-			} // End of loop iterating over the model faces
+		// Separate the rest of the line into its whitespace-delimited tokens
+		tokens[0] = firstToken;
+		size_t tokenCount = 1 + tokeniseLine( string_view(tokenEnd, static_cast<size_t>(lineEnd - tokenEnd)), tokens + 1, MAX_TOKENS - 1 );
 
-			numVertices = vertexCount / 3;
-			numNormals  = normalCount / 3;
+		// If the first token is "v", then we're dealing with vertex data
+		if (tokens[0] == "v")
+		{
+			// As long as there's x/y/z on the line (optionally followed by w, or an r/g/b colour) get them as floats and push them into the vertices vector...
+			if (tokenCount == 4 || tokenCount == 5 || tokenCount == 7)
+			{
+				chunk.vertices.push_back( vec3( parseObjFloat(tokens[1]), parseObjFloat(tokens[2]), parseObjFloat(tokens[3]) ) );
+			}
+			else // If we got vertex data without 3 components - whine!
+			{
+				chunk.warnings.push_back( { chunk.lineCount, "vertex" } );
+			}
+		}
 
-			cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
-			cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
+		// If the first token is "vt", then we're dealing with texture coordinates
+		else if (tokens[0] == "vt")
+		{
+			// Texture coordinates are u, then optionally v and w - we only keep u and v (and v is 0 if it's not there)
+			if (tokenCount >= 2 && tokenCount <= 4)
+			{
+				chunk.texCoords.push_back( vec2( parseObjFloat(tokens[1]), (tokenCount > 2) ? parseObjFloat(tokens[2]) : 0.0f ) );
+			}
+			else // If we got texture coordinate data without 1 to 3 components - whine!
+			{
+				chunk.warnings.push_back( { chunk.lineCount, "texture coordinate" } );
+			}
 		}
 
-		// If we ONLY have vertex data, then transfer just that...
-		else if ( ( hasVertices() ) && ( !hasFaces() ) && ( !hasNormals() ) )
+		// If the first token is "vn", then we're dealing with normal data
+		else if (tokens[0] == "vn")
 		{
-			cout << "The model has no faces or normals. Transferring vertex data." << endl;
+			// As long as there's 4 tokens on the line get them as floats and push them into the normals vector...
+			if (tokenCount == 4)
+			{
+				chunk.normals.push_back( vec3( parseObjFloat(tokens[1]), parseObjFloat(tokens[2]), parseObjFloat(tokens[3]) ) );
+			}
+			else // If we got normal data without 3 components - whine!
+			{
+				chunk.warnings.push_back( { chunk.lineCount, "normal" } );
+			}
+		}
 
-			vertexData = new float[numVertices * 3]; //float[numFaces * 3 ( 3];
+		// If the first token is "usemtl", then the faces which follow use the named material
+		else if (tokens[0] == "usemtl")
+		{
+			if (tokenCount == 2)
+			{
+				chunk.materialSwitches.push_back( { chunk.faceCorners.size() / 3, tokens[1], 0 } );
+			}
+			else // If we didn't get exactly one material name - whine!
+			{
+				chunk.warnings.push_back( { chunk.lineCount, "material" } );
+			}
+		}
 
-			// Transfer all vertices from the vertices vector to the vertexData array
-			int vertexCount = 0;
-			for (vector<vec3>::iterator vertexIter = vertices->begin(); vertexIter != vertices->end(); vertexIter++)
+		// If the first token is "mtllib", then the line names one or more material libraries
+		// Note: There can be any number of them, so we walk through the tokens ourselves like we do for faces
+		else if (tokens[0] == "mtllib")
+		{
+			string_view token;
+			while (true)
 			{
-				vertexData[vertexCount++] = (*vertexIter).x;
-				vertexData[vertexCount++] = (*vertexIter).y;
-				vertexData[vertexCount++] = (*vertexIter).z;
+				tokenEnd = nextObjToken(tokenEnd, lineEnd, token);
+				if ( token.empty() ) { break; }
+				chunk.materialLibraries.push_back(token);
 			}
+		}
 
-			// Divde by 3 (remember there's 3 values per vertex, x/y/z) to get our true vertex count
-			numVertices = vertexCount / 3;
+	} // End of chunk parsing section
+}
+
+// Method to read through the model file adding all vertices, texture coordinates, normals and face corners to our
+// vertices, texCoords, normals and faceCorners vectors.
+// Note: This does NOT transfer the data into our vertexData, faceData or normalData arrays!
+//       That must be done as a separate step by calling setupData() after building up the
+//       vectors with this method!
+// Also: The face corners are already zero-based indices into the vectors (.OBJ files start their counts at 1), and every corner's indices
+//       are checked here - triangles which refer to a vertex that doesn't exist are dropped, as are normals or texture coordinates that don't.
+// Further: The file is memory-mapped and split at line boundaries into one chunk per core. Each chunk is parsed
+//          on its own thread into its own vectors, then the chunks are stitched back together in file order so
+//          the result is identical to parsing the whole file in one go.
+bool Model::readModelFile(string filename)
+{
+	bool loadedCleanly = true;
+
+	// Map the model file into memory so we can read from it
+	MappedFile file(filename);
+
+	if ( !file.isOpen() )
+	{
+		std::cerr << "Failed to open model file: " << filename << endl;
+		return false;
+	}
+
+	const char* fileStart = file.data();
+	const char* fileEnd   = fileStart + file.size();
+
+	// Work out how many chunks to split the file into - small files aren't worth spinning up threads for
+	size_t numChunks = std::max<size_t>(1, file.size() / PARALLEL_PARSE_MIN_CHUNK_BYTES);
+	numChunks = std::min<size_t>(numChunks, std::max(1u, std::thread::hardware_concurrency()));
+
+	// Find the chunk boundaries. Each chunk ends just after a newline so no line is ever split between two chunks.
+	vector<const char*> chunkStarts;
+	chunkStarts.push_back(fileStart);
+	for (size_t loop = 1; loop < numChunks; ++loop)
+	{
+		const char* split = fileStart + (file.size() / numChunks) * loop;
+		if (split < chunkStarts.back()) { split = chunkStarts.back(); }
+		const char* newline = static_cast<const char*>( memchr(split, '\n', static_cast<size_t>(fileEnd - split)) );
+		if (newline == nullptr) { break; }
+		chunkStarts.push_back(newline + 1);
+	}
+	chunkStarts.push_back(fileEnd);
+	numChunks = chunkStarts.size() - 1;
+
+	// Parse every chunk - the first on this thread and the rest on worker threads
+	vector<ObjChunk> chunks(numChunks);
+	vector<std::thread> workers;
+	for (size_t loop = 1; loop < numChunks; ++loop)
+	{
+		workers.emplace_back(parseObjChunk, chunkStarts[loop], chunkStarts[loop + 1], std::ref(chunks[loop]));
+	}
+	parseObjChunk(chunkStarts[0], chunkStarts[1], chunks[0]);
+	for (std::thread &worker : workers) { worker.join(); }
+	workers.clear();
+
+	// Prefix-sum the per-chunk counts so we know where each chunk's data goes in the combined vectors
+	vector<ObjChunk::Offsets> offsets(numChunks + 1);
+	size_t polygonsSplit = 0;
+	for (size_t loop = 0; loop < numChunks; ++loop)
+	{
+		offsets[loop + 1].vertices    = offsets[loop].vertices    + chunks[loop].vertices.size();
+		offsets[loop + 1].texCoords   = offsets[loop].texCoords   + chunks[loop].texCoords.size();
+		offsets[loop + 1].normals     = offsets[loop].normals     + chunks[loop].normals.size();
+		offsets[loop + 1].faceCorners = offsets[loop].faceCorners + chunks[loop].faceCorners.size();
+		offsets[loop + 1].lines       = offsets[loop].lines       + chunks[loop].lineCount;
+		polygonsSplit += chunks[loop].polygonsSplit;
+	}
+
+	// Report any problems in file order using the line numbers from the start of the file
+	for (size_t loop = 0; loop < numChunks; ++loop)
+	{
+		for (const ObjChunk::Warning &warning : chunks[loop].warnings)
+		{
+			loadedCleanly = false;
+			cout << "Found " << warning.dataType << " data with wrong component count at line number: " << (offsets[loop].lines + warning.lineNumber) << " - Skipping!" << endl;
+		}
+	}
+
+	// Read the material libraries the model names (each one once, relative to the model file) in the order it names them
+	std::filesystem::path modelDirectory = std::filesystem::path(filename).parent_path();
+	for (const ObjChunk &chunk : chunks)
+	{
+		for (string_view library : chunk.materialLibraries)
+		{
+			string libraryFilename = (modelDirectory / string(library)).generic_string();
+			if ( std::find(materialLibraryFilenames.begin(), materialLibraryFilenames.end(), libraryFilename) != materialLibraryFilenames.end() )
+			{
+				continue;
+			}
+			materialLibraryFilenames.push_back(libraryFilename);
+			if ( !readMaterialLibrary(libraryFilename) )
+			{
+				loadedCleanly = false;
+			}
+		}
+	}
+
+	// Look up the material of every usemtl line, and find the material each chunk starts with (i.e. the last one used before it)
+	// Note: A material we don't have gets added with the default values, so we only whine about it once
+	vector<GLuint> chunkStartMaterials(numChunks, 0);
+	bool usesMaterials = false;
+	for (size_t loop = 0; loop < numChunks; ++loop)
+	{
+		if (loop > 0)
+		{
+			const vector<ObjChunk::MaterialSwitch> &previousSwitches = chunks[loop - 1].materialSwitches;
+			chunkStartMaterials[loop] = previousSwitches.empty() ? chunkStartMaterials[loop - 1] : previousSwitches.back().materialIndex;
+		}
+		for (ObjChunk::MaterialSwitch &materialSwitch : chunks[loop].materialSwitches)
+		{
+			materialSwitch.materialIndex = findMaterial(materialSwitch.materialName);
+			if (materialSwitch.materialIndex == MISSING_INDEX)
+			{
+				loadedCleanly = false;
+				cout << "Material " << materialSwitch.materialName << " wasn't found in any material library - using default values for it." << endl;
+				materialSwitch.materialIndex = static_cast<GLuint>( materials.size() );
+				materials.push_back(Material());
+				materials.back().name = string(materialSwitch.materialName);
+			}
+			usesMaterials = true;
+		}
+	}
+
+	// Size the combined vectors and then have each chunk copy its data into its own slice of them in parallel
+	const ObjChunk::Offsets &totals = offsets[numChunks];
+	vertices->resize(totals.vertices);
+	texCoords->resize(totals.texCoords);
+	normals->resize(totals.normals);
+	faceCorners->resize(totals.faceCorners);
+
+	// If the model uses any materials then we also need the material of every triangle, to sort the triangles by afterwards
+	vector<GLuint> triangleMaterials(usesMaterials ? totals.faceCorners / 3 : 0);
+
+	vector<ObjChunk::CornerCounts> cornerCounts(numChunks);
+	auto mergeChunk = [&](size_t chunkNum)
+	{
+		ObjChunk &chunk = chunks[chunkNum];
+		const ObjChunk::Offsets &offset = offsets[chunkNum];
+
+		// Now we know where the chunk starts we can make its negative indices absolute
+		for (size_t relativeIndex : chunk.relativeIndices)
+		{
+			WeldKey &corner = chunk.faceCorners[relativeIndex / 3];
+			switch (relativeIndex % 3)
+			{
+				case 0:  corner.position += static_cast<GLuint>(offset.vertices);  break;
+				case 1:  corner.normal   += static_cast<GLuint>(offset.normals);   break;
+				default: corner.texCoord += static_cast<GLuint>(offset.texCoords); break;
+			}
+		}
+
+		// Check every corner refers to things that exist
+		// Note: A triangle with a missing position is marked by giving its first corner MISSING_INDEX as its position, so we can drop it afterwards.
+		ObjChunk::CornerCounts &counts = cornerCounts[chunkNum];
+		for (size_t triangle = 0; triangle < chunk.faceCorners.size(); triangle += 3)
+		{
+			WeldKey* corners = &chunk.faceCorners[triangle];
+			if (corners[0].position >= totals.vertices || corners[1].position >= totals.vertices || corners[2].position >= totals.vertices)
+			{
+				corners[0].position = MISSING_INDEX;
+				counts.invalidTriangles++;
+				continue;
+			}
+
+			bool allCornersHaveNormals = true;
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				if (corners[corner].normal != MISSING_INDEX && corners[corner].normal >= totals.normals)
+				{
+					corners[corner].normal = MISSING_INDEX;
+					counts.invalidAttributes++;
+				}
+				if (corners[corner].texCoord != MISSING_INDEX && corners[corner].texCoord >= totals.texCoords)
+				{
+					corners[corner].texCoord = MISSING_INDEX;
+					counts.invalidAttributes++;
+				}
+				allCornersHaveNormals = allCornersHaveNormals && (corners[corner].normal != MISSING_INDEX);
+				if (corners[corner].texCoord != MISSING_INDEX) { counts.cornersWithTexCoords++; }
+			}
+			if (allCornersHaveNormals) { counts.trianglesWithNormals++; }
+		}
+
+		std::copy(chunk.vertices.begin(),    chunk.vertices.end(),    vertices->begin()    + offset.vertices);
+		std::copy(chunk.texCoords.begin(),   chunk.texCoords.end(),   texCoords->begin()   + offset.texCoords);
+		std::copy(chunk.normals.begin(),     chunk.normals.end(),     normals->begin()     + offset.normals);
+		std::copy(chunk.faceCorners.begin(), chunk.faceCorners.end(), faceCorners->begin() + offset.faceCorners);
+
+		if (usesMaterials)
+		{
+			GLuint material = chunkStartMaterials[chunkNum];
+			size_t triangle = 0;
+			for (const ObjChunk::MaterialSwitch &materialSwitch : chunk.materialSwitches)
+			{
+				for (; triangle < materialSwitch.firstTriangle; ++triangle)
+				{
+					triangleMaterials[offset.faceCorners / 3 + triangle] = material;
+				}
+				material = materialSwitch.materialIndex;
+			}
+			for (; triangle < chunk.faceCorners.size() / 3; ++triangle)
+			{
+				triangleMaterials[offset.faceCorners / 3 + triangle] = material;
+			}
+		}
+		chunk = ObjChunk(); // Free the chunk's memory as soon as we're done with it
+	};
+	for (size_t loop = 1; loop < numChunks; ++loop)
+	{
+		workers.emplace_back(mergeChunk, loop);
+	}
+	mergeChunk(0);
+	for (std::thread &worker : workers) { worker.join(); }
+
+	ObjChunk::CornerCounts totalCounts;
+	for (const ObjChunk::CornerCounts &counts : cornerCounts)
+	{
+		totalCounts.invalidTriangles     += counts.invalidTriangles;
+		totalCounts.invalidAttributes    += counts.invalidAttributes;
+		totalCounts.trianglesWithNormals += counts.trianglesWithNormals;
+		totalCounts.cornersWithTexCoords += counts.cornersWithTexCoords;
+	}
+
+	// Drop any triangles which refer to vertices that don't exist
+	if (totalCounts.invalidTriangles > 0)
+	{
+		loadedCleanly = false;
+		cout << "Found " << totalCounts.invalidTriangles << " face triangle(s) using vertices which don't exist - Skipping!" << endl;
+
+		size_t keptCorners = 0;
+		for (size_t triangle = 0; triangle < faceCorners->size(); triangle += 3)
+		{
+			if ( (*faceCorners)[triangle].position != MISSING_INDEX )
+			{
+				std::copy(faceCorners->begin() + triangle, faceCorners->begin() + triangle + 3, faceCorners->begin() + keptCorners);
+				if (usesMaterials)
+				{
+					triangleMaterials[keptCorners / 3] = triangleMaterials[triangle / 3];
+				}
+				keptCorners += 3;
+			}
+		}
+		faceCorners->resize(keptCorners);
+		if (usesMaterials)
+		{
+			triangleMaterials.resize(keptCorners / 3);
+		}
+	}
+	if (totalCounts.invalidAttributes > 0)
+	{
+		loadedCleanly = false;
+		cout << "Found " << totalCounts.invalidAttributes << " face corner normal(s) or texture coordinate(s) which don't exist - Ignoring them!" << endl;
+	}
+	if (polygonsSplit > 0)
+	{
+		cout << "Split " << polygonsSplit << " face(s) with more than 3 corners into triangles." << endl;
+	}
+
+	// Note: Texture coordinates which no face uses are no use to us, so we only count them if at least one face corner has one
+	numVertices      = static_cast<GLuint>( vertices->size() );
+	numNormals       = static_cast<GLuint>( normals->size()  );
+	numNormalIndices = static_cast<GLuint>( totalCounts.trianglesWithNormals );
+	numTexCoords     = (totalCounts.cornersWithTexCoords > 0) ? static_cast<GLuint>( texCoords->size() ) : 0;
+	numFaces         = static_cast<GLuint>( faceCorners->size() / 3 );
+
+	// Group the triangles of each material together
+	sortFacesByMaterial(triangleMaterials);
+
+	// Return our boolean flag to say whether we loaded the model cleanly or not
+	return loadedCleanly;
+}
+
+// Method to read the materials from a .mtl material library into our materials.
+// Note: A material which is defined again (in this library or another one) starts over from the default values. We only read the parts of a
+//       material our shaders can use - the colours, specular power and opacity, and the filename of the diffuse texture.
+bool Model::readMaterialLibrary(string filename)
+{
+	MappedFile file(filename);
+	if ( !file.isOpen() )
+	{
+		cout << "Could not open material library: " << filename << " - Skipping!" << endl;
+		return false;
+	}
+
+	bool loadedCleanly = true;
+
+	constexpr size_t MAX_TOKENS = 4;
+	string_view tokens[MAX_TOKENS];
+
+	const char* p   = file.data();
+	const char* end = p + file.size();
+	int    lineNumber = 0;
+	GLuint current    = MISSING_INDEX;
+	while (p < end)
+	{
+		const char* lineEnd = static_cast<const char*>( memchr(p, '\n', static_cast<size_t>(end - p)) );
+		if (lineEnd == nullptr) { lineEnd = end; }
+		string_view line(p, static_cast<size_t>(lineEnd - p));
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+		++lineNumber;
+
+		size_t tokenCount = tokeniseLine(line, tokens, MAX_TOKENS);
+		if (tokenCount == 0 || tokens[0][0] == '#')
+		{
+			continue;
+		}
+
+		// Each "newmtl" line starts a new material - everything until the next one belongs to it
+		if (tokens[0] == "newmtl")
+		{
+			if (tokenCount != 2)
+			{
+				cout << "Found material name with wrong component count at line number: " << lineNumber << " of " << filename << " - Skipping!" << endl;
+				loadedCleanly = false;
+				current = MISSING_INDEX;
+				continue;
+			}
+			current = findMaterial(tokens[1]);
+			if (current == MISSING_INDEX)
+			{
+				current = static_cast<GLuint>( materials.size() );
+				materials.push_back(Material());
+			}
+			materials[current] = Material();
+			materials[current].name = string(tokens[1]);
+			continue;
+		}
+
+		// Anything before the first material is no use to us
+		if (current == MISSING_INDEX)
+		{
+			continue;
+		}
+		Material &material = materials[current];
+
+		// Colours are r/g/b, or a single value for a grey
+		vec3* colour = nullptr;
+		if      (tokens[0] == "Ka") { colour = &material.ambientColour;  }
+		else if (tokens[0] == "Kd") { colour = &material.diffuseColour;  }
+		else if (tokens[0] == "Ks") { colour = &material.specularColour; }
+		if (colour != nullptr)
+		{
+			if (tokenCount == 4)
+			{
+				*colour = vec3( parseObjFloat(tokens[1]), parseObjFloat(tokens[2]), parseObjFloat(tokens[3]) );
+			}
+			else if (tokenCount == 2)
+			{
+				*colour = vec3( parseObjFloat(tokens[1]) );
+			}
+			else
+			{
+				cout << "Found colour data with wrong component count at line number: " << lineNumber << " of " << filename << " - Skipping!" << endl;
+				loadedCleanly = false;
+			}
+		}
+		else if (tokens[0] == "Ns" || tokens[0] == "d" || tokens[0] == "Tr")
+		{
+			if (tokenCount == 2)
+			{
+				float value = parseObjFloat(tokens[1]);
+				if      (tokens[0] == "Ns") { material.specularPower = value;        }
+				else if (tokens[0] == "d")  { material.opacity       = value;        }
+				else                        { material.opacity       = 1.0f - value; } // Tr is transparency rather than opacity
+			}
+			else
+			{
+				cout << "Found " << tokens[0] << " data with wrong component count at line number: " << lineNumber << " of " << filename << " - Skipping!" << endl;
+				loadedCleanly = false;
+			}
+		}
+		else if (tokens[0] == "map_Kd" && tokenCount >= 2)
+		{
+			// Texture maps can have options before the filename, so the filename is always the last token on the line
+			string_view token, lastToken;
+			const char* tokenEnd = line.data();
+			while (true)
+			{
+				tokenEnd = nextObjToken(tokenEnd, lineEnd, token);
+				if ( token.empty() ) { break; }
+				lastToken = token;
+			}
+			material.diffuseTextureFilename = string(lastToken);
+		}
+	}
+
+	return loadedCleanly;
+}
+
+// Private method to find one of our materials by name - returns MISSING_INDEX if we don't have it
+// Note: Models rarely have more than a handful of materials, so a linear search is as quick as anything else
+GLuint Model::findMaterial(string_view name)
+{
+	for (size_t loop = 0; loop < materials.size(); ++loop)
+	{
+		if (materials[loop].name == name)
+		{
+			return static_cast<GLuint>(loop);
+		}
+	}
+	return MISSING_INDEX;
+}
+
+// Private method to sort the triangles in faceCorners by material, and make a full detail submesh for each material that's used.
+// Note: This is a counting sort, so it's O(n) and keeps the triangles of each material in the order they were in the file. If the model doesn't
+//       use any materials (triangleMaterials is empty) or its triangles are already in material order then faceCorners isn't touched at all.
+void Model::sortFacesByMaterial(const vector<GLuint> &triangleMaterials)
+{
+	submeshes.clear();
+	const size_t triangleCount = faceCorners->size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+	if ( triangleMaterials.empty() )
+	{
+		submeshes.push_back( { 0, 0, static_cast<GLuint>(triangleCount * 3), 0, 0 } );
+		return;
+	}
+
+	// Count the triangles of each material, and from that work out where each material's triangles start
+	vector<size_t> materialStarts(materials.size() + 1, 0);
+	for (GLuint material : triangleMaterials)
+	{
+		materialStarts[material + 1]++;
+	}
+	for (size_t loop = 1; loop < materialStarts.size(); ++loop)
+	{
+		materialStarts[loop] += materialStarts[loop - 1];
+	}
+
+	if ( !std::is_sorted(triangleMaterials.begin(), triangleMaterials.end()) )
+	{
+		vector<size_t>  nextTriangle(materialStarts.begin(), materialStarts.end() - 1);
+		vector<WeldKey> sortedCorners(faceCorners->size());
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			size_t sortedTriangle = nextTriangle[ triangleMaterials[triangle] ]++;
+			std::copy(faceCorners->begin() + triangle * 3, faceCorners->begin() + triangle * 3 + 3, sortedCorners.begin() + sortedTriangle * 3);
+		}
+		faceCorners->swap(sortedCorners);
+	}
+
+	for (size_t material = 0; material < materials.size(); ++material)
+	{
+		size_t materialTriangles = materialStarts[material + 1] - materialStarts[material];
+		if (materialTriangles > 0)
+		{
+			submeshes.push_back( { static_cast<GLuint>(material), static_cast<GLuint>(materialStarts[material] * 3), static_cast<GLuint>(materialTriangles * 3), 0, 0 } );
+		}
+	}
+	cout << "Sorted " << triangleCount << " triangles into " << submeshes.size() << " submesh(es) by material." << endl;
+}
+
+// Private method to map every element of a vector of vec2's or vec3's to the index of the first element with exactly the same value.
+// Note: Exporters often write the same position, normal or texture coordinate out many times over, so we need this to weld vertices by VALUE.
+template <typename T>
+vector<GLuint> Model::getCanonicalIndices(const vector<T> &values)
+{
+	static_assert(sizeof(T) <= sizeof(WeldKey), "Values must fit in a WeldKey to be hashed");
+
+	std::unordered_map<WeldKey, GLuint, WeldKeyHash> firstIndexOfValue;
+	firstIndexOfValue.reserve(values.size());
+
+	vector<GLuint> canonicalIndices(values.size());
+	for (size_t loop = 0; loop < values.size(); ++loop)
+	{
+		// Compare the bit patterns of the floats - we only want to merge values which are exactly the same
+		WeldKey key = {};
+		memcpy(&key, &values[loop], sizeof(T));
+		canonicalIndices[loop] = firstIndexOfValue.try_emplace(key, static_cast<GLuint>(loop)).first->second;
+	}
+	return canonicalIndices;
+}
+
+// Private method to generate a smooth normal for every face corner, given the canonical index of every position (see getCanonicalIndices)
+// Note: Using the canonical positions means faces which only share positions by value (e.g. either side of a texture seam) are still smoothed together.
+vector<vec3> Model::generateSmoothNormals(const vector<GLuint> &canonicalPositions)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	vector<GLuint> cornerPositions(faceCorners->size());
+	for (size_t corner = 0; corner < faceCorners->size(); ++corner)
+	{
+		cornerPositions[corner] = canonicalPositions[ (*faceCorners)[corner].position ];
+	}
+
+	vector<vec3> cornerNormals;
+	MeshOptimiser::generateSmoothNormals(cornerPositions, *vertices, cornerNormals, smoothNormalCreaseAngleDegs);
+
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+	cout << "Generated smooth normals for " << numFaces << " faces (crease angle: " << smoothNormalCreaseAngleDegs << " degrees) in " << duration.count() << "ms" << endl;
+	return cornerNormals;
+}
+
+// Private method to build indexed data arrays by welding together face corners which share the same attributes.
+// Every face corner refers to a position, a normal and a texture coordinate - each unique combination of those values
+// becomes one vertex in our data arrays and the faceData array then refers to those vertices by their index.
+// Note: We use hash maps from attribute values to welded vertex number so this is O(n) in the number of face corners.
+// Also: If the model doesn't have normals then we generate a smooth normal for every face corner first (see MeshOptimiser::generateSmoothNormals)
+//       and weld on position and generated normal - so corners either side of an edge sharper than the crease angle become separate vertices.
+// Further: Corners without a texture coordinate get (0, 0) if other corners have them.
+void Model::weldVertices()
+{
+	const bool useNormalIndices = everyFaceHasNormals();
+	const bool useTexCoords     = hasTexCoords();
+
+	// Map from unique (position, normal, texture coordinate) index tuple to our welded vertex number
+	std::unordered_map<WeldKey, GLuint, WeldKeyHash> weldedVertices;
+	weldedVertices.reserve(faceCorners->size());
+
+	// Each welded vertex remembers which position, normal and texture coordinate it came from
+	vector<WeldKey> uniqueVertices;
+	uniqueVertices.reserve(vertices->size());
+
+	// Positions, normals and texture coordinates with identical values are treated as the same position, normal or texture coordinate
+	vector<GLuint> canonicalPositions = getCanonicalIndices(*vertices);
+	vector<GLuint> canonicalNormals   = useNormalIndices ? getCanonicalIndices(*normals)   : vector<GLuint>();
+	vector<GLuint> canonicalTexCoords = useTexCoords     ? getCanonicalIndices(*texCoords) : vector<GLuint>();
+
+	// Generate a normal for every face corner if the model doesn't have them
+	// Note: With no crease angle every corner at a position gets the same normal, so we can weld on position alone and skip hashing the normals
+	vector<vec3>   generatedNormals;
+	vector<GLuint> canonicalGeneratedNormals;
+	if (!useNormalIndices)
+	{
+		cout << "Model doesn't have normals for every face. Smooth normals will be generated." << endl;
+		generatedNormals = generateSmoothNormals(canonicalPositions);
+		if (smoothNormalCreaseAngleDegs < MeshOptimiser::NO_CREASE_ANGLE_DEGS)
+		{
+			canonicalGeneratedNormals = getCanonicalIndices(generatedNormals);
+		}
+	}
+
+	vector<GLuint> indices(faceCorners->size());
+
+	for (size_t corner = 0; corner < faceCorners->size(); ++corner)
+	{
+		const WeldKey &faceCorner = (*faceCorners)[corner];
+
+		WeldKey key;
+		key.position = canonicalPositions[faceCorner.position];
+		if (useNormalIndices)
+		{
+			key.normal = canonicalNormals[faceCorner.normal];
+		}
+		else
+		{
+			key.normal = canonicalGeneratedNormals.empty() ? 0 : canonicalGeneratedNormals[corner];
+		}
+		key.texCoord = (useTexCoords && faceCorner.texCoord != MISSING_INDEX) ? canonicalTexCoords[faceCorner.texCoord] : MISSING_INDEX;
+
+		// Find the vertex we've already made for this tuple, or make a new one
+		auto result = weldedVertices.try_emplace(key, static_cast<GLuint>( uniqueVertices.size() ));
+		if (result.second)
+		{
+			uniqueVertices.push_back(key);
+		}
+		indices[corner] = result.first->second;
+	}
+
+	// Point each welded vertex at the generated normal of one of its corners (they all have the same normal, or they wouldn't have been welded)
+	if (!useNormalIndices)
+	{
+		for (size_t corner = 0; corner < indices.size(); ++corner)
+		{
+			uniqueVertices[ indices[corner] ].normal = static_cast<GLuint>(corner);
+		}
+	}
+
+	if (optimiseVertexOrder)
+	{
+		optimiseVertexOrderForGPU(indices, uniqueVertices);
+	}
+	else if (buildMeshlets)
+	{
+		buildMeshletTable(indices, uniqueVertices);
+	}
+
+	numVertices = static_cast<GLuint>( uniqueVertices.size() );
+	numNormals  = numVertices;
+	vertexData  = new float[numVertices * 3];
+	normalData  = new float[numNormals  * 3];
+
+	// Transfer the positions of our welded vertices
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		const vec3 &position = (*vertices)[ uniqueVertices[loop].position ];
+		vertexData[loop * 3]     = position.x;
+		vertexData[loop * 3 + 1] = position.y;
+		vertexData[loop * 3 + 2] = position.z;
+	}
+
+	// Transfer the normals of our welded vertices
+	const vector<vec3> &normalSource = useNormalIndices ? *normals : generatedNormals;
+	for (GLuint loop = 0; loop < numNormals; ++loop)
+	{
+		const vec3 &normal = normalSource[ uniqueVertices[loop].normal ];
+		normalData[loop * 3]     = normal.x;
+		normalData[loop * 3 + 1] = normal.y;
+		normalData[loop * 3 + 2] = normal.z;
+	}
+
+	// Transfer the texture coordinates of our welded vertices (if there are any)
+	numTexCoords = useTexCoords ? numVertices : 0;
+	if (useTexCoords)
+	{
+		texCoordData = new float[numTexCoords * 2];
+		for (GLuint loop = 0; loop < numTexCoords; ++loop)
+		{
+			const GLuint texCoordIndex = uniqueVertices[loop].texCoord;
+			const vec2   texCoord      = (texCoordIndex != MISSING_INDEX) ? (*texCoords)[texCoordIndex] : vec2(0.0f);
+			texCoordData[loop * 2]     = texCoord.x;
+			texCoordData[loop * 2 + 1] = texCoord.y;
+		}
+	}
+
+	// Add any simplified levels of detail after the full detail indices
+	if (generateLods)
+	{
+		buildLodChain(indices);
+	}
+
+	// Store the indices as 16 or 32-bit values depending on how many vertices we ended up with
+	setFaceData(indices);
+
+	cout << "Welded " << numFaces * 3 << " face corners into " << numVertices << " unique vertices." << endl;
+}
+
+// Private method to reorder our welded vertices and their indices so the GPU can draw them more efficiently.
+// First the triangles are reordered so that they reuse vertices still in the post-transform cache (so the vertex shader runs
+// fewer times), then the vertices are renumbered in the order the triangles first use them (so vertex fetches are sequential).
+void Model::optimiseVertexOrderForGPU(vector<GLuint> &indices, vector<WeldKey> &uniqueVertices)
+{
+	GLuint vertexCount = static_cast<GLuint>( uniqueVertices.size() );
+	float acmrBefore = MeshOptimiser::getACMR(indices, vertexCount);
+	float atvrBefore = MeshOptimiser::getATVR(indices, vertexCount);
+
+	auto optimiseStartTime = std::chrono::steady_clock::now();
+
+	// Note: Each submesh is reordered on its own so that the triangles of each material stay together
+	forEachSubmesh(indices, [vertexCount](vector<GLuint> &submeshIndices, Submesh&) { MeshOptimiser::optimiseVertexCache(submeshIndices, vertexCount); });
+
+	// Overdraw optimisation needs the positions of our welded vertices
+	vector<vec3> positions;
+	MeshOptimiser::OverdrawStatistics overdrawBefore;
+	if (optimiseOverdraw || reportOverdraw)
+	{
+		positions.resize(vertexCount);
+		for (GLuint loop = 0; loop < vertexCount; ++loop)
+		{
+			positions[loop] = (*vertices)[ uniqueVertices[loop].position ];
+		}
+	}
+	if (reportOverdraw)
+	{
+		overdrawBefore = MeshOptimiser::analyseOverdraw(indices.data(), GL_UNSIGNED_INT, static_cast<GLuint>( indices.size() ), &positions[0].x, vertexCount);
+	}
+	if (optimiseOverdraw)
+	{
+		forEachSubmesh(indices, [&positions](vector<GLuint> &submeshIndices, Submesh&) { MeshOptimiser::optimiseOverdraw(submeshIndices, positions, overdrawAcmrThreshold); });
+	}
+	if (reportOverdraw)
+	{
+		MeshOptimiser::OverdrawStatistics overdrawAfter = MeshOptimiser::analyseOverdraw(indices.data(), GL_UNSIGNED_INT, static_cast<GLuint>( indices.size() ), &positions[0].x, vertexCount);
+		cout << "Overdraw (software rasterised from 14 directions): " << overdrawBefore.overdraw << " -> " << overdrawAfter.overdraw << endl;
+	}
+
+	// Meshlets reorder the triangles too, so they have to be built before we renumber the vertices to match the final triangle order
+	if (buildMeshlets)
+	{
+		buildMeshletTable(indices, uniqueVertices);
+	}
+
+	vector<GLuint> remap = MeshOptimiser::optimiseVertexFetch(indices, vertexCount);
+
+	// Move each welded vertex to its new position
+	vector<WeldKey> remappedVertices(uniqueVertices.size());
+	for (GLuint loop = 0; loop < vertexCount; ++loop)
+	{
+		remappedVertices[ remap[loop] ] = uniqueVertices[loop];
+	}
+	uniqueVertices.swap(remappedVertices);
+
+	std::chrono::duration<double, std::milli> optimiseDuration = std::chrono::steady_clock::now() - optimiseStartTime;
+
+	cout << "Vertex cache optimisation (" << MeshOptimiser::STATS_CACHE_SIZE << " entry FIFO) - ACMR: " << acmrBefore << " -> " << MeshOptimiser::getACMR(indices, vertexCount)
+	     << ", ATVR: " << atvrBefore << " -> " << MeshOptimiser::getATVR(indices, vertexCount) << " (" << optimiseDuration.count() << "ms)" << endl;
+}
+
+// Private method to run a reordering on each full detail submesh's range of the indices separately, so that every triangle stays in its submesh.
+// Note: This must only be used before the levels of detail are built, while the indices and submeshes are just the full detail ones.
+//       With a single submesh the reordering works on the indices in place, so there's no copying at all.
+void Model::forEachSubmesh(vector<GLuint> &indices, const std::function<void(vector<GLuint>&, Submesh&)> &process)
+{
+	if (submeshes.size() == 1 && submeshes[0].firstIndex == 0 && submeshes[0].indexCount == indices.size())
+	{
+		process(indices, submeshes[0]);
+		return;
+	}
+
+	vector<GLuint> submeshIndices;
+	for (Submesh &submesh : submeshes)
+	{
+		auto submeshStart = indices.begin() + submesh.firstIndex;
+		submeshIndices.assign(submeshStart, submeshStart + submesh.indexCount);
+		process(submeshIndices, submesh);
+		std::copy(submeshIndices.begin(), submeshIndices.end(), submeshStart);
+	}
+}
+
+// Private method to build a chain of simplified levels of detail and append their indices to the full detail indices.
+// Note: Each level is simplified from the level before it (which is quicker than starting from the full detail model every time), so the
+//       error of each level is the sum of the errors of the simplifications it took to get there. Each level is then reordered for the
+//       vertex cache, but not for vertex fetch - as all the levels share the vertex data we can only order that for one of them.
+// Also: Each submesh is simplified on its own, so every level keeps the triangles of each material together (and the edges between materials
+//       don't move, as they're borders of the submeshes either side). A level's error is the largest error of any of its submeshes.
+void Model::buildLodChain(vector<GLuint> &indices)
+{
+	vector<vec3> positions(numVertices);
+	vector<vec3> vertexNormals(numNormals);
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		positions[loop] = vec3(vertexData[loop * 3], vertexData[loop * 3 + 1], vertexData[loop * 3 + 2]);
+	}
+	for (GLuint loop = 0; loop < numNormals; ++loop)
+	{
+		vertexNormals[loop] = vec3(normalData[loop * 3], normalData[loop * 3 + 1], normalData[loop * 3 + 2]);
+	}
+
+	auto simplifyStartTime = std::chrono::steady_clock::now();
+
+	const GLuint fullIndexCount = static_cast<GLuint>( indices.size() );
+	lods.clear();
+	lods.push_back({ 0, fullIndexCount, 0.0f });
+
+	// Only the full detail submeshes exist so far
+	const size_t submeshCount = submeshes.size();
+	vector<vector<GLuint>> previousLevel(submeshCount);
+	for (size_t submesh = 0; submesh < submeshCount; ++submesh)
+	{
+		auto submeshStart = indices.begin() + submeshes[submesh].firstIndex;
+		previousLevel[submesh].assign(submeshStart, submeshStart + submeshes[submesh].indexCount);
+	}
+	size_t previousLevelSize = fullIndexCount;
+	float  previousError     = 0.0f;
+	for (float ratio : lodTriangleRatios)
+	{
+		vector<vector<GLuint>> level(submeshCount);
+		size_t levelSize     = 0;
+		float  levelError    = 0.0f;
+		bool   anySimplified = false;
+		for (size_t submesh = 0; submesh < submeshCount; ++submesh)
+		{
+			// A submesh which can't be simplified (or is already at its target) stays as it was
+			size_t targetIndexCount = static_cast<size_t>(submeshes[submesh].indexCount / 3 * ratio) * 3;
+			if (targetIndexCount < previousLevel[submesh].size())
+			{
+				float simplifyError = 0.0f;
+				level[submesh] = MeshOptimiser::simplify(previousLevel[submesh], positions, vertexNormals, targetIndexCount, &simplifyError);
+				levelError     = std::max(levelError, simplifyError);
+				anySimplified  = true;
+			}
+			if ( level[submesh].empty() )
+			{
+				level[submesh] = previousLevel[submesh];
+			}
+			levelSize += level[submesh].size();
+		}
+		if (!anySimplified)
+		{
+			continue;
+		}
+
+		// Stop if we can't simplify much further (e.g. everything left is on a border) - a level which barely saves anything isn't worth having
+		if (levelSize > previousLevelSize * 9 / 10)
+		{
+			break;
+		}
+
+		LodLevel lod;
+		lod.firstIndex = static_cast<GLuint>( indices.size() );
+		lod.indexCount = static_cast<GLuint>(levelSize);
+		lod.error      = previousError + levelError;
+		lods.push_back(lod);
+
+		for (size_t submesh = 0; submesh < submeshCount; ++submesh)
+		{
+			MeshOptimiser::optimiseVertexCache(level[submesh], numVertices);
+			submeshes.push_back( { submeshes[submesh].materialIndex, static_cast<GLuint>( indices.size() ), static_cast<GLuint>( level[submesh].size() ), 0, 0 } );
+			indices.insert(indices.end(), level[submesh].begin(), level[submesh].end());
+		}
+
+		previousLevel.swap(level);
+		previousLevelSize = levelSize;
+		previousError     = lod.error;
+	}
+
+	std::chrono::duration<double, std::milli> simplifyDuration = std::chrono::steady_clock::now() - simplifyStartTime;
+
+	for (size_t lodNumber = 1; lodNumber < lods.size(); ++lodNumber)
+	{
+		cout << "LOD " << lodNumber << ": " << lods[lodNumber].indexCount / 3 << " triangles (" << 100.0f * lods[lodNumber].indexCount / fullIndexCount
+		     << "% of full detail), max error: " << lods[lodNumber].error << endl;
+	}
+	cout << "Built " << lods.size() - 1 << " levels of detail in " << simplifyDuration.count() << "ms." << endl;
+
+	// Only the full detail model? Then we don't need a level of detail table at all.
+	if (lods.size() == 1)
+	{
+		lods.clear();
+	}
+}
+
+// Private method to store face indices in faceData using the smallest index type that can address every vertex.
+// Note: 16-bit indices halve the size of the index buffer (and the bandwidth used to read it) for models with up to 65536 vertices.
+void Model::setFaceData(const vector<GLuint> &indices)
+{
+	faceIndexType = (numVertices <= 65536) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	faceData = new GLubyte[indices.size() * getFaceIndexSizeBytes()];
+
+	if (faceIndexType == GL_UNSIGNED_SHORT)
+	{
+		GLushort* shortIndices = reinterpret_cast<GLushort*>(faceData);
+		for (size_t loop = 0; loop < indices.size(); ++loop)
+		{
+			shortIndices[loop] = static_cast<GLushort>(indices[loop]);
+		}
+	}
+	else
+	{
+		memcpy(faceData, indices.data(), indices.size() * sizeof(GLuint));
+	}
+}
+
+// Method to setup our plain arrays of floats for OpenGL to work with
+// NOTE: If drawing as arrays, we CANNOT have array size mismatches!
+void Model::setupData()
+{
+	if (drawingMethod == DRAWING_AS_ARRAYS)
+	{
+		cout << "Setting up model data to draw as: Arrays." << endl;
+
+		if ( ( hasVertices() ) && ( hasFaces() ) )
+		{
+			// Allocate enough space for our vertexData and normalData arrays (and texCoordData if any face corners have texture coordinates)
+			const bool useNormalIndices = everyFaceHasNormals();
+			const bool useTexCoords     = hasTexCoords();
+			vertexData   = new float[numFaces * 3 * 3];
+			normalData   = new float[numFaces * 3 * 3];
+			texCoordData = useTexCoords ? new float[numFaces * 3 * 2] : nullptr;
+
+			// If the model doesn't have normals for every face then generate a normal for each corner of each face
+			// Note: This used to give every corner of a face the face's own normal, which shades the model as flat facets - set the crease angle
+			//       to 0 to get that back, or somewhere in between to keep just the sharper edges faceted.
+			vector<vec3> cornerNormals;
+			if (useNormalIndices)
+			{
+				cout << "Model has vertices, faces & normals" << (useTexCoords ? " & texture coordinates" : "") << ". Transferring data." << endl;
+			}
+			else
+			{
+				cout << "Model has vertices and faces, but not every face has normals. Smooth normals will be generated." << endl;
+				cornerNormals = generateSmoothNormals( getCanonicalIndices(*vertices) );
+			}
+
+			// Create the vertexData, normalData and texCoordData arrays in a single pass over the face corners
+			// Note: Corners without a texture coordinate get (0, 0) if other corners have them
+			for (size_t corner = 0; corner < faceCorners->size(); ++corner)
+			{
+				const WeldKey &faceCorner = (*faceCorners)[corner];
+
+				const vec3 &vertex = (*vertices)[faceCorner.position];
+				vertexData[corner * 3]     = vertex.x;
+				vertexData[corner * 3 + 1] = vertex.y;
+				vertexData[corner * 3 + 2] = vertex.z;
+
+				const vec3 &normal = useNormalIndices ? (*normals)[faceCorner.normal] : cornerNormals[corner];
+				normalData[corner * 3]     = normal.x;
+				normalData[corner * 3 + 1] = normal.y;
+				normalData[corner * 3 + 2] = normal.z;
+
+				if (useTexCoords)
+				{
+					const vec2 texCoord = (faceCorner.texCoord != MISSING_INDEX) ? (*texCoords)[faceCorner.texCoord] : vec2(0.0f);
+					texCoordData[corner * 2]     = texCoord.x;
+					texCoordData[corner * 2 + 1] = texCoord.y;
+				}
+			}
+
+			numVertices  = numFaces * 3;
+			numNormals   = numVertices;
+			numTexCoords = useTexCoords ? numVertices : 0;
+
+			cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
+			cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
+		}
+		// If we ONLY have vertex data, then transfer just that...
+		else if ( ( hasVertices() ) && ( !hasFaces() ) && ( !hasNormals() ) )
+		{
+			cout << "The model has no faces or normals. Transferring vertex data." << endl;
+
+			vertexData = new float[numVertices * 3]; //float[numFaces * 3 ( 3];
+
+			// Transfer all vertices from the vertices vector to the vertexData array
+			int vertexCount = 0;
+			for (vector<vec3>::iterator vertexIter = vertices->begin(); vertexIter != vertices->end(); vertexIter++)
+			{
+				vertexData[vertexCount++] = (*vertexIter).x;
+				vertexData[vertexCount++] = (*vertexIter).y;
+				vertexData[vertexCount++] = (*vertexIter).z;
+			}
+
+			// Divde by 3 (remember there's 3 values per vertex, x/y/z) to get our true vertex count
+			numVertices = vertexCount / 3;
 
 			// Print a summary of the vertex data
 			cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
@@ -592,117 +1807,47 @@ void Model::setupData()
             cout << "Got vertices?: " << hasVertices() << endl;
             cout << "Has normals? : " << hasNormals()  << endl;
             cout << "etc..." << endl;
+            initModel();
+            return;
         }
     }
     else // If we're not DRAWING_AS_ARRAYS then we must be DRAWING_AS_ELEMENTS (no duplicates in data arrays)...
 	{
         cout << "Setting up model data to draw as: Elements." << endl;
 
-		// Transfer the vertex data from the vector of vec3s to our vertexData array of floats
-		if ( hasVertices() && hasFaces() )
-		{
-            vertexData = new float[numFaces * 3 * 3];
-            normalData = new float[numFaces * 3 * 3];
-
-            // Create the vertexData and normalData arrays from the vector of faces
-			// Note: We generate the face normals ourselves
-			int vertexCount = 0;
-			int normalCount = 0;
-			for (vector<vec3>::iterator faceIter = faces->begin(); faceIter != faces->end(); faceIter++)
-			{
-				// Get the numbers of the three vertices that this face is comprised of
-				GLuint firstVertexNum  = (GLuint)(*faceIter).x;
-				GLuint secondVertexNum = (GLuint)(*faceIter).y;
-				GLuint thirdVertexNum  = (GLuint)(*faceIter).z;
-
-				// Now that we have the vertex numbers, we need to get the actual vertices
-				// Note: We subtract 1 from the number of the vertex because faces start at
-				//       face number 1 in the .oBJ format, while in our code the first vertex
-				//       will be at location zero (i.e. vertices.begin() )
-				vector<vec3>::iterator vertIter = vertices->begin();
-
-				vec3 faceVert1 = vec3( (*(vertIter + firstVertexNum  - 1) ) );
-				vec3 faceVert2 = vec3( (*(vertIter + secondVertexNum - 1) ) );
-				vec3 faceVert3 = vec3( (*(vertIter + thirdVertexNum  - 1) ) );
-
-				// Now that we have the 3 vertices, we need to calculate the normal of the face
-				// formed by these vertices
-
-				// Convert this vertex data into a pure form
-				vec3 v1 = vec3( faceVert2 - faceVert1 );
-				vec3 v2 = vec3( faceVert3 - faceVert1 );
-
-				// Generate the normal as the cross product and normalize it
-				vec3 normal = vec3( glm::cross(v1, v2) );
-				vec3 normalizedNormal = glm::normalize(normal);
-
-				// Put the vertex data into our vertexData array
-				vertexData[vertexCount++] = faceVert1.x;
-				vertexData[vertexCount++] = faceVert1.y;
-				vertexData[vertexCount++] = faceVert1.z;
-				vertexData[vertexCount++] = faceVert2.x;
-				vertexData[vertexCount++] = faceVert2.y;
-				vertexData[vertexCount++] = faceVert2.z;
-				vertexData[vertexCount++] = faceVert3.x;
-				vertexData[vertexCount++] = faceVert3.y;
-				vertexData[vertexCount++] = faceVert3.z;
-
-				// Put the normal data into our normalData array
-				// Note: we put the same normal into the normalData array for each of the
-				// 3 vertices comprising the face! That's as much as we can do without per-vertex normals!
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-				normalData[normalCount++] = normalizedNormal.x;
-				normalData[normalCount++] = normalizedNormal.y;
-				normalData[normalCount++] = normalizedNormal.z;
-
-			} // End of loop iterating over the model faces
-
-			numVertices = vertexCount / 3;
-			numNormals  = normalCount / 3;
-
-			cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
-			cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
-		}
-		else
+		// Note: If we can't draw the model we leave it empty rather than exiting - see load()
+		if ( !hasVertices() )
 		{
-			cout << "User elected to draw as elements, but no vertex data found. Exiting." << endl;
-			exit(-1);
+			cout << "User elected to draw as elements, but no vertex data found. The model can't be used." << endl;
+			initModel();
+			return;
 		}
 
-		// Transfer the vertex data from the vector of vec3s to our vertexData array of floats
-		if ( hasFaces() )
+		if ( !hasFaces() )
 		{
-			// Allocate storage for our face data (3 vertex numbers per face)
-			faceData = new GLuint[numFaces * 3];
+			cout << "User elected to draw as elements, but no face data found. The model can't be used." << endl;
+			initModel();
+			return;
+		}
 
-			int faceCount = 0;
-			for (vector<vec3>::iterator iter = faces->begin(); iter != faces->end(); iter++)
-			{
-				// IMPORTANT: Face numbering in a .OBJ file starts at 1 and not 0! So to map this
-				//            to our array (which starts at element 0) we need to subtract one
-				//            from every face! i.e. I have a triangle, in the obj file it says
-				//            we're using vertices 1, 2 and 3 for the triangle --- but in my
-				//            faceData array this maps to elements 0, 1 and 2!
-				faceData[faceCount++] = ((*iter).x) - 1; // Put the x component in the vertexData array and move to next value
-				faceData[faceCount++] = ((*iter).y) - 1; // Put the y component in the vertexData array and move to next value
-				faceData[faceCount++] = ((*iter).z) - 1; // Put the z component in the vertexData array and move to next value
-			}
+		// Build the compact vertexData/normalData arrays and the faceData index array
+		weldVertices();
 
-			numFaces = faceCount / 3;
-		}
-		else
-		{
-			cout << "User elected to draw as elements, but no face data found. Exiting." << endl;
-			exit(-1);
-		}
+		cout << "Number of vertices in data array: " << numVertices << " (" << getVertexDataSizeBytes() << " bytes)" << endl;
+		cout << "Number of normals  in data array: " << numNormals  << " (" << getNormalDataSizeBytes() << " bytes)" << endl;
+		cout << "Number of indices  in face array: " << getFaceElementCount() << " (" << getFaceDataSizeBytes() << " bytes)" << endl;
 
 	} // End of drawing as elements section
 
+	// A model without faces is drawn as a single submesh of all its vertices with the default material
+	if ( submeshes.empty() )
+	{
+		submeshes.push_back( { 0, 0, (drawingMethod == DRAWING_AS_ARRAYS) ? numVertices : getFaceElementCount(), 0, 0 } );
+	}
+
+	// Work out the bounds of the model so it can be culled when it's out of view
+	calculateBounds();
+
 } // End of setupData method
 
 // A method to print out the vector of vertices
@@ -714,12 +1859,13 @@ void Model::printVertices()
 	}
 }
 
-// A method to print out the vector of faces
+// A method to print out the vector of faces (as the vertex numbers of each triangle's corners, counting from 1 like the .OBJ file does)
 void Model::printFaces()
 {
-	for (vector<vec3>::iterator i = faces->begin(); i != faces->end(); i++)
+	for (size_t corner = 0; corner + 2 < faceCorners->size(); corner += 3)
 	{
-		cout << "Face - v1: " << (*i).x << "\t" << "v2: " << (*i).y << "\t" "v3: " << (*i).z << endl;
+		const WeldKey* i = &(*faceCorners)[corner];
+		cout << "Face - v1: " << i[0].position + 1 << "\t" << "v2: " << i[1].position + 1 << "\t" "v3: " << i[2].position + 1 << endl;
 	}
 }
 
@@ -751,39 +1897,592 @@ void Model::printVertexData()
 }
 
 // Getters
-GLvoid* Model::getVertexData()                 { return vertexData;                            }
-GLvoid* Model::getNormalData()                 { return normalData;                            }
-GLvoid* Model::getNormalIndexData()            { return normalIndexData;                       }
-GLvoid* Model::getFaceData()                   { return faceData;                              }
-GLuint  Model::getVertexDataSizeBytes()        { return numVertices * 3 * sizeof(GLfloat);     }
-GLuint  Model::getNormalDataSizeBytes()        { return numNormals * 3 * sizeof(GLfloat);      }
-GLuint  Model::getNormalIndexDataSizeBytes()   { return numNormalIndices * 3 * sizeof(GLuint); }
-GLuint  Model::getFaceDataSizeBytes()          { return numFaces * 3 * sizeof(GLuint);         }
-GLuint  Model::getNumVertices()                { return numVertices;                           }
-GLuint  Model::getNumNormals()                 { return numNormals;                            }
-GLuint  Model::getNumNormalIndices()           { return numNormalIndices;                      }
-GLuint  Model::getNumFaces()                   { return numFaces;                              }
-GLuint  Model::getFaceElementCount()           { return numFaces * 3;                          }
-Model::DrawingMethod Model::getDrawingMethod() { return drawingMethod;                         }
+const GLvoid* Model::getVertexData() const               { return vertexData;                            }
+const GLvoid* Model::getNormalData() const               { return normalData;                            }
+const GLvoid* Model::getNormalIndexData() const          { return normalIndexData;                       }
+const GLvoid* Model::getTexCoordData() const             { return texCoordData;                          }
+const GLvoid* Model::getFaceData() const                 { return faceData;                              }
+GLuint        Model::getVertexDataSizeBytes() const      { return numVertices * 3 * sizeof(GLfloat);     }
+GLuint        Model::getNormalDataSizeBytes() const      { return numNormals * 3 * sizeof(GLfloat);      }
+GLuint        Model::getNormalIndexDataSizeBytes() const { return numNormalIndices * 3 * sizeof(GLuint); }
+GLuint        Model::getTexCoordDataSizeBytes() const    { return numTexCoords * 2 * sizeof(GLfloat);    }
+GLuint        Model::getFaceDataSizeBytes() const        { return getTotalFaceIndexCount() * getFaceIndexSizeBytes(); }
+GLuint        Model::getNumVertices() const              { return numVertices;                           }
+GLuint        Model::getNumNormals() const               { return numNormals;                            }
+GLuint        Model::getNumNormalIndices() const         { return numNormalIndices;                      }
+GLuint        Model::getNumTexCoords() const             { return numTexCoords;                          }
+GLuint        Model::getNumFaces() const                 { return numFaces;                              }
+GLuint        Model::getFaceElementCount() const         { return numFaces * 3;                          }
+GLenum        Model::getFaceIndexType() const            { return faceIndexType;                         }
+GLuint        Model::getFaceIndexSizeBytes() const       { return (faceIndexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint); }
+Model::DrawingMethod Model::getDrawingMethod() const     { return drawingMethod;                         }
+double        Model::getParseTimeMs() const              { return parseTimeMs;                           }
+
+// Method to get our vertex data as a single interleaved position/normal/texture coordinate stream
+const GLvoid* Model::getInterleavedData() const
+{
+	if ( interleavedData.empty() && hasVertices() )
+	{
+		interleavedData.resize(size_t(numVertices) * INTERLEAVED_FLOATS_PER_VERTEX);
 
-// Method to scale the size of a model uniformly
-void Model::scale(float scale)
+		// Note: Vertices without a normal or texture coordinate just get zeros for them
+		const bool hasNormalData   = (normalData   != nullptr) && (numNormals   >= numVertices);
+		const bool hasTexCoordData = (texCoordData != nullptr) && (numTexCoords >= numVertices);
+		for (GLuint loop = 0; loop < numVertices; ++loop)
+		{
+			GLfloat* vertex = &interleavedData[size_t(loop) * INTERLEAVED_FLOATS_PER_VERTEX];
+			vertex[0] = vertexData[loop * 3];
+			vertex[1] = vertexData[loop * 3 + 1];
+			vertex[2] = vertexData[loop * 3 + 2];
+			vertex[3] = hasNormalData   ? normalData[loop * 3]       : 0.0f;
+			vertex[4] = hasNormalData   ? normalData[loop * 3 + 1]   : 0.0f;
+			vertex[5] = hasNormalData   ? normalData[loop * 3 + 2]   : 0.0f;
+			vertex[6] = hasTexCoordData ? texCoordData[loop * 2]     : 0.0f;
+			vertex[7] = hasTexCoordData ? texCoordData[loop * 2 + 1] : 0.0f;
+		}
+	}
+	return interleavedData.data();
+}
+
+GLuint Model::getInterleavedDataSizeBytes() const { return numVertices * INTERLEAVED_STRIDE_BYTES; }
+
+// Private helper method to octahedral-encode a unit vector into two signed normalised shorts
+void Model::encodeOctahedral(const vec3 &normal, GLshort encoded[2])
+{
+	// Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals of the upper half
+	vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	float x = n.x;
+	float y = n.y;
+	if (n.z < 0.0f)
+	{
+		x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	// Rounding each component to the nearest value isn't always the closest encoding once we decode it, so we try rounding
+	// each component both down and up and keep whichever decodes closest to the original normal
+	float scaledX = glm::clamp(x, -1.0f, 1.0f) * 32767.0f;
+	float scaledY = glm::clamp(y, -1.0f, 1.0f) * 32767.0f;
+	float bestDot = -2.0f;
+	for (int xRound = 0; xRound < 2; ++xRound)
+	{
+		for (int yRound = 0; yRound < 2; ++yRound)
+		{
+			GLshort candidate[2] = { static_cast<GLshort>(xRound ? std::ceil(scaledX) : std::floor(scaledX)),
+			                         static_cast<GLshort>(yRound ? std::ceil(scaledY) : std::floor(scaledY)) };
+			float dot = glm::dot(normal, decodeOctahedral(candidate));
+			if (dot > bestDot)
+			{
+				bestDot    = dot;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+}
+
+// Private helper method to decode an octahedral-encoded normal. This must match decodeOctahedralNormal in phong.vert!
+vec3 Model::decodeOctahedral(const GLshort encoded[2])
+{
+	// Note: OpenGL maps a signed normalised short s to max(s / 32767, -1)
+	vec3 n( glm::max(encoded[0] / 32767.0f, -1.0f), glm::max(encoded[1] / 32767.0f, -1.0f), 0.0f );
+	n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+
+	// Unfold the lower half of the octahedron
+	float t = glm::max(-n.z, 0.0f);
+	n.x += (n.x >= 0.0f) ? -t : t;
+	n.y += (n.y >= 0.0f) ? -t : t;
+	return glm::normalize(n);
+}
+
+// Method to get our vertex data in the quantised layout, building it if required.
+// Note: Each position is stored relative to the model's bounding box, so the error is at most half a step of 1/65535th of the box's size on each axis.
+// Also: The bounds are kept up to date by calculateBounds() whenever the vertex data changes, so we don't need to work them out again here.
+const GLvoid* Model::getQuantisedData() const
+{
+	if ( quantisedData.empty() && hasVertices() )
+	{
+		quantisedData.resize(numVertices);
+
+		// Note: We avoid a zero scale on flat axes so we never divide by zero
+		quantisedPositionOffset = boundsMin;
+		quantisedPositionScale  = glm::max(boundsMax - boundsMin, vec3(1e-20f));
+
+		const bool hasNormalData = (normalData != nullptr) && (numNormals >= numVertices);
+		quantisedPositionMaxError = 0.0f;
+		quantisedNormalMaxError   = 0.0f;
+		for (GLuint loop = 0; loop < numVertices; ++loop)
+		{
+			QuantisedVertex &quantised = quantisedData[loop];
+
+			vec3 position(vertexData[loop * 3], vertexData[loop * 3 + 1], vertexData[loop * 3 + 2]);
+			vec3 normalisedPosition = glm::clamp((position - quantisedPositionOffset) / quantisedPositionScale, 0.0f, 1.0f);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				quantised.position[axis] = static_cast<GLushort>( normalisedPosition[axis] * 65535.0f + 0.5f );
+			}
+			quantised.position[3] = 0;
+
+			vec3 decodedPosition = vec3(quantised.position[0], quantised.position[1], quantised.position[2]) / 65535.0f * quantisedPositionScale + quantisedPositionOffset;
+			quantisedPositionMaxError = glm::max(quantisedPositionMaxError, glm::length(decodedPosition - position));
+
+			// Vertices without a (usable) normal just get one pointing straight up
+			vec3 normal = hasNormalData ? vec3(normalData[loop * 3], normalData[loop * 3 + 1], normalData[loop * 3 + 2]) : vec3(0.0f);
+			float normalLength = glm::length(normal);
+			normal = (normalLength > 0.0f) ? normal / normalLength : vec3(0.0f, 1.0f, 0.0f);
+
+			encodeOctahedral(normal, quantised.normal);
+			float cosAngle = glm::clamp(glm::dot(normal, decodeOctahedral(quantised.normal)), -1.0f, 1.0f);
+			quantisedNormalMaxError = glm::max(quantisedNormalMaxError, std::acos(cosAngle));
+		}
+
+		cout << "Quantised vertex data: " << QUANTISED_STRIDE_BYTES << " bytes per vertex (was " << 6 * sizeof(GLfloat) << "). "
+		     << "Max position error: " << getQuantisedPositionMaxError() << " (" << 100.0f * getQuantisedPositionMaxError() / glm::length(boundsMax - boundsMin) << "% of bounds diagonal), "
+		     << "max normal error: " << getQuantisedNormalMaxErrorDegs() << " degrees" << endl;
+	}
+	return quantisedData.data();
+}
+
+GLuint Model::getQuantisedDataSizeBytes() const      { return numVertices * QUANTISED_STRIDE_BYTES; }
+vec3   Model::getQuantisedPositionScale() const      { getQuantisedData(); return quantisedPositionScale;  }
+vec3   Model::getQuantisedPositionOffset() const     { getQuantisedData(); return quantisedPositionOffset; }
+float  Model::getQuantisedPositionMaxError() const   { getQuantisedData(); return quantisedPositionMaxError; }
+float  Model::getQuantisedNormalMaxErrorDegs() const { getQuantisedData(); return glm::degrees(quantisedNormalMaxError); }
+
+// Private method to work out the axis-aligned bounding box and bounding sphere of our vertex data.
+// Note: The sphere is centred on the middle of the bounding box, which isn't the smallest possible sphere but is never far off for
+//       real models (and is quick to find) - its radius is the distance to the furthest vertex, so it's usually smaller than the box's.
+void Model::calculateBounds()
+{
+	if (vertexData == nullptr || numVertices == 0)
+	{
+		boundsMin            = vec3(0.0f);
+		boundsMax            = vec3(0.0f);
+		boundingSphereCentre = vec3(0.0f);
+		boundingSphereRadius = 0.0f;
+		return;
+	}
+
+	boundsMin = vec3(vertexData[0], vertexData[1], vertexData[2]);
+	boundsMax = boundsMin;
+	for (GLuint loop = 0; loop < numVertices * 3; loop += 3)
+	{
+		vec3 vertex(vertexData[loop], vertexData[loop + 1], vertexData[loop + 2]);
+		boundsMin = glm::min(boundsMin, vertex);
+		boundsMax = glm::max(boundsMax, vertex);
+	}
+
+	// Note: We compare squared distances and only take the square root once at the end
+	boundingSphereCentre = (boundsMin + boundsMax) * 0.5f;
+	float maxDistanceSquared = 0.0f;
+	for (GLuint loop = 0; loop < numVertices * 3; loop += 3)
+	{
+		vec3 offset = vec3(vertexData[loop], vertexData[loop + 1], vertexData[loop + 2]) - boundingSphereCentre;
+		maxDistanceSquared = std::max(maxDistanceSquared, glm::dot(offset, offset));
+	}
+	boundingSphereRadius = std::sqrt(maxDistanceSquared);
+}
+
+// Bounding volume getters
+vec3  Model::getBoundsMin() const            { return boundsMin;            }
+vec3  Model::getBoundsMax() const            { return boundsMax;            }
+vec3  Model::getBoundingSphereCentre() const { return boundingSphereCentre; }
+float Model::getBoundingSphereRadius() const { return boundingSphereRadius; }
+
+// Method to get our bounding sphere after it's been transformed by a model matrix, as centre x/y/z and radius w.
+// Note: The radius is scaled by the largest scale on any axis, so the sphere still contains the whole model if the matrix scales non-uniformly.
+vec4 Model::getTransformedBoundingSphere(const mat4 &modelMatrix) const
+{
+	vec3  centre   = vec3( modelMatrix * vec4(boundingSphereCentre, 1.0f) );
+	float maxScale = std::max( glm::length( vec3(modelMatrix[0]) ), std::max( glm::length( vec3(modelMatrix[1]) ), glm::length( vec3(modelMatrix[2]) ) ) );
+	return vec4(centre, boundingSphereRadius * maxScale);
+}
+
+// Level of detail methods
+// Note: A model without a level of detail table only has level 0 - the full detail model.
+GLuint Model::getLodCount() const { return lods.empty() ? 1 : static_cast<GLuint>( lods.size() ); }
+
+GLuint Model::getTotalFaceIndexCount() const { return lods.empty() ? numFaces * 3 : lods.back().firstIndex + lods.back().indexCount; }
+
+Model::LodLevel Model::getLod(GLuint lodNumber) const
+{
+	if (lods.empty())
+	{
+		return { 0, numFaces * 3, 0.0f };
+	}
+	return lods[ std::min<size_t>(lodNumber, lods.size() - 1) ];
+}
+
+// Method to pick the simplest level of detail whose projected error is acceptable
+GLuint Model::selectLod(float pixelsPerModelUnit, float maxErrorPixels) const
+{
+	GLuint selectedLod = 0;
+	for (GLuint lodNumber = 1; lodNumber < lods.size(); ++lodNumber)
+	{
+		if (lods[lodNumber].error * pixelsPerModelUnit > maxErrorPixels)
+		{
+			break;
+		}
+		selectedLod = lodNumber;
+	}
+	return selectedLod;
+}
+
+// Private method to split the full detail indices into meshlets, reordering them so that each meshlet is a contiguous range of indices
+void Model::buildMeshletTable(vector<GLuint> &indices, const vector<WeldKey> &uniqueVertices)
+{
+	vector<vec3> positions(uniqueVertices.size());
+	for (size_t loop = 0; loop < uniqueVertices.size(); ++loop)
+	{
+		positions[loop] = (*vertices)[ uniqueVertices[loop].position ];
+	}
+
+	// Each submesh gets its own meshlets, so no meshlet ever mixes materials
+	auto meshletStartTime = std::chrono::steady_clock::now();
+	meshlets.clear();
+	forEachSubmesh(indices, [this, &positions](vector<GLuint> &submeshIndices, Submesh &submesh)
+	{
+		vector<MeshOptimiser::Meshlet> submeshMeshlets = MeshOptimiser::buildMeshlets(submeshIndices, positions);
+		submesh.firstMeshlet = static_cast<GLuint>( meshlets.size() );
+		submesh.meshletCount = static_cast<GLuint>( submeshMeshlets.size() );
+		for (MeshOptimiser::Meshlet &meshlet : submeshMeshlets)
+		{
+			meshlet.firstIndex += submesh.firstIndex;
+			meshlets.push_back(meshlet);
+		}
+	});
+	std::chrono::duration<double, std::milli> meshletDuration = std::chrono::steady_clock::now() - meshletStartTime;
+
+	GLuint meshletVertices = 0;
+	for (const MeshOptimiser::Meshlet &meshlet : meshlets)
+	{
+		meshletVertices += meshlet.vertexCount;
+	}
+	float meshletCount = static_cast<float>( std::max<size_t>(meshlets.size(), 1) );
+	cout << "Built " << meshlets.size() << " meshlets (average " << (indices.size() / 3) / meshletCount << " triangles and " << meshletVertices / meshletCount
+	     << " vertices each) in " << meshletDuration.count() << "ms." << endl;
+}
+
+// Private method to recalculate the bounds of our meshlets from the face data and vertex data after the vertices have moved
+void Model::updateMeshletBounds()
+{
+	if ( meshlets.empty() )
+	{
+		return;
+	}
+
+	GLuint indexCount = getLod(0).indexCount;
+	vector<GLuint> indices(indexCount);
+	for (GLuint loop = 0; loop < indexCount; ++loop)
+	{
+		indices[loop] = (faceIndexType == GL_UNSIGNED_SHORT) ? reinterpret_cast<GLushort*>(faceData)[loop] : reinterpret_cast<GLuint*>(faceData)[loop];
+	}
+
+	vector<vec3> positions(numVertices);
+	for (GLuint loop = 0; loop < numVertices; ++loop)
+	{
+		positions[loop] = vec3(vertexData[loop * 3], vertexData[loop * 3 + 1], vertexData[loop * 3 + 2]);
+	}
+
+	for (MeshOptimiser::Meshlet &meshlet : meshlets)
+	{
+		MeshOptimiser::computeMeshletBounds(meshlet, indices.data(), positions);
+	}
+}
+
+// Material and submesh getters
+// Note: Every level of detail has the same number of submeshes, one after the other in the submesh table.
+GLuint Model::getMaterialCount() const { return static_cast<GLuint>( materials.size() ); }
+GLuint Model::getSubmeshCount() const  { return static_cast<GLuint>( submeshes.size() ) / getLodCount(); }
+
+const Model::Material& Model::getMaterial(GLuint materialNumber) const { return materials[ std::min<size_t>(materialNumber, materials.size() - 1) ]; }
+
+Model::Submesh Model::getSubmesh(GLuint lodNumber, GLuint submeshNumber) const
+{
+	GLuint lod = std::min(lodNumber, getLodCount() - 1);
+	return submeshes[lod * getSubmeshCount() + submeshNumber];
+}
+
+GLuint Model::getMeshletCount() const { return static_cast<GLuint>( meshlets.size() ); }
+
+// Method to cull all our meshlets and get the ranges of face data to draw
+Model::MeshletCullResult Model::cullMeshlets(const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const
+{
+	return cullMeshletRange(0, static_cast<GLuint>( meshlets.size() ), modelMatrix, viewMatrix, projectionMatrix, counts, offsets);
+}
+
+// Method to cull the meshlets of one full detail submesh and get the ranges of its face data to draw
+Model::MeshletCullResult Model::cullMeshlets(GLuint submeshNumber, const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const
 {
-	for (GLuint loop = 0; loop < numVertices * 3; /* We change the loop inside itself! */)
+	Submesh submesh = getSubmesh(0, submeshNumber);
+	return cullMeshletRange(submesh.firstMeshlet, submesh.meshletCount, modelMatrix, viewMatrix, projectionMatrix, counts, offsets);
+}
+
+// Private method to cull a range of our meshlets and get the ranges of face data to draw.
+// Note: Everything is done in model space - rather than transforming every meshlet's bounds we transform the frustum planes and the camera
+//       position into model space once. As long as the model matrix only uses uniform scaling the meshlets' bounding spheres are still
+//       spheres in model space.
+Model::MeshletCullResult Model::cullMeshletRange(GLuint firstMeshlet, GLuint meshletCount, const mat4 &modelMatrix, const mat4 &viewMatrix, const mat4 &projectionMatrix, vector<GLsizei> &counts, vector<const GLvoid*> &offsets) const
+{
+	MeshletCullResult result;
+	counts.clear();
+	offsets.clear();
+
+	// Test every meshlet's bounding sphere against the frustum in one batch
+	Frustum frustum(projectionMatrix * viewMatrix * modelMatrix);
+	vector<vec4>    meshletSpheres(meshletCount);
+	vector<GLubyte> meshletInFrustum(meshletCount);
+	for (size_t loop = 0; loop < meshletCount; ++loop)
+	{
+		const MeshOptimiser::Meshlet &meshlet = meshlets[firstMeshlet + loop];
+		meshletSpheres[loop] = vec4(meshlet.centre[0], meshlet.centre[1], meshlet.centre[2], meshlet.radius);
+	}
+	frustum.cullSpheres(meshletSpheres.data(), meshletSpheres.size(), meshletInFrustum.data());
+	result.frustumCulled = static_cast<GLuint>( frustum.getCulledCount() );
+
+	// The camera is at the origin in view space, so the translation of the inverse model-view matrix gives us its position in model space
+	vec3 cameraPosition = vec3( glm::inverse(viewMatrix * modelMatrix)[3] );
+
+	const GLuint indexSizeBytes = getFaceIndexSizeBytes();
+	GLuint rangeStart = 0;
+	GLuint rangeEnd   = 0;
+	for (size_t loop = 0; loop < meshletCount; ++loop)
+	{
+		const MeshOptimiser::Meshlet &meshlet = meshlets[firstMeshlet + loop];
+		if ( !meshletInFrustum[loop] )
+		{
+			continue;
+		}
+		if ( MeshOptimiser::isMeshletBackFacing(meshlet, cameraPosition) )
+		{
+			++result.backFaceCulled;
+			continue;
+		}
+		++result.visible;
+
+		// Extend the current range if this meshlet follows straight on from it, otherwise start a new one
+		if (rangeEnd != rangeStart && meshlet.firstIndex == rangeEnd)
+		{
+			rangeEnd += meshlet.triangleCount * 3;
+		}
+		else
+		{
+			if (rangeEnd != rangeStart)
+			{
+				counts.push_back( static_cast<GLsizei>(rangeEnd - rangeStart) );
+				offsets.push_back( reinterpret_cast<const GLvoid*>( uintptr_t(rangeStart) * indexSizeBytes ) );
+			}
+			rangeStart = meshlet.firstIndex;
+			rangeEnd   = meshlet.firstIndex + meshlet.triangleCount * 3;
+		}
+	}
+	if (rangeEnd != rangeStart)
+	{
+		counts.push_back( static_cast<GLsizei>(rangeEnd - rangeStart) );
+		offsets.push_back( reinterpret_cast<const GLvoid*>( uintptr_t(rangeStart) * indexSizeBytes ) );
+	}
+	return result;
+}
+
+// Method to measure how much overdraw our data arrays cause
+// Note: This works on the final data arrays, so it can be used on models loaded from a mesh cache and on models drawn as arrays.
+MeshOptimiser::OverdrawStatistics Model::getOverdrawStatistics() const
+{
+	if (drawingMethod == DRAWING_AS_ELEMENTS)
 	{
-		vertexData[loop++] *= scale;
-		vertexData[loop++] *= scale;
-		vertexData[loop++] *= scale;
+		return MeshOptimiser::analyseOverdraw(faceData, faceIndexType, getFaceElementCount(), vertexData, numVertices);
 	}
+	return MeshOptimiser::analyseOverdraw(nullptr, GL_UNSIGNED_INT, numVertices, vertexData, numVertices);
+}
+
+// Method to scale the size of a model uniformly
+void Model::scale(float scale)
+{
+	transform( glm::scale( mat4(1.0f), vec3(scale) ) );
 }
 
 // Method to scale the size of a model on separate axes
+// Note: This used to leave the normals alone, which is only right for uniform scaling - they now get the normal matrix like any other transform.
 void Model::scale(float xScale, float yScale, float zScale)
 {
-	for (GLuint loop = 0; loop < numVertices * 3; /* We change the loop inside itself! */)
+	transform( glm::scale( mat4(1.0f), vec3(xScale, yScale, zScale) ) );
+}
+
+// Helper functions to transform a single packed position by a matrix, and a single packed normal by a normal matrix (renormalising it).
+// Note: These do exactly the same operations in the same order as the SSE versions below, so every vertex gets the same result either way.
+static inline void transformPosition(const mat4 &matrix, GLfloat* position)
+{
+	float x = position[0], y = position[1], z = position[2];
+	position[0] = matrix[0][0] * x + matrix[1][0] * y + matrix[2][0] * z + matrix[3][0];
+	position[1] = matrix[0][1] * x + matrix[1][1] * y + matrix[2][1] * z + matrix[3][1];
+	position[2] = matrix[0][2] * x + matrix[1][2] * y + matrix[2][2] * z + matrix[3][2];
+}
+
+static inline void transformNormal(const glm::mat3 &normalMatrix, GLfloat* normal)
+{
+	float x = normalMatrix[0][0] * normal[0] + normalMatrix[1][0] * normal[1] + normalMatrix[2][0] * normal[2];
+	float y = normalMatrix[0][1] * normal[0] + normalMatrix[1][1] * normal[1] + normalMatrix[2][1] * normal[2];
+	float z = normalMatrix[0][2] * normal[0] + normalMatrix[1][2] * normal[1] + normalMatrix[2][2] * normal[2];
+	float inverseLength = 1.0f / std::max( std::sqrt(x * x + y * y + z * z), std::numeric_limits<float>::min() );
+	normal[0] = x * inverseLength;
+	normal[1] = y * inverseLength;
+	normal[2] = z * inverseLength;
+}
+
+#ifdef MODEL_USE_SSE
+// Helper functions to load four packed x/y/z vectors (12 floats) into separate x, y and z registers, and to store them back again.
+// Note: The packed layout is x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, so each register is put together from the three loads with two shuffles.
+static inline void loadPackedVec3s(const GLfloat* data, __m128 &x, __m128 &y, __m128 &z)
+{
+	__m128 a = _mm_loadu_ps(data), b = _mm_loadu_ps(data + 4), c = _mm_loadu_ps(data + 8);
+	x = _mm_shuffle_ps( _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0) );
+	y = _mm_shuffle_ps( _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0) );
+	z = _mm_shuffle_ps( _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0) );
+}
+
+static inline void storePackedVec3s(GLfloat* data, __m128 x, __m128 y, __m128 z)
+{
+	_mm_storeu_ps(data,     _mm_shuffle_ps( _mm_unpacklo_ps(x, y),                         _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0) ));
+	_mm_storeu_ps(data + 4, _mm_shuffle_ps( _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0) ));
+	_mm_storeu_ps(data + 8, _mm_shuffle_ps( _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0) ));
+}
+#endif
+
+// Method to transform packed positions (and normals, if there are any) in place.
+// Note: Each thread gets a contiguous range of vertices which starts on a multiple of 4, so the SSE loop only has leftovers at the very end.
+void Model::transformVertices(const mat4 &matrix, GLfloat* positions, GLfloat* normals, size_t numVertices)
+{
+	const glm::mat3 normalMatrix = glm::transpose( glm::inverse( glm::mat3(matrix) ) );
+
+	auto transformRange = [&](size_t begin, size_t end)
+	{
+		size_t vertex = begin;
+
+#ifdef MODEL_USE_SSE
+		// Four vertices at a time with each of x, y and z in its own register
+		__m128 m[4][3], n[3][3];
+		for (int column = 0; column < 4; ++column)
+		{
+			for (int row = 0; row < 3; ++row)
+			{
+				m[column][row] = _mm_set1_ps(matrix[column][row]);
+				if (column < 3) { n[column][row] = _mm_set1_ps(normalMatrix[column][row]); }
+			}
+		}
+		const __m128 one                = _mm_set1_ps(1.0f);
+		const __m128 minimumDenominator = _mm_set1_ps( std::numeric_limits<float>::min() );
+
+		for (; vertex + 4 <= end; vertex += 4)
+		{
+			__m128 x, y, z;
+			loadPackedVec3s(positions + vertex * 3, x, y, z);
+			__m128 tx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], x), _mm_mul_ps(m[1][0], y)), _mm_mul_ps(m[2][0], z)), m[3][0]);
+			__m128 ty = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], x), _mm_mul_ps(m[1][1], y)), _mm_mul_ps(m[2][1], z)), m[3][1]);
+			__m128 tz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], x), _mm_mul_ps(m[1][2], y)), _mm_mul_ps(m[2][2], z)), m[3][2]);
+			storePackedVec3s(positions + vertex * 3, tx, ty, tz);
+
+			if (normals != nullptr)
+			{
+				loadPackedVec3s(normals + vertex * 3, x, y, z);
+				tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0][0], x), _mm_mul_ps(n[1][0], y)), _mm_mul_ps(n[2][0], z));
+				ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0][1], x), _mm_mul_ps(n[1][1], y)), _mm_mul_ps(n[2][1], z));
+				tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0][2], x), _mm_mul_ps(n[1][2], y)), _mm_mul_ps(n[2][2], z));
+				__m128 length        = _mm_sqrt_ps( _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz)) );
+				__m128 inverseLength = _mm_div_ps( one, _mm_max_ps(length, minimumDenominator) );
+				storePackedVec3s(normals + vertex * 3, _mm_mul_ps(tx, inverseLength), _mm_mul_ps(ty, inverseLength), _mm_mul_ps(tz, inverseLength));
+			}
+		}
+#endif
+
+		// Any vertices left over one at a time
+		for (; vertex < end; ++vertex)
+		{
+			transformPosition(matrix, positions + vertex * 3);
+			if (normals != nullptr)
+			{
+				transformNormal(normalMatrix, normals + vertex * 3);
+			}
+		}
+	};
+
+	size_t numThreads = std::max<size_t>(1, numVertices / PARALLEL_TRANSFORM_MIN_VERTICES);
+	numThreads = std::min<size_t>(numThreads, std::max(1u, std::thread::hardware_concurrency()));
+
+	vector<std::thread> workers;
+	vector<size_t> rangeStarts(numThreads + 1, numVertices);
+	for (size_t loop = 0; loop < numThreads; ++loop)
+	{
+		rangeStarts[loop] = (numVertices * loop / numThreads) & ~size_t(3);
+	}
+	for (size_t loop = 1; loop < numThreads; ++loop)
+	{
+		workers.emplace_back(transformRange, rangeStarts[loop], rangeStarts[loop + 1]);
+	}
+	transformRange(rangeStarts[0], rangeStarts[1]);
+	for (std::thread &worker : workers) { worker.join(); }
+}
+
+// Method to bake an affine transform into our vertex data
+void Model::transform(const mat4 &matrix)
+{
+	if (vertexData == nullptr)
+	{
+		return;
+	}
+
+	// Any interleaved or quantised data we've built is now out of date
+	interleavedData.clear();
+	quantisedData.clear();
+
+	auto transformStartTime = std::chrono::steady_clock::now();
+	transformVertices(matrix, vertexData, (normalData != nullptr && numNormals == numVertices) ? normalData : nullptr, numVertices);
+
+	// A mirroring transform turns every triangle inside out, so flip them back round to match their normals
+	if (glm::determinant( glm::mat3(matrix) ) < 0.0f)
+	{
+		flipWinding();
+	}
+	std::chrono::duration<double, std::milli> transformDuration = std::chrono::steady_clock::now() - transformStartTime;
+	cout << "Transformed " << numVertices << " vertices in " << transformDuration.count() << "ms." << endl;
+
+	// Our bounds and our meshlets' bounding spheres have moved, and the meshlets' normal cones may have changed direction
+	calculateBounds();
+	updateMeshletBounds();
+
+	// Our level of detail errors are distances in model units, so they grow (or shrink) with the model.
+	// Note: Like the bounding sphere radius we take the largest scale of any axis, so a non-uniform scale never makes an error look smaller than it is.
+	float maxScale = std::max( glm::length( vec3(matrix[0]) ), std::max( glm::length( vec3(matrix[1]) ), glm::length( vec3(matrix[2]) ) ) );
+	for (LodLevel &lod : lods)
+	{
+		lod.error *= maxScale;
+	}
+}
+
+// Private method to reverse the winding of every triangle by swapping its second and third corners
+// Note: When drawing as arrays the corners are vertices in their own right, so we swap all of their data.
+void Model::flipWinding()
+{
+	if ( !hasFaces() )
+	{
+		return;
+	}
+
+	if (drawingMethod == DRAWING_AS_ELEMENTS)
+	{
+		GLuint indexCount = getTotalFaceIndexCount();
+		for (GLuint index = 0; index + 2 < indexCount; index += 3)
+		{
+			if (faceIndexType == GL_UNSIGNED_SHORT) { std::swap( reinterpret_cast<GLushort*>(faceData)[index + 1], reinterpret_cast<GLushort*>(faceData)[index + 2] ); }
+			else                                    { std::swap( reinterpret_cast<GLuint*>(faceData)[index + 1],   reinterpret_cast<GLuint*>(faceData)[index + 2] );   }
+		}
+	}
+	else
 	{
-		vertexData[loop++] *= xScale;
-		vertexData[loop++] *= yScale;
-		vertexData[loop++] *= zScale;
+		for (GLuint vertex = 0; vertex + 2 < numVertices; vertex += 3)
+		{
+			std::swap_ranges(vertexData + (vertex + 1) * 3, vertexData + (vertex + 2) * 3, vertexData + (vertex + 2) * 3);
+			if (normalData   != nullptr) { std::swap_ranges(normalData   + (vertex + 1) * 3, normalData   + (vertex + 2) * 3, normalData   + (vertex + 2) * 3); }
+			if (texCoordData != nullptr) { std::swap_ranges(texCoordData + (vertex + 1) * 2, texCoordData + (vertex + 2) * 2, texCoordData + (vertex + 2) * 2); }
+		}
 	}
 }
@@ -0,0 +1,172 @@
+#include "ModelCache.h"
+
+#include <chrono>     // Needed to time how long loading takes
+#include <filesystem> // Needed to key models on their canonical path
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+// Method to make a GpuMesh which draws from a shared model's buffers without taking ownership of them
+GpuMesh ModelCache::SharedMesh::createGpuMesh(GLint positionLocation, GLint normalLocation, GLint texCoordLocation) const
+{
+	return GpuMesh(*model, buffers, positionLocation, normalLocation, texCoordLocation, GpuMesh::SHARE_BUFFERS);
+}
+
+// Private method to build the key for a model loaded from the given file with the current load settings
+// Note: If the path can't be made canonical (e.g. the file doesn't exist) we key on the path as given, and the load will fail anyway.
+ModelCache::MeshKey ModelCache::makeKey(const string &filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags)
+{
+	std::error_code error;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(std::filesystem::path(filename), error);
+
+	MeshKey key;
+	key.canonicalFilename           = error ? filename : canonicalPath.string();
+	key.drawingMethod               = drawingMethod;
+	key.uploadFlags                 = uploadFlags;
+	key.optimiseVertexOrder         = Model::optimiseVertexOrder;
+	key.optimiseOverdraw            = Model::optimiseOverdraw;
+	key.overdrawAcmrThreshold       = Model::overdrawAcmrThreshold;
+	key.generateLods                = Model::generateLods;
+	key.lodTriangleRatios           = Model::lodTriangleRatios;
+	key.buildMeshlets               = Model::buildMeshlets;
+	key.smoothNormalCreaseAngleDegs = Model::smoothNormalCreaseAngleDegs;
+	return key;
+}
+
+// Private method to load a model and upload the layouts we were asked for
+// Note: Any interleaved or quantised layout is built here, before the model is shared, as building them later through a const model isn't thread-safe.
+std::shared_ptr<ModelCache::SharedMesh> ModelCache::loadMesh(const string &filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags)
+{
+	auto mesh = std::make_shared<SharedMesh>();
+	mesh->filename = filename;
+	mesh->model    = std::make_unique<Model>(filename, drawingMethod);
+
+	const Model &model = *mesh->model;
+	if ( !model.hasVertices() )
+	{
+		cout << "Model cache failed to load model " << filename << " - it has no vertices." << endl;
+		return nullptr;
+	}
+
+	// Note: The buffers have immutable storage the CPU can't access, as we never change a shared model
+	auto uploadBuffer = [&mesh](GLuint &bufferId, const GLvoid* data, size_t sizeBytes)
+	{
+		bufferId = GpuMesh::createStaticBuffer(data, sizeBytes);
+		mesh->gpuBytes += (bufferId != 0) ? sizeBytes : 0;
+	};
+
+	ModelLoader::ModelBuffers &buffers = mesh->buffers;
+	if (uploadFlags & ModelLoader::UPLOAD_SEPARATE_DATA)
+	{
+		uploadBuffer(buffers.vertexBufferId,   model.getVertexData(),   model.getVertexDataSizeBytes());
+		uploadBuffer(buffers.normalBufferId,   model.getNormalData(),   model.getNormalDataSizeBytes());
+		uploadBuffer(buffers.texCoordBufferId, model.getTexCoordData(), model.getTexCoordDataSizeBytes());
+	}
+	if (uploadFlags & ModelLoader::UPLOAD_INTERLEAVED_DATA)
+	{
+		uploadBuffer(buffers.interleavedBufferId, model.getInterleavedData(), model.getInterleavedDataSizeBytes());
+		mesh->cpuBytes += model.getInterleavedDataSizeBytes();
+	}
+	if (uploadFlags & ModelLoader::UPLOAD_QUANTISED_DATA)
+	{
+		uploadBuffer(buffers.quantisedBufferId, model.getQuantisedData(), model.getQuantisedDataSizeBytes());
+		mesh->cpuBytes += model.getQuantisedDataSizeBytes();
+	}
+	if (model.getDrawingMethod() == Model::DRAWING_AS_ELEMENTS)
+	{
+		uploadBuffer(buffers.indexBufferId, model.getFaceData(), model.getFaceDataSizeBytes());
+	}
+
+	mesh->cpuBytes += model.getVertexDataSizeBytes() + model.getNormalDataSizeBytes() + model.getNormalIndexDataSizeBytes() + model.getTexCoordDataSizeBytes();
+	mesh->cpuBytes += model.getFaceDataSizeBytes() + model.getMeshletCount() * sizeof(MeshOptimiser::Meshlet);
+	return mesh;
+}
+
+// Method to get a shared model, loading and uploading it if we don't already hold one loaded the same way
+ModelCache::MeshHandle ModelCache::acquire(string filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags)
+{
+	MeshKey key = makeKey(filename, drawingMethod, uploadFlags);
+
+	auto found = meshes.find(key);
+	if ( found != meshes.end() )
+	{
+		++hits;
+		return found->second;
+	}
+
+	++misses;
+	auto loadStartTime = std::chrono::steady_clock::now();
+	std::shared_ptr<SharedMesh> mesh = loadMesh(filename, drawingMethod, uploadFlags);
+	if (mesh == nullptr)
+	{
+		return nullptr;
+	}
+	std::chrono::duration<double, std::milli> loadDuration = std::chrono::steady_clock::now() - loadStartTime;
+	cout << "Model cache loaded " << filename << " in " << loadDuration.count() << "ms (" << mesh->cpuBytes << " bytes, " << mesh->gpuBytes << " bytes on the GPU)." << endl;
+
+	meshes.emplace( std::move(key), mesh );
+	return mesh;
+}
+
+// Method to let go of (and delete the buffers of) every model which nothing outside the cache is using
+size_t ModelCache::purgeUnused()
+{
+	size_t purgedCount = 0;
+	for (auto mesh = meshes.begin(); mesh != meshes.end(); )
+	{
+		if (mesh->second.use_count() == 1)
+		{
+			ModelLoader::deleteBuffers(mesh->second->buffers);
+			mesh = meshes.erase(mesh);
+			++purgedCount;
+		}
+		else
+		{
+			++mesh;
+		}
+	}
+	return purgedCount;
+}
+
+// Method to let go of every model and delete all their buffers
+void ModelCache::clear()
+{
+	for (auto &mesh : meshes)
+	{
+		ModelLoader::deleteBuffers(mesh.second->buffers);
+	}
+	meshes.clear();
+}
+
+// Method to get how well the cache is doing
+// Note: The cache's own reference to each model isn't a user, so a model with n users saves n - 1 copies.
+ModelCache::Statistics ModelCache::getStatistics() const
+{
+	Statistics statistics;
+	statistics.hits       = hits;
+	statistics.misses     = misses;
+	statistics.liveMeshes = meshes.size();
+
+	for (const auto &mesh : meshes)
+	{
+		size_t users = static_cast<size_t>( mesh.second.use_count() ) - 1;
+		size_t extraCopies = (users > 1) ? users - 1 : 0;
+
+		statistics.meshUsers     += users;
+		statistics.cpuBytesHeld  += mesh.second->cpuBytes;
+		statistics.gpuBytesHeld  += mesh.second->gpuBytes;
+		statistics.cpuBytesSaved += extraCopies * mesh.second->cpuBytes;
+		statistics.gpuBytesSaved += extraCopies * mesh.second->gpuBytes;
+	}
+	return statistics;
+}
+
+// Method to print out how well the cache is doing
+void ModelCache::printStatistics() const
+{
+	Statistics statistics = getStatistics();
+	cout << "Model cache: " << statistics.hits << " hit(s), " << statistics.misses << " miss(es), " << statistics.liveMeshes << " model(s) held with "
+	     << statistics.meshUsers << " user(s). Holding " << statistics.cpuBytesHeld << " bytes (" << statistics.gpuBytesHeld << " on the GPU), saving "
+	     << statistics.cpuBytesSaved << " bytes (" << statistics.gpuBytesSaved << " on the GPU)." << endl;
+}
@@ -0,0 +1,255 @@
+#include "ModelLoader.h"
+
+#include <algorithm> // Needed for min
+#include <chrono>    // Needed to time how long loading takes
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+// Method to get how far through uploading the model we are, from 0 to 1
+float ModelLoader::LoadHandle::getUploadProgress() const
+{
+	LoadState currentState = getState();
+	if (currentState == LOAD_READY)     { return 1.0f; }
+	if (currentState != LOAD_UPLOADING) { return 0.0f; }
+	return (totalUploadBytes > 0) ? static_cast<float>( double(uploadedBytes) / double(totalUploadBytes) ) : 0.0f;
+}
+
+// Constructor - starts the worker thread
+ModelLoader::ModelLoader()
+{
+	workerThread = std::thread(&ModelLoader::workerLoop, this);
+}
+
+// Destructor - stops the worker thread once it's finished the model it's on (if any)
+ModelLoader::~ModelLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueCondition.notify_one();
+
+	if ( workerThread.joinable() )
+	{
+		workerThread.join();
+	}
+}
+
+// Method to queue a model to be loaded in the background
+ModelLoader::Handle ModelLoader::loadAsync(string filename, Model::DrawingMethod drawingMethod, GLuint uploadFlags, std::function<void(Model&)> onLoaded)
+{
+	Handle handle = std::make_shared<LoadHandle>();
+	handle->filename      = filename;
+	handle->drawingMethod = drawingMethod;
+	handle->uploadFlags   = uploadFlags;
+	handle->onLoaded      = std::move(onLoaded);
+
+	++busyCount;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		loadQueue.push_back(handle);
+	}
+	queueCondition.notify_one();
+
+	return handle;
+}
+
+// Method run by the worker thread to load each queued model in turn
+// Note: Everything the worker fills in on a handle is published to the main thread by the release store of its state, and the main thread only
+//       looks at it after an acquire load of that state - so neither side needs to lock the handle itself.
+void ModelLoader::workerLoop()
+{
+	while (true)
+	{
+		Handle handle;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return stopping || !loadQueue.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+			handle = loadQueue.front();
+			loadQueue.pop_front();
+		}
+
+		// If the queue held the only reference to the handle then nobody wants this model any more, so don't bother loading it
+		if (handle.use_count() == 1)
+		{
+			--busyCount;
+			continue;
+		}
+
+		handle->state.store(LOAD_PARSING, std::memory_order_release);
+		auto loadStartTime = std::chrono::steady_clock::now();
+		try
+		{
+			// Note: A model that can't be loaded (e.g. its file is missing) is left empty rather than exiting, so we check for that here
+			handle->model = new Model(handle->filename, handle->drawingMethod);
+			if ( !handle->model->hasVertices() )
+			{
+				cout << "Background load of model " << handle->filename << " failed - it has no vertices." << endl;
+				delete handle->model;
+				handle->model = nullptr;
+				handle->state.store(LOAD_FAILED, std::memory_order_release);
+				--busyCount;
+				continue;
+			}
+
+			if (handle->onLoaded)
+			{
+				handle->onLoaded(*handle->model);
+			}
+
+			prepareUploadStreams(*handle);
+		}
+		catch (const std::exception &exception)
+		{
+			cout << "Background load of model " << handle->filename << " failed: " << exception.what() << endl;
+			handle->state.store(LOAD_FAILED, std::memory_order_release);
+			--busyCount;
+			continue;
+		}
+		std::chrono::duration<double, std::milli> loadDuration = std::chrono::steady_clock::now() - loadStartTime;
+		handle->loadTimeMs = loadDuration.count();
+
+		handle->state.store(LOAD_UPLOADING, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			loadedQueue.push_back(handle);
+		}
+	}
+}
+
+// Private method to build a loaded model's vertex data layouts and list what we need to upload.
+// Note: This runs on the worker thread, so the (on demand) interleaved and quantised layouts are built there rather than on the main thread.
+//       It also runs after onLoaded, as scaling a model throws away any layouts already built from it.
+void ModelLoader::prepareUploadStreams(LoadHandle &handle)
+{
+	Model* model = handle.model;
+
+	auto addStream = [&handle](GLuint* bufferId, const GLvoid* data, size_t sizeBytes)
+	{
+		if (data != nullptr && sizeBytes > 0)
+		{
+			handle.uploadStreams.push_back( { bufferId, static_cast<const GLubyte*>(data), sizeBytes, 0 } );
+			handle.totalUploadBytes += sizeBytes;
+		}
+	};
+
+	if (handle.uploadFlags & UPLOAD_SEPARATE_DATA)
+	{
+		addStream(&handle.buffers.vertexBufferId, model->getVertexData(), model->getVertexDataSizeBytes());
+		addStream(&handle.buffers.normalBufferId, model->getNormalData(), model->getNormalDataSizeBytes());
+		addStream(&handle.buffers.texCoordBufferId, model->getTexCoordData(), model->getTexCoordDataSizeBytes());
+	}
+	if (handle.uploadFlags & UPLOAD_INTERLEAVED_DATA)
+	{
+		addStream(&handle.buffers.interleavedBufferId, model->getInterleavedData(), model->getInterleavedDataSizeBytes());
+	}
+	if (handle.uploadFlags & UPLOAD_QUANTISED_DATA)
+	{
+		addStream(&handle.buffers.quantisedBufferId, model->getQuantisedData(), model->getQuantisedDataSizeBytes());
+	}
+	if (model->getDrawingMethod() == Model::DRAWING_AS_ELEMENTS)
+	{
+		addStream(&handle.buffers.indexBufferId, model->getFaceData(), model->getFaceDataSizeBytes());
+	}
+}
+
+// Method to upload up to uploadBudgetBytes of loaded model data to the GPU.
+// Note: Each buffer is given immutable storage at its full size the first time we touch a model and then filled a chunk at a time. The storage
+//       has to allow glBufferSubData for that (GL_DYNAMIC_STORAGE_BIT), but the CPU can't map it, and as we use direct state access to fill the
+//       buffers we never bind them - so we can't disturb any vertex array object's bindings.
+size_t ModelLoader::update(size_t uploadBudgetBytes)
+{
+	// Pick up any models the worker thread has finished with
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		while ( !loadedQueue.empty() )
+		{
+			uploadQueue.push_back( loadedQueue.front() );
+			loadedQueue.pop_front();
+		}
+	}
+
+	size_t uploadedThisUpdate = 0;
+	while ( !uploadQueue.empty() && (uploadBudgetBytes == 0 || uploadedThisUpdate < uploadBudgetBytes) )
+	{
+		Handle handle = uploadQueue.front();
+
+		// If we held the only references to the handle then nobody wants this model any more
+		// Note: The two references are the one in the queue and our local copy
+		if (handle.use_count() == 2)
+		{
+			deleteBuffers(handle->buffers);
+			uploadQueue.pop_front();
+			--busyCount;
+			continue;
+		}
+
+		// Allocate the buffers the first time we see a model
+		if (handle->uploadFrameCount == 0)
+		{
+			for (LoadHandle::UploadStream &stream : handle->uploadStreams)
+			{
+				glCreateBuffers(1, stream.bufferId);
+				glNamedBufferStorage(*stream.bufferId, stream.sizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			}
+		}
+		++handle->uploadFrameCount;
+
+		for (LoadHandle::UploadStream &stream : handle->uploadStreams)
+		{
+			size_t remainingBytes = stream.sizeBytes - stream.uploadedBytes;
+			if (remainingBytes == 0)
+			{
+				continue;
+			}
+
+			size_t chunkBytes = (uploadBudgetBytes == 0) ? remainingBytes : std::min(remainingBytes, uploadBudgetBytes - uploadedThisUpdate);
+			glNamedBufferSubData(*stream.bufferId, stream.uploadedBytes, chunkBytes, stream.data + stream.uploadedBytes);
+
+			stream.uploadedBytes  += chunkBytes;
+			handle->uploadedBytes += chunkBytes;
+			uploadedThisUpdate    += chunkBytes;
+			if (uploadBudgetBytes != 0 && uploadedThisUpdate >= uploadBudgetBytes)
+			{
+				break;
+			}
+		}
+
+		// Not finished this model? Then we've used up our budget, so carry on with it next time
+		if (handle->uploadedBytes < handle->totalUploadBytes)
+		{
+			break;
+		}
+
+		cout << "Model " << handle->filename << " loaded in the background in " << handle->loadTimeMs << "ms and uploaded (" << handle->totalUploadBytes
+		     << " bytes) over " << handle->uploadFrameCount << " update(s)." << endl;
+		handle->state.store(LOAD_READY, std::memory_order_release);
+		uploadQueue.pop_front();
+		--busyCount;
+	}
+
+	return uploadedThisUpdate;
+}
+
+// Method to find out whether there are any models still queued, loading or uploading
+bool ModelLoader::isBusy() { return busyCount.load() > 0; }
+
+// Method to delete the buffers a model was uploaded into and zero their ids
+void ModelLoader::deleteBuffers(ModelBuffers &buffers)
+{
+	GLuint* bufferIds[] = { &buffers.vertexBufferId, &buffers.normalBufferId, &buffers.texCoordBufferId, &buffers.interleavedBufferId, &buffers.quantisedBufferId, &buffers.indexBufferId };
+	for (GLuint* bufferId : bufferIds)
+	{
+		if (*bufferId != 0)
+		{
+			glDeleteBuffers(1, bufferId);
+			*bufferId = 0;
+		}
+	}
+}
@@ -20,11 +20,19 @@ const char *Point::vertexShaderSource = R"(
 in vec4 vertexLocation; // Incoming vertex attribute
 in vec4 vertexColour;   // Incoming vertex attribute
 out vec4 fragColour;
-uniform mat4 mvpMatrix; // Combined Model/View/Projection matrix
+layout(std140) uniform FrameUniforms // Written once per frame - see FrameUniforms.h
+{
+    mat4  viewMatrix;
+    mat4  projectionMatrix;
+    mat4  viewProjectionMatrix;
+    mat4  orthoProjectionMatrix;
+    vec3  cameraPosition;
+    float time;
+};
 void main(void)
 {
     fragColour = vertexColour;
-    gl_Position = mvpMatrix * vertexLocation; // Project our geometry
+    gl_Position = viewProjectionMatrix * vertexLocation; // Project our geometry (the point is already in world space)
 }
 )";
 
@@ -51,32 +59,28 @@ void Point::setupShaderProgram()
     Point::pointShaderProgram->addShader(GL_VERTEX_SHADER, Point::vertexShaderSource);
     Point::pointShaderProgram->addShader(GL_FRAGMENT_SHADER, Point::fragmentShaderSource);
 
-    Point::pointShaderProgram->initialise();
+    // Note: We only start the program compiling here - it's finished off when we first draw (or by initialiseAll)
+    Point::pointShaderProgram->beginInitialise();
 
-    // ----- point shader attributes and uniforms -----
+    // ----- Location Vertex Buffer Object (VBO) -----
 
-    // Add the shader attributes
-    Point::pointShaderProgram->bindAttribute("vertexLocation");
-    Point::pointShaderProgram->bindAttribute("vertexColour");
-
-    // Add the shader uniforms
-    Point::pointShaderProgram->bindUniform("mvpMatrix");
+    // Generate a Vertex Buffer Object to store the point data
+    // Note: We don't actually put any data into the VBO just yet, we do that in the draw() method
+    glGenBuffers(1, &pointVertexBufferId);
+}
 
-    // ----- Set up our Vertex Array Object (VAO) to hold the shader attributes -----
-    // Note: The point VAO cannot be static because we may have multiple points of various sizes.
+// Method to set up our Vertex Array Object (VAO) to hold the shader attributes
+void Point::setupVertexArray()
+{
+    Point::pointShaderProgram->finishInitialise();
 
     // Get an Id for the Vertex Array Object (VAO) and bind to it
     glGenVertexArrays(1, &pointVaoId);
     glBindVertexArray(Point::pointVaoId);
 
-        // ----- Location Vertex Buffer Object (VBO) -----
-
-        // Generate a Vertex Buffer Object to store the point data
-        glGenBuffers(1, &pointVertexBufferId);
+        // Bind to our vertex buffer
         glBindBuffer(GL_ARRAY_BUFFER, Point::pointVertexBufferId);
 
-        // Note: We don't actually put any data into the VBO just yet, we do that in the draw() method
-
         // Specify the attribute pointer for the vertex location
         glVertexAttribPointer(Point::pointShaderProgram->attribute("vertexLocation"), // Vertex location attribute index
                                                                    VERTEX_COMPONENTS, // Number of normal components per vertex
@@ -147,6 +151,11 @@ Point::~Point()
     {
         delete[] pointDataArray;
         delete pointShaderProgram;
+
+        // Note: The next point gets a new shader program, so it needs a new VAO too
+        glDeleteVertexArrays(1, &pointVaoId);
+        glDeleteBuffers(1, &pointVertexBufferId);
+        pointVaoId = 0;
     }
 }
 
@@ -201,10 +210,14 @@ void Point::setPointSize(float ps)
     pointSize = ps;
 }
 
-// Method to draw a single point - takes a combined Model/View/Projection matrix
-// to pass to the shader as a uniform.
-void Point::draw(mat4 mvpMatrix)
+// Method to draw a single point
+void Point::draw()
 {
+    if (Point::pointVaoId == 0)
+    {
+        setupVertexArray();
+    }
+
     // Specify we're using our shader program
     Point::pointShaderProgram->use();
 
@@ -226,9 +239,6 @@ void Point::draw(mat4 mvpMatrix)
             // ...and push it to the graphics card
             glBufferData(GL_ARRAY_BUFFER, Point::BUFFER_SIZE_BYTES, Point::pointDataArray, GL_DYNAMIC_DRAW);
 
-            // Provide the projection matrix uniform
-            glUniformMatrix4fv(Point::pointShaderProgram->uniform("mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvpMatrix) );
-
             // Save all point related attributes
             //glPushAttrib(GL_POINT_BIT);  ------------------------------------------------------------------------------------- FIX THIS - GL_POINT_BIT not longer a thing?!?!?!
 
@@ -248,11 +258,15 @@ void Point::draw(mat4 mvpMatrix)
     Point::pointShaderProgram->disable();
 }
 
-// Static method to draw an array of Points - takes a combined Model/View/Projection matrix
-// to pass to the shader as a uniform. This is vastly more effecient than drawing points
+// Static method to draw an array of Points. This is vastly more effecient than drawing points
 // individually, but as all points are drawn in a single call they must all have the same glPointSize.
-void Point::draw(Point* pointArray, int numPoints, float pointSize, mat4 mvpMatrix)
+void Point::draw(Point* pointArray, int numPoints, float pointSize)
 {
+    if (Point::pointVaoId == 0)
+    {
+        setupVertexArray();
+    }
+
     // Specify we're using our shader program
     Point::pointShaderProgram->use();
 
@@ -291,9 +305,6 @@ void Point::draw(Point* pointArray, int numPoints, float pointSize, mat4 mvpMatr
             // Free our combined point data
             delete[] combinedPointData;
 
-            // Provide the projection matrix uniform
-            glUniformMatrix4fv(Point::pointShaderProgram->uniform("mvpMatrix"), 1, GL_FALSE, glm::value_ptr(mvpMatrix) );
-
             // Save all point related attributes
             //glPushAttrib(GL_POINT_BIT); ------------------------------------------------------------------------------------- FIX THIS GL_POINT_BIT no longer a thing?!?!
 
@@ -0,0 +1,503 @@
+#include "TriangleBVH.h"
+
+#include <algorithm> // Needed for partition, min and max
+#include <cmath>     // Needed for abs and sqrt
+#include <cstring>   // Needed for memcpy
+#include <chrono>    // Needed to time how long the build takes
+#include <thread>    // Needed to build large subtrees in parallel
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+// The deepest we let the tree get - queries keep a stack of nodes still to visit, and this is the size of that stack
+static const GLuint MAX_BVH_DEPTH = 64;
+
+// The cost of visiting a node relative to the cost of testing a triangle, for the surface area heuristic
+static const float NODE_TRAVERSAL_COST = 1.0f;
+
+// Helper function to get half the surface area of a box - we only ever compare areas, so the factor of two doesn't matter
+static float getHalfArea(const vec3 &boundsMin, const vec3 &boundsMax)
+{
+	vec3 size = boundsMax - boundsMin;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// Helper function to find the distance along a ray at which it enters a box, or infinity if it misses the box (or enters it beyond maxDistance).
+// Note: This is the "slab" test - we find where the ray crosses the pair of planes bounding each axis, and the ray is inside the box where it's
+//       between all three pairs at once. Passing in 1 / direction means an axis-parallel ray gets infinities, which the comparisons handle for us.
+static float intersectBox(const float boundsMin[3], const float boundsMax[3], const vec3 &origin, const vec3 &inverseDirection, float maxDistance)
+{
+	float tx1 = (boundsMin[0] - origin.x) * inverseDirection.x, tx2 = (boundsMax[0] - origin.x) * inverseDirection.x;
+	float ty1 = (boundsMin[1] - origin.y) * inverseDirection.y, ty2 = (boundsMax[1] - origin.y) * inverseDirection.y;
+	float tz1 = (boundsMin[2] - origin.z) * inverseDirection.z, tz2 = (boundsMax[2] - origin.z) * inverseDirection.z;
+
+	float tNear = std::max( std::max( std::min(tx1, tx2), std::min(ty1, ty2) ), std::min(tz1, tz2) );
+	float tFar  = std::min( std::min( std::max(tx1, tx2), std::max(ty1, ty2) ), std::max(tz1, tz2) );
+	return (tFar >= tNear && tFar >= 0.0f && tNear <= maxDistance) ? std::max(tNear, 0.0f) : std::numeric_limits<float>::infinity();
+}
+
+// Helper function to find the squared distance from a point to a box (zero if it's inside)
+static float getBoxDistanceSquared(const float boundsMin[3], const float boundsMax[3], const vec3 &point)
+{
+	vec3 closest = glm::clamp(point, vec3(boundsMin[0], boundsMin[1], boundsMin[2]), vec3(boundsMax[0], boundsMax[1], boundsMax[2]));
+	vec3 offset  = point - closest;
+	return glm::dot(offset, offset);
+}
+
+// Helper function to find the closest point on a triangle to a point.
+// Note: This is from Christer Ericson's "Real-Time Collision Detection" - we work out which of the triangle's vertex, edge or face regions the
+//       point projects into, and return the closest point in that region.
+static vec3 getClosestPointOnTriangle(const vec3 &point, const vec3 &a, const vec3 &b, const vec3 &c)
+{
+	vec3 ab = b - a, ac = c - a, ap = point - a;
+	float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) { return a; }
+
+	vec3 bp = point - b;
+	float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) { return b; }
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { return a + ab * (d1 / (d1 - d3)); }
+
+	vec3 cp = point - c;
+	float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) { return c; }
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { return a + ac * (d2 / (d2 - d6)); }
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) { return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))); }
+
+	float denominator = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Constructor which also builds the BVH over a model
+TriangleBVH::TriangleBVH(const Model &model)
+{
+	build(model);
+}
+
+// Method to build the BVH over the full detail triangles of a model
+void TriangleBVH::build(const Model &model)
+{
+	if (model.getDrawingMethod() == Model::DRAWING_AS_ELEMENTS)
+	{
+		build(static_cast<const GLfloat*>( model.getVertexData() ), model.getNumVertices(), model.getFaceData(), model.getFaceIndexType(), model.getFaceElementCount());
+	}
+	else
+	{
+		build(static_cast<const GLfloat*>( model.getVertexData() ), model.getNumVertices(), nullptr, GL_UNSIGNED_INT, model.getNumVertices());
+	}
+}
+
+// Method to build the BVH over a mesh
+void TriangleBVH::build(const GLfloat* positions, GLuint numVertices, const GLvoid* indices, GLenum indexType, GLuint numIndices)
+{
+	nodes.clear();
+	triangles.clear();
+	depth = 0;
+
+	const GLuint numTriangles = numIndices / 3;
+	if (positions == nullptr || numTriangles == 0)
+	{
+		return;
+	}
+
+	auto buildStartTime = std::chrono::steady_clock::now();
+
+	// Get the vertex number of a corner of a triangle
+	auto getIndex = [&](GLuint corner) -> GLuint
+	{
+		if (indices == nullptr)                { return corner; }
+		if (indexType == GL_UNSIGNED_SHORT)    { return static_cast<const GLushort*>(indices)[corner]; }
+		return static_cast<const GLuint*>(indices)[corner];
+	};
+	auto getVertex = [&](GLuint corner)
+	{
+		GLuint index = std::min(getIndex(corner), numVertices - 1);
+		return vec3(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]);
+	};
+
+	vector<BuildTriangle> buildTriangles(numTriangles);
+	for (GLuint loop = 0; loop < numTriangles; ++loop)
+	{
+		vec3 v0 = getVertex(loop * 3), v1 = getVertex(loop * 3 + 1), v2 = getVertex(loop * 3 + 2);
+		BuildTriangle &triangle = buildTriangles[loop];
+		triangle.boundsMin    = glm::min(glm::min(v0, v1), v2);
+		triangle.boundsMax    = glm::max(glm::max(v0, v1), v2);
+		triangle.centroid     = (v0 + v1 + v2) / 3.0f;
+		triangle.meshTriangle = loop;
+	}
+
+	// A binary tree with one triangle per leaf has 2n - 1 nodes, so that's the most we can need
+	nodes.resize(2 * size_t(numTriangles) - 1);
+	std::atomic<GLuint> nodesUsed(1);
+
+	// Note: Splitting the top n levels gives us up to 2^n threads, so we round down to stay within the core count
+	parallelBuildLevels = 0;
+	for (GLuint threads = std::max(1u, std::thread::hardware_concurrency()); threads > 1; threads /= 2)
+	{
+		++parallelBuildLevels;
+	}
+	depth = buildNode(0, buildTriangles, 0, numTriangles, nodesUsed);
+	nodes.resize(nodesUsed);
+	nodes.shrink_to_fit();
+
+	// Copy the triangles out in leaf order, so each leaf's triangles are next to each other in memory
+	triangles.resize(numTriangles);
+	for (GLuint loop = 0; loop < numTriangles; ++loop)
+	{
+		GLuint meshTriangle = buildTriangles[loop].meshTriangle;
+		Triangle &triangle  = triangles[loop];
+		triangle.vertex[0]    = getVertex(meshTriangle * 3);
+		triangle.vertex[1]    = getVertex(meshTriangle * 3 + 1);
+		triangle.vertex[2]    = getVertex(meshTriangle * 3 + 2);
+		triangle.meshTriangle = meshTriangle;
+	}
+
+	std::chrono::duration<double, std::milli> buildDuration = std::chrono::steady_clock::now() - buildStartTime;
+	cout << "Built BVH over " << numTriangles << " triangles: " << nodes.size() << " nodes, depth " << depth << " (" << buildDuration.count() << "ms)" << endl;
+}
+
+// Private method to build the subtree at a node
+GLuint TriangleBVH::buildNode(GLuint nodeIndex, vector<BuildTriangle> &buildTriangles, GLuint first, GLuint count, std::atomic<GLuint> &nodesUsed, GLuint level)
+{
+	// Find the bounds of the node's triangles, and of their centroids (which is what we split on)
+	vec3 boundsMin( std::numeric_limits<float>::max());
+	vec3 boundsMax(-std::numeric_limits<float>::max());
+	vec3 centroidMin = boundsMin;
+	vec3 centroidMax = boundsMax;
+	for (GLuint loop = first; loop < first + count; ++loop)
+	{
+		const BuildTriangle &triangle = buildTriangles[loop];
+		boundsMin   = glm::min(boundsMin,   triangle.boundsMin);
+		boundsMax   = glm::max(boundsMax,   triangle.boundsMax);
+		centroidMin = glm::min(centroidMin, triangle.centroid);
+		centroidMax = glm::max(centroidMax, triangle.centroid);
+	}
+
+	Node &node = nodes[nodeIndex];
+	memcpy(node.boundsMin, &boundsMin[0], sizeof(node.boundsMin));
+	memcpy(node.boundsMax, &boundsMax[0], sizeof(node.boundsMax));
+	node.leftFirst     = first;
+	node.triangleCount = count;
+	if (count == 1 || level + 1 >= MAX_BVH_DEPTH)
+	{
+		return 1;
+	}
+
+	// Sort the triangles into bins along the longest axis of the centroid bounds...
+	vec3 centroidExtent = centroidMax - centroidMin;
+	int axis = (centroidExtent.x > centroidExtent.y) ? 0 : 1;
+	axis = (centroidExtent.z > centroidExtent[axis]) ? 2 : axis;
+
+	struct Bin
+	{
+		vec3   boundsMin = vec3( std::numeric_limits<float>::max());
+		vec3   boundsMax = vec3(-std::numeric_limits<float>::max());
+		GLuint count     = 0;
+	};
+	Bin bins[SAH_BIN_COUNT];
+	float binScale = (centroidExtent[axis] > 0.0f) ? SAH_BIN_COUNT / centroidExtent[axis] : 0.0f;
+	auto getBin = [&](const BuildTriangle &triangle) { return std::min(SAH_BIN_COUNT - 1, static_cast<int>( (triangle.centroid[axis] - centroidMin[axis]) * binScale )); };
+	for (GLuint loop = first; loop < first + count; ++loop)
+	{
+		Bin &bin = bins[ getBin(buildTriangles[loop]) ];
+		bin.boundsMin = glm::min(bin.boundsMin, buildTriangles[loop].boundsMin);
+		bin.boundsMax = glm::max(bin.boundsMax, buildTriangles[loop].boundsMax);
+		++bin.count;
+	}
+
+	// ...then sweep from each end to get the area and triangle count on either side of each split between bins
+	float  leftArea[SAH_BIN_COUNT - 1], rightArea[SAH_BIN_COUNT - 1];
+	GLuint leftCount[SAH_BIN_COUNT - 1], rightCount[SAH_BIN_COUNT - 1];
+	Bin leftSweep, rightSweep;
+	for (int split = 0; split < SAH_BIN_COUNT - 1; ++split)
+	{
+		leftSweep.boundsMin = glm::min(leftSweep.boundsMin, bins[split].boundsMin);
+		leftSweep.boundsMax = glm::max(leftSweep.boundsMax, bins[split].boundsMax);
+		leftSweep.count    += bins[split].count;
+		leftCount[split]    = leftSweep.count;
+		leftArea[split]     = (leftSweep.count > 0) ? getHalfArea(leftSweep.boundsMin, leftSweep.boundsMax) : 0.0f;
+
+		const Bin &rightBin = bins[SAH_BIN_COUNT - 1 - split];
+		rightSweep.boundsMin = glm::min(rightSweep.boundsMin, rightBin.boundsMin);
+		rightSweep.boundsMax = glm::max(rightSweep.boundsMax, rightBin.boundsMax);
+		rightSweep.count    += rightBin.count;
+		rightCount[SAH_BIN_COUNT - 2 - split] = rightSweep.count;
+		rightArea[SAH_BIN_COUNT - 2 - split]  = (rightSweep.count > 0) ? getHalfArea(rightSweep.boundsMin, rightSweep.boundsMax) : 0.0f;
+	}
+
+	// The best split is the one where we expect to test the fewest triangles - each child's triangle count weighted by the chance that a ray which
+	// hits this node also hits that child (which is the ratio of their surface areas)
+	const float nodeArea = getHalfArea(boundsMin, boundsMax);
+	float bestCost  = std::numeric_limits<float>::max();
+	int   bestSplit = -1;
+	for (int split = 0; split < SAH_BIN_COUNT - 1; ++split)
+	{
+		if (leftCount[split] == 0 || rightCount[split] == 0)
+		{
+			continue;
+		}
+		float cost = NODE_TRAVERSAL_COST * nodeArea + leftCount[split] * leftArea[split] + rightCount[split] * rightArea[split];
+		if (cost < bestCost)
+		{
+			bestCost  = cost;
+			bestSplit = split;
+		}
+	}
+
+	// Small nodes stay as leaves if splitting them wouldn't be any cheaper than testing all their triangles
+	float leafCost = count * nodeArea;
+	if (count <= MAX_LEAF_TRIANGLES && (bestSplit < 0 || bestCost >= leafCost))
+	{
+		return 1;
+	}
+
+	// Split the triangles - or, if their centroids are all in the same place, just split them in half
+	GLuint leftTriangles;
+	if (bestSplit >= 0)
+	{
+		auto middle = std::partition(buildTriangles.begin() + first, buildTriangles.begin() + first + count, [&](const BuildTriangle &triangle) { return getBin(triangle) <= bestSplit; });
+		leftTriangles = static_cast<GLuint>( middle - (buildTriangles.begin() + first) );
+	}
+	else
+	{
+		leftTriangles = count / 2;
+	}
+
+	GLuint leftChild = nodesUsed.fetch_add(2);
+	node.leftFirst     = leftChild;
+	node.triangleCount = 0;
+
+	// Build the two children, building the left one on another thread if there are enough triangles to make it worthwhile and we've not already
+	// got a thread for every core
+	// Note: Each child only touches its own range of the build triangles and its own nodes, so they can't interfere with each other
+	GLuint leftDepth  = 0;
+	GLuint rightDepth = 0;
+	if (count >= PARALLEL_BUILD_MIN_TRIANGLES && level < parallelBuildLevels)
+	{
+		std::thread leftWorker([&]() { leftDepth = buildNode(leftChild, buildTriangles, first, leftTriangles, nodesUsed, level + 1); });
+		rightDepth = buildNode(leftChild + 1, buildTriangles, first + leftTriangles, count - leftTriangles, nodesUsed, level + 1);
+		leftWorker.join();
+	}
+	else
+	{
+		leftDepth  = buildNode(leftChild,     buildTriangles, first,                 leftTriangles,         nodesUsed, level + 1);
+		rightDepth = buildNode(leftChild + 1, buildTriangles, first + leftTriangles, count - leftTriangles, nodesUsed, level + 1);
+	}
+	return 1 + std::max(leftDepth, rightDepth);
+}
+
+// Method to find the first triangle hit by a ray
+bool TriangleBVH::intersectRay(const vec3 &origin, const vec3 &direction, RayHit &hit, float maxDistance) const
+{
+	if ( nodes.empty() )
+	{
+		return false;
+	}
+
+	const vec3 inverseDirection = 1.0f / direction;
+	float  closestDistance = maxDistance;
+	GLuint closestTriangle = 0;
+	float  closestU = 0.0f, closestV = 0.0f;
+	bool   found = false;
+
+	if (intersectBox(nodes[0].boundsMin, nodes[0].boundsMax, origin, inverseDirection, closestDistance) == std::numeric_limits<float>::infinity())
+	{
+		return false;
+	}
+
+	GLuint stack[MAX_BVH_DEPTH];
+	GLuint stackSize = 0;
+	GLuint nodeIndex = 0;
+	while (true)
+	{
+		const Node &node = nodes[nodeIndex];
+		if (node.triangleCount > 0)
+		{
+			// Test the ray against each triangle in the leaf.
+			// Note: This is the Moller-Trumbore test, which finds the distance and barycentric coordinates of the hit in one go.
+			for (GLuint loop = node.leftFirst; loop < node.leftFirst + node.triangleCount; ++loop)
+			{
+				const Triangle &triangle = triangles[loop];
+				vec3  edge1       = triangle.vertex[1] - triangle.vertex[0];
+				vec3  edge2       = triangle.vertex[2] - triangle.vertex[0];
+				vec3  p           = glm::cross(direction, edge2);
+				float determinant = glm::dot(edge1, p);
+				if (std::abs(determinant) < 1e-12f)
+				{
+					continue; // The ray is parallel to the triangle (or the triangle has no area)
+				}
+				float inverseDeterminant = 1.0f / determinant;
+				vec3  toOrigin = origin - triangle.vertex[0];
+				float u = glm::dot(toOrigin, p) * inverseDeterminant;
+				if (u < 0.0f || u > 1.0f)
+				{
+					continue;
+				}
+				vec3  q = glm::cross(toOrigin, edge1);
+				float v = glm::dot(direction, q) * inverseDeterminant;
+				if (v < 0.0f || u + v > 1.0f)
+				{
+					continue;
+				}
+				float t = glm::dot(edge2, q) * inverseDeterminant;
+				if (t >= 0.0f && t < closestDistance)
+				{
+					closestDistance = t;
+					closestTriangle = loop;
+					closestU        = u;
+					closestV        = v;
+					found           = true;
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearer child first, and come back to the further one later if it might still hold a closer hit
+			GLuint nearChild = node.leftFirst;
+			GLuint farChild  = node.leftFirst + 1;
+			float  nearDistance = intersectBox(nodes[nearChild].boundsMin, nodes[nearChild].boundsMax, origin, inverseDirection, closestDistance);
+			float  farDistance  = intersectBox(nodes[farChild].boundsMin,  nodes[farChild].boundsMax,  origin, inverseDirection, closestDistance);
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+			if (nearDistance != std::numeric_limits<float>::infinity())
+			{
+				if (farDistance != std::numeric_limits<float>::infinity())
+				{
+					stack[stackSize++] = farChild;
+				}
+				nodeIndex = nearChild;
+				continue;
+			}
+		}
+
+		// Pop the next node to visit, skipping any we've since found a closer hit than
+		bool popped = false;
+		while (stackSize > 0 && !popped)
+		{
+			nodeIndex = stack[--stackSize];
+			popped = intersectBox(nodes[nodeIndex].boundsMin, nodes[nodeIndex].boundsMax, origin, inverseDirection, closestDistance) != std::numeric_limits<float>::infinity();
+		}
+		if (!popped)
+		{
+			break;
+		}
+	}
+
+	if (found)
+	{
+		const Triangle &triangle = triangles[closestTriangle];
+		hit.distance = closestDistance;
+		hit.triangle = triangle.meshTriangle;
+		hit.u        = closestU;
+		hit.v        = closestV;
+		hit.position = origin + direction * closestDistance;
+		hit.normal   = glm::cross(triangle.vertex[1] - triangle.vertex[0], triangle.vertex[2] - triangle.vertex[0]);
+		float normalLength = glm::length(hit.normal);
+		hit.normal   = (normalLength > 0.0f) ? hit.normal / normalLength : vec3(0.0f);
+	}
+	return found;
+}
+
+// Method to find the first triangle hit by a line segment.
+// Note: This is just a ray from the start to the end which stops at the end - using the unnormalised direction makes the hit distance a fraction of the segment.
+bool TriangleBVH::intersectSegment(const vec3 &start, const vec3 &end, RayHit &hit) const
+{
+	return intersectRay(start, end - start, hit, 1.0f);
+}
+
+// Method to find the closest point on the mesh to a point
+bool TriangleBVH::findClosestPoint(const vec3 &point, ClosestPoint &result, float maxDistance) const
+{
+	if ( nodes.empty() )
+	{
+		return false;
+	}
+
+	// Note: We work with squared distances throughout, and only take the square root of the final result
+	float  closestDistanceSquared = (maxDistance == std::numeric_limits<float>::infinity()) ? maxDistance : maxDistance * maxDistance;
+	vec3   closestPosition(0.0f);
+	GLuint closestTriangle = 0;
+	bool   found = false;
+
+	if (getBoxDistanceSquared(nodes[0].boundsMin, nodes[0].boundsMax, point) > closestDistanceSquared)
+	{
+		return false;
+	}
+
+	GLuint stack[MAX_BVH_DEPTH];
+	GLuint stackSize = 0;
+	GLuint nodeIndex = 0;
+	while (true)
+	{
+		const Node &node = nodes[nodeIndex];
+		if (node.triangleCount > 0)
+		{
+			for (GLuint loop = node.leftFirst; loop < node.leftFirst + node.triangleCount; ++loop)
+			{
+				const Triangle &triangle = triangles[loop];
+				vec3  closest = getClosestPointOnTriangle(point, triangle.vertex[0], triangle.vertex[1], triangle.vertex[2]);
+				vec3  offset  = point - closest;
+				float distanceSquared = glm::dot(offset, offset);
+				if (distanceSquared <= closestDistanceSquared)
+				{
+					closestDistanceSquared = distanceSquared;
+					closestPosition        = closest;
+					closestTriangle        = loop;
+					found                  = true;
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearer child first, as finding a close point early lets us skip more of the tree
+			GLuint nearChild = node.leftFirst;
+			GLuint farChild  = node.leftFirst + 1;
+			float  nearDistanceSquared = getBoxDistanceSquared(nodes[nearChild].boundsMin, nodes[nearChild].boundsMax, point);
+			float  farDistanceSquared  = getBoxDistanceSquared(nodes[farChild].boundsMin,  nodes[farChild].boundsMax,  point);
+			if (farDistanceSquared < nearDistanceSquared)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistanceSquared, farDistanceSquared);
+			}
+			if (nearDistanceSquared <= closestDistanceSquared)
+			{
+				if (farDistanceSquared <= closestDistanceSquared)
+				{
+					stack[stackSize++] = farChild;
+				}
+				nodeIndex = nearChild;
+				continue;
+			}
+		}
+
+		// Pop the next node to visit, skipping any which are now further away than the closest point we've found
+		bool popped = false;
+		while (stackSize > 0 && !popped)
+		{
+			nodeIndex = stack[--stackSize];
+			popped = getBoxDistanceSquared(nodes[nodeIndex].boundsMin, nodes[nodeIndex].boundsMax, point) <= closestDistanceSquared;
+		}
+		if (!popped)
+		{
+			break;
+		}
+	}
+
+	if (found)
+	{
+		result.distance = std::sqrt(closestDistanceSquared);
+		result.triangle = triangles[closestTriangle].meshTriangle;
+		result.position = closestPosition;
+	}
+	return found;
+}
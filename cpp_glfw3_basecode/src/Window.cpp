@@ -310,6 +310,16 @@ void Window::moveCamera(double deltaTimeSecs)
 
     // Translate to our camera position
     viewMatrix = glm::translate(viewMatrix, -camera->getPosition());    
+
+    // Write this frame's matrices into the uniform buffer every built-in shader reads them from
+    FrameUniforms::Data frameData;
+    frameData.viewMatrix            = viewMatrix;
+    frameData.projectionMatrix      = projectionMatrix;
+    frameData.viewProjectionMatrix  = projectionMatrix * viewMatrix;
+    frameData.orthoProjectionMatrix = orthoProjectionMatrix;
+    frameData.cameraPosition        = camera->getPosition();
+    frameData.time                  = static_cast<float>( glfwGetTime() );
+    FrameUniforms::update(frameData);
 }
 
 void Window::setCameraLocation(vec3 location) { camera->setPosition(location); }
@@ -322,6 +332,31 @@ mat4 Window::getViewProjectionMatrix()  { return mat4(projectionMatrix * viewMat
 mat4 Window::getOrthoProjectionMatrix() { return orthoProjectionMatrix;               }
 GLFWwindow* Window::getGlfwWindow()     { return glfwWindow;                          }
 
+// Method to get the projected height in pixels of something of the given size at the given distance from the camera.
+// Note: projectionMatrix[1][1] is 1 / tan(vertFoV / 2), so this is the size as a fraction of the visible height at that distance, times the window height.
+float Window::getProjectedSizePixels(float worldSize, float distance)
+{
+    // Anything at (or behind) the camera is as big as it gets
+    distance = glm::max(distance, nearClipDistance);
+    return worldSize * projectionMatrix[1][1] * 0.5f * static_cast<float>(windowHeight) / distance;
+}
+
+// Method to get the world space ray through a pixel of the window.
+// Note: We turn the pixel into normalised device coordinates (flipping y, as pixels count down from the top but NDC counts up), and then
+//       unproject the points where that pixel meets the near and far clip planes back into world space with the inverse view-projection matrix.
+void Window::getPickRay(double pixelX, double pixelY, vec3 &rayOrigin, vec3 &rayDirection)
+{
+    float ndcX = static_cast<float>( 2.0 * pixelX / windowWidth  - 1.0 );
+    float ndcY = static_cast<float>( 1.0 - 2.0 * pixelY / windowHeight );
+
+    mat4 inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    vec4 nearPoint = inverseViewProjection * vec4(ndcX, ndcY, -1.0f, 1.0f);
+    vec4 farPoint  = inverseViewProjection * vec4(ndcX, ndcY,  1.0f, 1.0f);
+
+    rayOrigin    = vec3(nearPoint) / nearPoint.w;
+    rayDirection = glm::normalize(vec3(farPoint) / farPoint.w - rayOrigin);
+}
+
 // Function to display details about our OpenGL rendering context
 void Window::displayWindowProperties(GLFWwindow *window)
 {